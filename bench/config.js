@@ -18,10 +18,43 @@ const CSV_VARIANTS = [
     "string_heavy",
     "missing",
 ];
+/** Worst-case inputs for the tokenizer and arenas (bench/dataset/generate-pathological). */
+const PATHOLOGICAL_VARIANTS = [
+    "cols_10k",
+    "huge_field",
+    "all_quoted",
+    "mixed_eol",
+    "buffer_boundary",
+    "skewed_rows",
+];
+/** Size of the large quoted field in the huge_field variant. */
+const HUGE_FIELD_BYTES = 4 * 1024 * 1024;
+/** buffer_boundary rows are this long (prime) and are read with the smallest read buffer. */
+const BOUNDARY_ROW_BYTES = 251;
+const BOUNDARY_READ_BUFFER_SIZE = 4096;
 const DEFAULT_BATCH_SIZE = 10000;
 const WARMUP_RUNS = 2;
 const ITERATIONS = 5;
 const EVENT_LOOP_RESOLUTION_MS = 10;
+/** Parsers run at once by the concurrency bench (override with CONCURRENCY=1,4,16). */
+const CONCURRENCY_LEVELS = [1, 2, 4, 8];
+/** Pause between fs.stat probes of the libuv pool during concurrency runs. */
+const THREADPOOL_PROBE_INTERVAL_MS = 5;
+/** Memory profile: /proc sampling period, and progress steps kept for the timeline chart. */
+const MEMORY_SAMPLE_INTERVAL_MS = 10;
+const MEMORY_TIMELINE_POINTS = 21;
+/**
+ * bench --compare: relative change (per metric) beyond which a difference whose confidence
+ * interval excludes zero is flagged, and the interval's confidence and bootstrap resamples.
+ */
+const COMPARE_THRESHOLDS = {
+    throughput: 0.05,
+    timeToFirstBatch: 0.1,
+    peakRss: 0.1,
+    peakArena: 0.1,
+};
+const COMPARE_CONFIDENCE = 0.95;
+const COMPARE_BOOTSTRAP_RESAMPLES = 2000;
 function getActiveSizes() {
     const sizes = { small: SIZES.small, medium: SIZES.medium };
     if (process.env.LARGE === "1")
@@ -34,9 +67,20 @@ module.exports = {
     REPORTS_DIR,
     SIZES,
     CSV_VARIANTS,
+    PATHOLOGICAL_VARIANTS,
+    HUGE_FIELD_BYTES,
+    BOUNDARY_ROW_BYTES,
+    BOUNDARY_READ_BUFFER_SIZE,
     DEFAULT_BATCH_SIZE,
     WARMUP_RUNS,
     ITERATIONS,
     EVENT_LOOP_RESOLUTION_MS,
+    CONCURRENCY_LEVELS,
+    THREADPOOL_PROBE_INTERVAL_MS,
+    MEMORY_SAMPLE_INTERVAL_MS,
+    MEMORY_TIMELINE_POINTS,
+    COMPARE_THRESHOLDS,
+    COMPARE_CONFIDENCE,
+    COMPARE_BOOTSTRAP_RESAMPLES,
     getActiveSizes,
 };
@@ -3,6 +3,7 @@ Object.defineProperty(exports, "__esModule", { value: true });
 const config = require("../config");
 const { generateAllCsv } = require("./generate-csv");
 const { generateAllXlsx } = require("./generate-xlsx");
+const { generateAllPathological } = require("./generate-pathological");
 function ensureReportsDir() {
     if (!require("fs").existsSync(config.REPORTS_DIR)) {
         require("fs").mkdirSync(config.REPORTS_DIR, { recursive: true });
@@ -14,8 +15,10 @@ async function main() {
     ensureReportsDir();
     const csvManifest = generateAllCsv();
     console.log("");
+    generateAllPathological();
+    console.log("");
     const xlsxManifest = await generateAllXlsx();
-    console.log("\nDone. CSV and XLSX datasets ready.");
+    console.log("\nDone. CSV, pathological CSV and XLSX datasets ready.");
 }
 main()
     .then(() => process.exit(0))
@@ -0,0 +1,237 @@
+"use strict";
+Object.defineProperty(exports, "__esModule", { value: true });
+const fs = require("fs");
+const os = require("os");
+const { median, seededRandom } = require("./metrics");
+const config = require("../config");
+const MB = 1024 * 1024;
+const SECTIONS = ["csv", "xlsx", "pathological"];
+const METRICS = [
+    {
+        key: "throughput",
+        label: "Throughput",
+        unit: "MB/s",
+        better: "higher",
+        values: (r, bytes) => r.samples?.elapsedMs.map((ms) => bytes / MB / (ms / 1000)) ?? null,
+        point: (r, bytes) => (r.medianMs ? bytes / MB / (r.medianMs / 1000) : null),
+    },
+    {
+        key: "timeToFirstBatch",
+        label: "Time to first batch",
+        unit: "ms",
+        better: "lower",
+        values: (r) => r.samples?.timeToFirstBatchMs ?? null,
+        point: (r) => r.medianTimeToFirstBatchMs ?? null,
+    },
+    {
+        key: "peakRss",
+        label: "Peak RSS",
+        unit: "MB",
+        better: "lower",
+        values: (r) => r.samples?.peakRss.map((v) => v / MB) ?? null,
+        point: (r) => (r.medianPeakRss !== undefined ? r.medianPeakRss / MB : null),
+    },
+    {
+        key: "peakArena",
+        label: "Peak arena",
+        unit: "MB",
+        better: "lower",
+        values: () => null,
+        point: (r) => (r.arena ? r.arena.peakArenaUsage / MB : null),
+    },
+];
+/**
+ * Percentile-bootstrap interval for the relative change in the median between two sample
+ * sets. Seeded, so the same two reports always give the same interval.
+ */
+function bootstrapDeltaCi(base, cur, confidence, resamples) {
+    const random = seededRandom(0xb0075);
+    const pick = (xs) => xs.map(() => xs[Math.floor(random() * xs.length)]);
+    const deltas = [];
+    for (let i = 0; i < resamples; i++) {
+        const b = median(pick(base));
+        if (b > 0)
+            deltas.push(median(pick(cur)) / b - 1);
+    }
+    deltas.sort((a, b) => a - b);
+    const lo = Math.floor(((1 - confidence) / 2) * deltas.length);
+    const hi = Math.min(deltas.length - 1, Math.ceil(((1 + confidence) / 2) * deltas.length) - 1);
+    return [deltas[lo] ?? 0, deltas[hi] ?? 0];
+}
+/**
+ * A change is a regression (or improvement) when it is worse (better) than the threshold
+ * and, when there are samples, the whole confidence interval is on that side of zero.
+ */
+function verdictFor(spec, delta, ci, threshold) {
+    const worse = spec.better === "lower" ? delta : -delta;
+    const ciWorse = ci ? (spec.better === "lower" ? ci[0] > 0 : ci[1] < 0) : true;
+    const ciBetter = ci ? (spec.better === "lower" ? ci[1] < 0 : ci[0] > 0) : true;
+    if (worse > threshold && ciWorse)
+        return "regression";
+    if (worse < -threshold && ciBetter)
+        return "improvement";
+    return "unchanged";
+}
+function blockKey(b) {
+    return `${b.size}/${b.variant ?? ""}`;
+}
+/** Per-variant, per-parser deltas of the current report against a baseline report. */
+function compareReports(baseline, current, options = {}) {
+    const thresholds = { ...config.COMPARE_THRESHOLDS };
+    if (options.threshold !== undefined && options.threshold !== null) {
+        for (const k of Object.keys(thresholds))
+            thresholds[k] = options.threshold;
+    }
+    const confidence = config.COMPARE_CONFIDENCE;
+    const rows = [];
+    for (const section of SECTIONS) {
+        const curBlocks = current[section] ?? [];
+        const baseBlocks = baseline[section] ?? [];
+        const baseByKey = new Map(baseBlocks.map((b) => [blockKey(b), b]));
+        for (const block of curBlocks) {
+            const baseBlock = baseByKey.get(blockKey(block));
+            const where = { section, size: block.size, variant: block.variant ?? "" };
+            const baseResults = new Map((baseBlock?.results ?? []).filter((r) => !r.error).map((r) => [r.name, r]));
+            for (const r of block.results) {
+                if (r.error)
+                    continue;
+                const b = baseResults.get(r.name);
+                baseResults.delete(r.name);
+                for (const spec of METRICS) {
+                    const cur = spec.point(r, block.bytes);
+                    if (cur === null)
+                        continue;
+                    const row = {
+                        ...where,
+                        name: r.name,
+                        metric: spec.label,
+                        unit: spec.unit,
+                        baseline: null,
+                        current: cur,
+                        delta: null,
+                        ciLow: null,
+                        ciHigh: null,
+                        verdict: "new",
+                    };
+                    const base = b && baseBlock ? spec.point(b, baseBlock.bytes) : null;
+                    if (b && baseBlock && base !== null && base > 0) {
+                        const baseSamples = spec.values(b, baseBlock.bytes);
+                        const curSamples = spec.values(r, block.bytes);
+                        const ci = baseSamples && curSamples && baseSamples.length > 1 && curSamples.length > 1
+                            ? bootstrapDeltaCi(baseSamples, curSamples, confidence, config.COMPARE_BOOTSTRAP_RESAMPLES)
+                            : null;
+                        row.baseline = base;
+                        row.delta = cur / base - 1;
+                        row.ciLow = ci ? ci[0] : null;
+                        row.ciHigh = ci ? ci[1] : null;
+                        row.verdict = verdictFor(spec, row.delta, ci, thresholds[spec.key]);
+                    }
+                    rows.push(row);
+                }
+            }
+            for (const name of baseResults.keys()) {
+                rows.push({ ...where, name, metric: "-", unit: "", baseline: null, current: null, delta: null, ciLow: null, ciHigh: null, verdict: "missing" });
+            }
+        }
+    }
+    const warnings = [...(current.environment?.warnings ?? [])];
+    const be = baseline.environment;
+    const ce = current.environment;
+    if (!be) {
+        warnings.push("Baseline has no environment record; cannot check it ran on the same machine.");
+    }
+    else if (ce) {
+        if (be.cpuModel !== ce.cpuModel)
+            warnings.push(`CPU differs from baseline: ${ce.cpuModel} vs ${be.cpuModel}.`);
+        if (be.node !== ce.node)
+            warnings.push(`Node differs from baseline: ${ce.node} vs ${be.node}.`);
+    }
+    return {
+        baselinePath: null,
+        baselineTimestamp: baseline.timestamp,
+        currentTimestamp: current.timestamp,
+        confidence,
+        thresholds,
+        rows,
+        regressions: rows.filter((r) => r.verdict === "regression").length,
+        improvements: rows.filter((r) => r.verdict === "improvement").length,
+        warnings,
+    };
+}
+function readFileOrNull(p) {
+    try {
+        return fs.readFileSync(p, "utf8").trim();
+    }
+    catch {
+        return null;
+    }
+}
+/** Machine description stored with each report, plus reasons this box may give noisy timings. */
+function benchEnvironment() {
+    const cpus = os.cpus();
+    const loadavg = os.loadavg();
+    const governor = readFileOrNull("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+    const warnings = [];
+    if (loadavg[0] > 1)
+        warnings.push(`Load average is ${loadavg[0].toFixed(2)}; other work is competing for the CPU.`);
+    if (governor && governor !== "performance")
+        warnings.push(`CPU frequency governor is "${governor}"; "performance" gives steadier timings.`);
+    if (readFileOrNull("/sys/devices/system/cpu/intel_pstate/no_turbo") === "0") {
+        warnings.push("Turbo boost is on; clock speed varies with temperature.");
+    }
+    return {
+        node: process.version,
+        platform: process.platform,
+        arch: process.arch,
+        cpuModel: cpus[0]?.model ?? "unknown",
+        cpus: cpus.length,
+        loadavg,
+        governor,
+        warnings,
+    };
+}
+/** `--compare <baseline.json>` and `--threshold <fraction>` from a bench entry's argv. */
+function parseCompareArgs(argv) {
+    let baseline = null;
+    let threshold = null;
+    for (let i = 0; i < argv.length; i++) {
+        const [flag, inline] = argv[i].split("=", 2);
+        const value = () => inline ?? argv[++i];
+        if (flag === "--compare")
+            baseline = value();
+        else if (flag === "--threshold")
+            threshold = parseFloat(value());
+    }
+    if (threshold !== null && !(threshold >= 0))
+        throw new Error("--threshold must be a non-negative fraction, e.g. 0.05");
+    return { baseline, threshold };
+}
+/** Reads the --compare baseline up front, so a bad path fails before the benchmarks run. */
+function loadBaseline(argv) {
+    const args = parseCompareArgs(argv);
+    if (!args.baseline)
+        return null;
+    const report = JSON.parse(fs.readFileSync(args.baseline, "utf8"));
+    return { path: args.baseline, report, threshold: args.threshold };
+}
+/**
+ * Stamps the report with its environment and, given a baseline, attaches the comparison as
+ * report.comparison. Returns the comparison or null.
+ */
+function compareWithBaseline(report, baseline) {
+    report.environment = benchEnvironment();
+    if (!baseline)
+        return null;
+    const comparison = compareReports(baseline.report, report, { threshold: baseline.threshold });
+    comparison.baselinePath = baseline.path;
+    report.comparison = comparison;
+    return comparison;
+}
+module.exports = {
+    compareReports,
+    compareWithBaseline,
+    loadBaseline,
+    parseCompareArgs,
+    benchEnvironment,
+    bootstrapDeltaCi,
+};
@@ -0,0 +1,80 @@
+"use strict";
+Object.defineProperty(exports, "__esModule", { value: true });
+const fs = require("fs");
+const PAGE_SIZE = 4096;
+function statusKb(status, key) {
+    const m = status.match(new RegExp(`^${key}:\\s+(\\d+) kB`, "m"));
+    return m ? parseInt(m[1], 10) * 1024 : null;
+}
+/** Current RSS; the anon/file/shmem split and statm fields are null off Linux. */
+function readMemory() {
+    let status = "";
+    let statm = [];
+    try {
+        status = fs.readFileSync("/proc/self/status", "utf8");
+        statm = fs.readFileSync("/proc/self/statm", "utf8").trim().split(/\s+/).map(Number);
+    }
+    catch {
+        // Not Linux: fall through to process.memoryUsage().
+    }
+    return {
+        rss: statusKb(status, "VmRSS") ?? process.memoryUsage().rss,
+        rssAnon: statusKb(status, "RssAnon"),
+        rssFile: statusKb(status, "RssFile"),
+        rssShmem: statusKb(status, "RssShmem"),
+        statmResident: statm.length > 1 ? statm[1] * PAGE_SIZE : null,
+        statmShared: statm.length > 2 ? statm[2] * PAGE_SIZE : null,
+    };
+}
+/**
+ * Samples memory, page faults and arena usage on a timer until stop(). progress() and
+ * arenaInUse() are polled with each sample.
+ */
+function startMemorySampler(intervalMs, progress, arenaInUse) {
+    const samples = [];
+    const t0 = process.hrtime.bigint();
+    const sample = () => {
+        const usage = process.resourceUsage();
+        samples.push({
+            ...readMemory(),
+            tMs: Number(process.hrtime.bigint() - t0) / 1e6,
+            progress: progress(),
+            heapUsed: process.memoryUsage().heapUsed,
+            arenaInUse: arenaInUse(),
+            minorFaults: usage.minorPageFault,
+            majorFaults: usage.majorPageFault,
+        });
+    };
+    sample();
+    const timer = setInterval(sample, intervalMs);
+    return {
+        sample,
+        stop: () => {
+            clearInterval(timer);
+            sample();
+            return samples;
+        },
+    };
+}
+/**
+ * Reduces a timeline to `points` evenly spaced progress steps (0..1). Each step holds the
+ * highest value sampled since the previous step, or repeats the previous step if none was.
+ */
+function timelineByProgress(samples, points, value) {
+    const out = [];
+    let i = 0;
+    let last = samples.length ? value(samples[0]) : 0;
+    for (let p = 0; p < points; p++) {
+        const upTo = points > 1 ? p / (points - 1) : 1;
+        let high = -1;
+        while (i < samples.length && samples[i].progress <= upTo) {
+            high = Math.max(high, value(samples[i]));
+            i++;
+        }
+        if (high >= 0)
+            last = high;
+        out.push(last);
+    }
+    return out;
+}
+module.exports = { readMemory, startMemorySampler, timelineByProgress };
@@ -2,6 +2,39 @@
 Object.defineProperty(exports, "__esModule", { value: true });
 const { monitorEventLoopDelay } = require("node:perf_hooks");
 const config = require("../config");
+/** Hardware counter summary from getParserMetrics output; null when counters were unavailable. */
+function hwSummary(metrics, bytes) {
+    if (!metrics || !metrics.hw_counters)
+        return null;
+    const stage = (name) => {
+        const get = (event) => metrics[`hw_${name}_${event}`] ?? null;
+        const cycles = get("cycles") ?? 0;
+        const instructions = get("instructions");
+        return {
+            cycles,
+            instructions,
+            cyclesPerByte: bytes > 0 ? cycles / bytes : 0,
+            ipc: instructions !== null && cycles > 0 ? instructions / cycles : null,
+            branchMisses: get("branch_misses"),
+            llcMisses: get("llc_misses"),
+        };
+    };
+    return { read: stage("read"), tokenize: stage("tokenize"), build: stage("build") };
+}
+/** Arena figures from getParserMetrics output; null for parsers that do not report them. */
+function arenaSummary(metrics) {
+    if (!metrics || metrics.peak_arena_usage === undefined)
+        return null;
+    return {
+        peakArenaUsage: metrics.peak_arena_usage,
+        arenaBlocks: metrics.arena_blocks ?? 0,
+        arenaBytesAllocated: metrics.arena_bytes_allocated ?? 0,
+    };
+}
+/**
+ * Times one run of fn. fn receives markFirstBatch and calls it as each batch (or row) arrives;
+ * the first call sets timeToFirstBatchMs.
+ */
 async function measureRun(fn, options = {}) {
     const rssSamples = [];
     let rssInterval;
@@ -16,8 +49,13 @@ async function measureRun(fn, options = {}) {
             rssSamples.push(process.memoryUsage().rss);
         }, sampleRssIntervalMs);
     }
+    let firstBatchAt = 0n;
+    const markFirstBatch = () => {
+        if (firstBatchAt === 0n)
+            firstBatchAt = process.hrtime.bigint();
+    };
     const start = process.hrtime.bigint();
-    const result = await fn();
+    const result = await fn(markFirstBatch);
     const end = process.hrtime.bigint();
     if (rssInterval)
         clearInterval(rssInterval);
@@ -31,6 +69,7 @@ async function measureRun(fn, options = {}) {
     return {
         elapsedNs,
         elapsedMs,
+        timeToFirstBatchMs: firstBatchAt === 0n ? null : Number(firstBatchAt - start) / 1e6,
         peakRss,
         cpuUserUs: cpuAfter.user,
         cpuSystemUs: cpuAfter.system,
@@ -45,6 +84,8 @@ async function measureRun(fn, options = {}) {
         },
         rowCount: result?.rowCount ?? result?.rows ?? 0,
         bytesProcessed: result?.bytesProcessed ?? 0,
+        hw: result?.hw ?? null,
+        arena: result?.arena ?? null,
     };
 }
 function median(arr) {
@@ -61,6 +102,17 @@ function p95(arr) {
     const i = Math.ceil(0.95 * s.length) - 1;
     return s[Math.max(0, i)];
 }
+/** Small seeded PRNG (mulberry32) for reproducible datasets and resampling. */
+function seededRandom(seed) {
+    let a = seed >>> 0;
+    return () => {
+        a = (a + 0x6d2b79f5) >>> 0;
+        let t = a;
+        t = Math.imul(t ^ (t >>> 15), t | 1);
+        t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+        return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+    };
+}
 function summarizeRuns(runs) {
     const elapsedMs = runs.map((r) => r.elapsedMs);
     const peakRss = runs.map((r) => r.peakRss);
@@ -68,18 +120,24 @@ function summarizeRuns(runs) {
     const bytesProcessed = runs[0]?.bytesProcessed ?? 0;
     const elMax = runs.map((r) => r.eventLoop.max);
     const elP95 = runs.map((r) => r.eventLoop.p95);
+    const ttfb = runs.map((r) => r.timeToFirstBatchMs).filter((v) => v !== null);
+    const allTtfb = ttfb.length === runs.length && ttfb.length > 0;
     return {
         medianMs: median(elapsedMs),
         p95Ms: p95(elapsedMs),
         medianPeakRss: median(peakRss),
         p95PeakRss: p95(peakRss),
+        medianTimeToFirstBatchMs: allTtfb ? median(ttfb) : null,
         medianEventLoopMax: median(elMax),
         p95EventLoopP95: p95(elP95),
         cpuUserUs: runs.reduce((s, r) => s + r.cpuUserUs, 0) / runs.length,
         cpuSystemUs: runs.reduce((s, r) => s + r.cpuSystemUs, 0) / runs.length,
         rowCount,
         bytesProcessed,
+        hw: runs[runs.length - 1]?.hw ?? null,
+        arena: runs[runs.length - 1]?.arena ?? null,
         runs: runs.length,
+        samples: { elapsedMs, peakRss, timeToFirstBatchMs: allTtfb ? ttfb : null },
     };
 }
 module.exports = {
@@ -87,4 +145,7 @@ module.exports = {
     median,
     p95,
     summarizeRuns,
+    hwSummary,
+    arenaSummary,
+    seededRandom,
 };
@@ -6,7 +6,7 @@ async function runBenchmark(name, fn, options = {}) {
     const warmup = options.warmup ?? config.WARMUP_RUNS;
     const iterations = options.iterations ?? config.ITERATIONS;
     for (let i = 0; i < warmup; i++) {
-        await fn();
+        await fn(() => { });
     }
     const runs = [];
     for (let i = 0; i < iterations; i++) {
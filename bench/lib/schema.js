@@ -0,0 +1,15 @@
+"use strict";
+Object.defineProperty(exports, "__esModule", { value: true });
+/**
+ * Typed schema for the generated CSV datasets (col0, col1, ...): every third column holds
+ * labels and stays a string, the rest are float64. Shared by the columnar cases of the
+ * csv, memory and concurrency runners so they parse the same mix.
+ */
+function columnarSchema(numCols) {
+    const schema = {};
+    for (let i = 0; i < numCols; i++) {
+        schema[`col${i}`] = i % 3 === 0 ? "string" : "float64";
+    }
+    return schema;
+}
+module.exports = { columnarSchema };
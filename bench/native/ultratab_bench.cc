@@ -0,0 +1,585 @@
+// ultratab_bench: native microbenchmarks for the scanners, tokenizer engines, batch
+// builders, field converters and the arena, without Node in the picture.
+//
+// Each case is warmed up, then timed over --reps repetitions; a repetition runs the case
+// enough times to last --min-rep-ms. The report has the same shape as bench/reports/*.json
+// (timestamp, csv blocks of results), so bench/reporters can render it.
+//
+//   ultratab_bench [--filter SUBSTR] [--reps N] [--warmup N] [--min-rep-ms N]
+//                  [--synthetic-mb N] [--no-synthetic] [--data-dir DIR] [--size NAME]
+//                  [--json FILE|-]
+
+#include "arena.h"
+#include "batch_builder.h"
+#include "columnar_parser.h"
+#include "simd_scanner.h"
+#include "slice_parser.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ultratab;
+
+namespace {
+
+struct BenchOptions {
+  std::string filter;
+  int reps = 10;
+  int warmup = 2;
+  double min_rep_ms = 20;
+  std::size_t synthetic_mb = 16;
+  bool synthetic = true;
+  std::string data_dir = "bench/data";
+  std::string size = "small";
+  std::string json_path;
+};
+
+/// One input to run cases over; \a bytes is what MB/s and ns/field are measured against.
+struct Input {
+  std::string size;
+  std::string variant;
+  std::string data;
+  std::size_t rows = 0;
+  std::size_t fields = 0;
+};
+
+struct Result {
+  std::string name;
+  int runs = 0;
+  double median_ns = 0;
+  double p95_ns = 0;
+  double mean_ns = 0;
+  double stddev_ns = 0;
+  double min_ns = 0;
+};
+
+struct Block {
+  std::string size;
+  std::string variant;
+  std::size_t bytes = 0;
+  std::size_t rows = 0;
+  std::size_t fields = 0;
+  std::vector<Result> results;
+};
+
+// Results feed this so the optimizer cannot drop the work being timed.
+volatile std::uint64_t g_sink = 0;
+
+void consume(std::uint64_t v) { g_sink = g_sink + v; }
+
+double percentile(std::vector<double> sorted, double p) {
+  if (sorted.empty()) return 0;
+  std::size_t idx = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size()))) - 1;
+  return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+double nowNs() {
+  return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+Result measure(const std::string& name, const std::function<void()>& fn,
+               const BenchOptions& opts) {
+  for (int i = 0; i < opts.warmup; ++i) fn();
+  // Calibrate the calls per repetition from one timed call.
+  double t0 = nowNs();
+  fn();
+  double once = std::max(nowNs() - t0, 1.0);
+  std::size_t inner = static_cast<std::size_t>(std::max(1.0, std::ceil(opts.min_rep_ms * 1e6 / once)));
+
+  std::vector<double> samples;
+  for (int r = 0; r < opts.reps; ++r) {
+    double start = nowNs();
+    for (std::size_t i = 0; i < inner; ++i) fn();
+    samples.push_back((nowNs() - start) / static_cast<double>(inner));
+  }
+  std::sort(samples.begin(), samples.end());
+  Result res;
+  res.name = name;
+  res.runs = opts.reps;
+  res.median_ns = samples.size() % 2
+                      ? samples[samples.size() / 2]
+                      : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+  res.p95_ns = percentile(samples, 0.95);
+  res.min_ns = samples.front();
+  double sum = 0;
+  for (double s : samples) sum += s;
+  res.mean_ns = sum / static_cast<double>(samples.size());
+  double var = 0;
+  for (double s : samples) var += (s - res.mean_ns) * (s - res.mean_ns);
+  res.stddev_ns = samples.size() > 1 ? std::sqrt(var / static_cast<double>(samples.size() - 1)) : 0;
+  return res;
+}
+
+// --- Inputs ---
+
+/// Deterministic generator so runs compare across builds.
+class Lcg {
+ public:
+  explicit Lcg(std::uint64_t seed) : state_(seed) {}
+  std::uint32_t next() {
+    state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<std::uint32_t>(state_ >> 33);
+  }
+  std::uint32_t below(std::uint32_t n) { return next() % n; }
+
+ private:
+  std::uint64_t state_;
+};
+
+void appendWord(std::string& out, Lcg& rng, std::size_t min_len, std::size_t max_len) {
+  std::size_t len = min_len + rng.below(static_cast<std::uint32_t>(max_len - min_len + 1));
+  for (std::size_t i = 0; i < len; ++i) out.push_back(static_cast<char>('a' + rng.below(26)));
+}
+
+/// Synthetic CSV of about \a bytes: "simple" (mixed unquoted text and numbers), "quoted"
+/// (quoted fields with delimiters and doubled quotes) or "numeric" (floats only).
+Input syntheticCsv(const std::string& variant, std::size_t bytes) {
+  Input in;
+  in.size = "synthetic";
+  in.variant = variant;
+  const std::size_t cols = 8;
+  Lcg rng(variant.size() * 7919 + 17);
+  for (std::size_t c = 0; c < cols; ++c) {
+    if (c) in.data.push_back(',');
+    in.data += "col" + std::to_string(c);
+  }
+  in.data.push_back('\n');
+  char num[64];
+  while (in.data.size() < bytes) {
+    for (std::size_t c = 0; c < cols; ++c) {
+      if (c) in.data.push_back(',');
+      if (variant == "numeric" || c % 2 == 0) {
+        std::snprintf(num, sizeof(num), "%.4f",
+                      static_cast<double>(rng.next()) / 1000.0 - 1000000.0);
+        in.data += num;
+      } else if (variant == "quoted") {
+        in.data.push_back('"');
+        appendWord(in.data, rng, 2, 10);
+        in.data += rng.below(3) == 0 ? ", \"\"x\"\" " : " ";
+        appendWord(in.data, rng, 2, 10);
+        in.data.push_back('"');
+      } else {
+        appendWord(in.data, rng, 3, 14);
+      }
+    }
+    in.data.push_back('\n');
+    ++in.rows;
+  }
+  in.fields = in.rows * cols;
+  return in;
+}
+
+/// Fields of one type for the converter cases, packed back to back.
+struct FieldSet {
+  std::string text;
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> spans;
+};
+
+FieldSet syntheticFields(const std::string& type, std::size_t count) {
+  FieldSet set;
+  Lcg rng(type.size() * 104729 + 3);
+  char buf[64];
+  for (std::size_t i = 0; i < count; ++i) {
+    int n;
+    if (type == "int32") {
+      n = std::snprintf(buf, sizeof(buf), "%d", static_cast<int>(rng.next()) - (1 << 30));
+    } else if (type == "int64") {
+      n = std::snprintf(buf, sizeof(buf), "%lld",
+                        static_cast<long long>((static_cast<std::uint64_t>(rng.next()) << 31) ^ rng.next()) -
+                            (1LL << 61));
+    } else if (type == "float64") {
+      n = std::snprintf(buf, sizeof(buf), "%.6g",
+                        (static_cast<double>(rng.next()) - 2147483648.0) / 977.0);
+    } else {
+      static const char* const kBools[] = {"true", "false", "1", "0", "TRUE", "False"};
+      n = std::snprintf(buf, sizeof(buf), "%s", kBools[rng.below(6)]);
+    }
+    set.spans.emplace_back(static_cast<std::uint32_t>(set.text.size()), static_cast<std::uint32_t>(n));
+    set.text.append(buf, static_cast<std::size_t>(n));
+  }
+  return set;
+}
+
+bool readFile(const std::string& path, std::string& out) {
+  std::ifstream f(path, std::ios::binary);
+  if (!f) return false;
+  std::ostringstream ss;
+  ss << f.rdbuf();
+  out = ss.str();
+  return true;
+}
+
+/// Rows and fields by tokenizing once (also validates the file parses).
+void countRowsAndFields(Input& in) {
+  CsvOptions o;
+  o.batch_size = 100000;
+  SliceCsvParser parser(o);
+  std::size_t pos = 0;
+  SliceBatch batch;
+  in.rows = 0;
+  in.fields = 0;
+  std::size_t header_fields = 0;
+  for (;;) {
+    pos += parser.feed(in.data.data() + pos, in.data.size() - pos);
+    if (pos >= in.data.size() && !parser.hasBatch()) parser.flush();
+    if (!parser.hasBatch()) break;
+    parser.takeBatch(batch);
+    if (in.rows == 0 && !batch.rows.empty()) header_fields = batch.rows[0].size();
+    in.rows += batch.rows.size();
+    for (const SliceRow& row : batch.rows) in.fields += row.size();
+  }
+  if (in.rows > 0) {
+    --in.rows;
+    in.fields -= header_fields;
+  }
+}
+
+// --- Cases ---
+
+const std::size_t kFeedChunk = 256 * 1024;
+
+/// Tokenize all of \a data, feeding it in reader-sized chunks; calls \a on_batch per batch.
+void tokenizeAll(const std::string& data, TokenizerEngine engine, std::size_t batch_size,
+                 const std::function<void(SliceBatch&)>& on_batch) {
+  CsvOptions o;
+  o.engine = engine;
+  o.batch_size = batch_size;
+  SliceCsvParser parser(o);
+  SliceBatch batch;
+  for (std::size_t off = 0; off < data.size();) {
+    std::size_t len = std::min(kFeedChunk, data.size() - off);
+    std::size_t consumed = 0;
+    while (consumed < len) {
+      consumed += parser.feed(data.data() + off + consumed, len - consumed);
+      if (!parser.hasBatch()) break;
+      parser.takeBatch(batch);
+      on_batch(batch);
+    }
+    off += len;
+  }
+  parser.flush();
+  while (parser.hasBatch()) {
+    parser.takeBatch(batch);
+    on_batch(batch);
+  }
+}
+
+void runCsvCases(const Input& in, const BenchOptions& opts, std::vector<Block>& blocks) {
+  const CpuFeatures cpu = detectCpuFeatures();
+  const char* data = in.data.data();
+  const std::size_t len = in.data.size();
+  Block block{in.size, in.variant, len, in.rows, in.fields, {}};
+  auto run = [&](const std::string& name, const std::function<void()>& fn) {
+    std::string full = name + " [" + in.size + "/" + in.variant + "]";
+    if (!opts.filter.empty() && full.find(opts.filter) == std::string::npos) return;
+    std::fprintf(stderr, "  %s\n", full.c_str());
+    block.results.push_back(measure(name, fn, opts));
+  };
+
+  run("scanForSeparator", [&] {
+    std::uint64_t hits = 0;
+    for (std::size_t pos = 0; pos < len; ++hits) pos += scanForSeparator(data + pos, len - pos, ',', cpu) + 1;
+    consume(hits);
+  });
+  run("scanForChar(quote)", [&] {
+    std::uint64_t hits = 0;
+    for (std::size_t pos = 0; pos < len; ++hits) pos += scanForChar(data + pos, len - pos, '"', cpu) + 1;
+    consume(hits);
+  });
+  run("indexSeparators", [&] {
+    std::uint32_t index[4096];
+    std::uint64_t hits = 0;
+    for (std::size_t pos = 0; pos < len;) {
+      std::size_t scanned = 0;
+      hits += indexSeparators(data + pos, len - pos, ',', index, 4096, &scanned, cpu);
+      pos += scanned;
+    }
+    consume(hits);
+  });
+  std::vector<char> unescaped(len);
+  run("unescapeQuoted", [&] {
+    std::uint64_t written = 0;
+    for (std::size_t pos = 0; pos < len;) {
+      std::size_t out_len = 0;
+      pos += unescapeQuoted(data + pos, len - pos, '"', unescaped.data(), &out_len, cpu) + 1;
+      written += out_len;
+    }
+    consume(written);
+  });
+
+  const std::pair<const char*, TokenizerEngine> engines[] = {
+      {"tokenize (simd)", TokenizerEngine::Simd}, {"tokenize (dfa)", TokenizerEngine::Dfa}};
+  for (const auto& e : engines) {
+    TokenizerEngine engine = e.second;
+    run(e.first, [&] {
+      std::uint64_t rows = 0;
+      tokenizeAll(in.data, engine, 10000, [&](SliceBatch& b) { rows += b.rows.size(); });
+      consume(rows);
+    });
+  }
+
+  // Builders run over batches tokenized up front, so only the build is timed.
+  std::vector<SliceBatch> batches;
+  tokenizeAll(in.data, TokenizerEngine::Auto, 10000,
+              [&](SliceBatch& b) { batches.push_back(b); });
+  std::vector<std::string> headers;
+  if (!batches.empty() && !batches[0].rows.empty()) {
+    headers = sliceRowToStrings(batches[0].rows[0], batches[0].arena.data(), batches[0].arena.size());
+  }
+  run("buildRowBatch", [&] {
+    std::uint64_t rows = 0;
+    for (const SliceBatch& b : batches) {
+      Batch out;
+      buildRowBatch(b, out);
+      rows += out.size();
+    }
+    consume(rows);
+  });
+  ColumnarOptions string_opts;
+  const NullMatcher nulls(string_opts.null_values);
+  run("buildColumnarBatch (string)", [&] {
+    std::uint64_t rows = 0;
+    for (const SliceBatch& b : batches) {
+      ColumnarBatch out;
+      buildColumnarBatch(b, headers, string_opts, nulls, out);
+      rows += out.rows;
+    }
+    consume(rows);
+  });
+  // Typed: the float columns every variant writes (even columns, all of "numeric").
+  ColumnarOptions typed_opts;
+  for (std::size_t c = 0; c < headers.size(); ++c) {
+    if (in.size == "synthetic" && (in.variant == "numeric" || c % 2 == 0))
+      typed_opts.schema[headers[c]] = ColumnType::Float64;
+  }
+  if (!typed_opts.schema.empty()) {
+    run("buildColumnarBatch (float64 schema)", [&] {
+      std::uint64_t rows = 0;
+      for (const SliceBatch& b : batches) {
+        ColumnarBatch out;
+        buildColumnarBatch(b, headers, typed_opts, nulls, out);
+        rows += out.rows;
+      }
+      consume(rows);
+    });
+  }
+  if (!block.results.empty()) blocks.push_back(std::move(block));
+}
+
+void runConverterCases(const BenchOptions& opts, std::vector<Block>& blocks) {
+  const std::size_t count = 1 << 20;
+  const std::pair<const char*, const char*> cases[] = {
+      {"int32", "parseInt32"}, {"int64", "parseInt64"}, {"float64", "parseFloat64"},
+      {"bool", "parseBool"}};
+  for (const auto& c : cases) {
+    const char* type = c.first;
+    std::string name = c.second;
+    std::string full = name + " [synthetic/" + type + " fields]";
+    if (!opts.filter.empty() && full.find(opts.filter) == std::string::npos) continue;
+    std::fprintf(stderr, "  %s\n", full.c_str());
+    FieldSet set = syntheticFields(type, count);
+    const char* base = set.text.data();
+    std::function<void()> fn;
+    if (std::strcmp(type, "int32") == 0) {
+      fn = [&] {
+        std::int64_t acc = 0;
+        std::int32_t v = 0;
+        for (const auto& s : set.spans) acc += parseInt32(base + s.first, base + s.first + s.second, v) ? v : 0;
+        consume(static_cast<std::uint64_t>(acc));
+      };
+    } else if (std::strcmp(type, "int64") == 0) {
+      fn = [&] {
+        std::int64_t acc = 0;
+        std::int64_t v = 0;
+        for (const auto& s : set.spans) acc ^= parseInt64(base + s.first, base + s.first + s.second, v) ? v : 0;
+        consume(static_cast<std::uint64_t>(acc));
+      };
+    } else if (std::strcmp(type, "float64") == 0) {
+      fn = [&] {
+        double acc = 0;
+        double v = 0;
+        for (const auto& s : set.spans) acc += parseFloat64(base + s.first, base + s.first + s.second, v) ? v : 0;
+        consume(static_cast<std::uint64_t>(acc));
+      };
+    } else {
+      fn = [&] {
+        std::uint64_t acc = 0;
+        bool v = false;
+        for (const auto& s : set.spans) acc += parseBool(base + s.first, base + s.first + s.second, v) && v;
+        consume(acc);
+      };
+    }
+    Block block{"synthetic", std::string(type) + " fields", set.text.size(), count, count, {}};
+    block.results.push_back(measure(name, fn, opts));
+    blocks.push_back(std::move(block));
+  }
+}
+
+void runArenaCases(const BenchOptions& opts, std::vector<Block>& blocks) {
+  const std::size_t sizes[] = {16, 256};
+  const std::size_t total = 64 * 1024 * 1024;
+  for (std::size_t size : sizes) {
+    std::string name = "Arena::allocate(" + std::to_string(size) + ")";
+    if (!opts.filter.empty() && name.find(opts.filter) == std::string::npos) continue;
+    std::fprintf(stderr, "  %s\n", name.c_str());
+    std::size_t count = total / size;
+    Arena arena(SliceCsvParser::kArenaBlockSize);
+    Block block{"synthetic", "arena " + std::to_string(size) + "B", total, 0, count, {}};
+    block.results.push_back(measure(name, [&] {
+      std::size_t offset = 0;
+      std::uint64_t acc = 0;
+      for (std::size_t i = 0; i < count; ++i) {
+        char* p = static_cast<char*>(arena.allocate(size, 1, &offset));
+        p[0] = static_cast<char>(i);
+        acc += offset;
+      }
+      arena.reset();
+      consume(acc);
+    }, opts));
+    blocks.push_back(std::move(block));
+  }
+}
+
+// --- Output ---
+
+std::string jsonEscape(const std::string& s) {
+  std::string out;
+  for (char c : s) {
+    if (c == '"' || c == '\\') out.push_back('\\');
+    out.push_back(c);
+  }
+  return out;
+}
+
+std::string toJson(const std::vector<Block>& blocks, const std::string& timestamp) {
+  std::ostringstream o;
+  o.precision(6);
+  o << std::fixed;
+  o << "{\n  \"timestamp\": \"" << timestamp << "\",\n  \"type\": \"native\",\n  \"csv\": [";
+  for (std::size_t b = 0; b < blocks.size(); ++b) {
+    const Block& blk = blocks[b];
+    o << (b ? "," : "") << "\n    {\n      \"size\": \"" << jsonEscape(blk.size)
+      << "\",\n      \"variant\": \"" << jsonEscape(blk.variant)
+      << "\",\n      \"bytes\": " << blk.bytes << ",\n      \"results\": [";
+    for (std::size_t i = 0; i < blk.results.size(); ++i) {
+      const Result& r = blk.results[i];
+      double secs = r.median_ns / 1e9;
+      o << (i ? "," : "") << "\n        {"
+        << "\"name\": \"" << jsonEscape(r.name) << "\", "
+        << "\"medianMs\": " << r.median_ns / 1e6 << ", "
+        << "\"p95Ms\": " << r.p95_ns / 1e6 << ", "
+        << "\"meanMs\": " << r.mean_ns / 1e6 << ", "
+        << "\"stddevMs\": " << r.stddev_ns / 1e6 << ", "
+        << "\"minMs\": " << r.min_ns / 1e6 << ", "
+        << "\"runs\": " << r.runs << ", "
+        << "\"rowCount\": " << blk.rows << ", "
+        << "\"fieldCount\": " << blk.fields << ", "
+        << "\"bytesPerSec\": " << (secs > 0 ? static_cast<double>(blk.bytes) / secs : 0) << ", "
+        << "\"nsPerField\": " << (blk.fields ? r.median_ns / static_cast<double>(blk.fields) : 0) << ", "
+        << "\"streaming\": null, \"hw\": null}";
+    }
+    o << "\n      ]\n    }";
+  }
+  o << "\n  ],\n  \"xlsx\": null\n}\n";
+  return o.str();
+}
+
+void printTable(std::FILE* out, const std::vector<Block>& blocks) {
+  std::fprintf(out, "%-36s %-28s %11s %11s %9s %10s\n", "case", "input", "median(ms)", "stddev(ms)",
+              "MB/s", "ns/field");
+  for (const Block& blk : blocks) {
+    std::string input = blk.size + "/" + blk.variant;
+    for (const Result& r : blk.results) {
+      double mbps = static_cast<double>(blk.bytes) / (1024.0 * 1024.0) / (r.median_ns / 1e9);
+      double nspf = blk.fields ? r.median_ns / static_cast<double>(blk.fields) : 0;
+      std::fprintf(out, "%-36s %-28s %11.3f %11.3f %9.1f %10.2f\n", r.name.c_str(), input.c_str(),
+                  r.median_ns / 1e6, r.stddev_ns / 1e6, mbps, nspf);
+    }
+  }
+}
+
+std::string isoTimestamp() {
+  std::time_t t = std::time(nullptr);
+  char buf[32];
+  std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&t));
+  return buf;
+}
+
+int usage() {
+  std::fprintf(stderr,
+               "usage: ultratab_bench [--filter SUBSTR] [--reps N] [--warmup N] [--min-rep-ms N]\n"
+               "                      [--synthetic-mb N] [--no-synthetic] [--data-dir DIR]\n"
+               "                      [--size NAME] [--json FILE|-]\n");
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  BenchOptions opts;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--no-synthetic") opts.synthetic = false;
+    else if (arg == "--filter" && has_value) opts.filter = argv[++i];
+    else if (arg == "--reps" && has_value) opts.reps = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--warmup" && has_value) opts.warmup = std::max(0, std::atoi(argv[++i]));
+    else if (arg == "--min-rep-ms" && has_value) opts.min_rep_ms = std::max(0.0, std::atof(argv[++i]));
+    else if (arg == "--synthetic-mb" && has_value)
+      opts.synthetic_mb = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i])));
+    else if (arg == "--data-dir" && has_value) opts.data_dir = argv[++i];
+    else if (arg == "--size" && has_value) opts.size = argv[++i];
+    else if (arg == "--json" && has_value) opts.json_path = argv[++i];
+    else return usage();
+  }
+
+  std::vector<Input> inputs;
+  if (opts.synthetic) {
+    for (const char* v : {"simple", "quoted", "numeric"})
+      inputs.push_back(syntheticCsv(v, opts.synthetic_mb * 1024 * 1024));
+  }
+  // Datasets from `npm run bench:generate`, when present.
+  for (const char* v : {"simple", "quoted", "multiline", "wide", "numeric_heavy", "string_heavy", "missing"}) {
+    Input in;
+    std::string path = opts.data_dir + "/csv_" + opts.size + "_" + v + ".csv";
+    if (!readFile(path, in.data)) continue;
+    in.size = opts.size;
+    in.variant = v;
+    countRowsAndFields(in);
+    inputs.push_back(std::move(in));
+  }
+
+  std::vector<Block> blocks;
+  for (const Input& in : inputs) runCsvCases(in, opts, blocks);
+  runConverterCases(opts, blocks);
+  runArenaCases(opts, blocks);
+
+  // Keep stdout clean for --json -.
+  printTable(opts.json_path == "-" ? stderr : stdout, blocks);
+  if (!opts.json_path.empty()) {
+    std::string json = toJson(blocks, isoTimestamp());
+    if (opts.json_path == "-") {
+      std::fputs(json.c_str(), stdout);
+    } else {
+      std::ofstream f(opts.json_path, std::ios::binary);
+      if (!f) {
+        std::fprintf(stderr, "ultratab_bench: cannot write %s\n", opts.json_path.c_str());
+        return 1;
+      }
+      f << json;
+    }
+  }
+  return 0;
+}
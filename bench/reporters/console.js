@@ -13,11 +13,37 @@ function formatResult(r, bytes) {
         name: r.name,
         "median (ms)": (r.medianMs ?? 0).toFixed(1),
         "p95 (ms)": (r.p95Ms ?? 0).toFixed(1),
+        "first batch (ms)": r.medianTimeToFirstBatchMs != null ? r.medianTimeToFirstBatchMs.toFixed(1) : "-",
         "MB/s": mbPerSec.toFixed(2),
         "rows/s": Math.round(rowsPerSec).toLocaleString(),
         "peak RSS (MB)": rssMb.toFixed(2),
         "event loop p95 (ms)": elP95Ms.toFixed(2),
         streaming: r.streaming === true ? "yes" : r.streaming === false ? "no" : "-",
+        ...formatHw(r),
+        ...formatArena(r),
+    };
+}
+/** Tokenize/build cycles per byte and IPC when the run reported hardware counters. */
+function formatHw(r) {
+    if (!r.hw)
+        return {};
+    const out = {};
+    for (const stage of ["tokenize", "build"]) {
+        const s = r.hw[stage];
+        if (!s)
+            continue;
+        out[`${stage} cyc/B`] = s.cyclesPerByte.toFixed(2);
+        out[`${stage} IPC`] = s.ipc !== null ? s.ipc.toFixed(2) : "-";
+    }
+    return out;
+}
+/** Parser arena high-water for ultratab runs. */
+function formatArena(r) {
+    if (!r.arena)
+        return {};
+    return {
+        "peak arena (MB)": (r.arena.peakArenaUsage / (1024 * 1024)).toFixed(2),
+        "arena blocks": r.arena.arenaBlocks,
     };
 }
 function printCsvBlock(title, bytes, results) {
@@ -36,6 +62,93 @@ function printXlsxBlock(title, bytes, results) {
     const rows = results.map((r) => formatResult(r, bytes));
     console.table(rows);
 }
+/** Aggregate throughput, event-loop delay and pool/HTTP probe latency per level and mode. */
+function formatConcurrencyResult(r) {
+    if (r.error) {
+        return { name: r.name, note: `Error: ${r.error}` };
+    }
+    const el = r.eventLoop ?? { p50: 0, p90: 0, p99: 0, max: 0 };
+    const pool = r.threadpoolProbe ?? { p50: 0, p99: 0, max: 0 };
+    const row = {
+        name: r.name,
+        "median (ms)": (r.medianMs ?? 0).toFixed(1),
+        "aggregate MB/s": (r.aggregateMBps ?? 0).toFixed(2),
+        "per-parser MB/s": (r.perParserMBps ?? 0).toFixed(2),
+        "loop p50 (ms)": (el.p50 / 1e6).toFixed(2),
+        "loop p99 (ms)": (el.p99 / 1e6).toFixed(2),
+        "loop max (ms)": (el.max / 1e6).toFixed(2),
+        "pool probe p99 (ms)": pool.p99.toFixed(2),
+    };
+    if (r.http)
+        row["http p99 (ms)"] = r.http.p99.toFixed(2);
+    return row;
+}
+function printConcurrencyBlock(block) {
+    console.log("\n" + "=".repeat(60));
+    console.log(`Concurrency: ${block.kind} ${block.size}${block.variant ? ` / ${block.variant}` : ""}`);
+    console.log(`Dataset: ${(block.bytes / 1024 / 1024).toFixed(2)} MB per parser, libuv pool: ${block.threadpoolSize} threads`);
+    console.log("=".repeat(60));
+    console.table(block.results.map(formatConcurrencyResult));
+}
+function mbOrDash(v) {
+    return v === null || v === undefined ? "-" : (v / (1024 * 1024)).toFixed(1);
+}
+/** Peak RSS split into anonymous and file-backed pages, page faults and arena high-water. */
+function formatMemoryResult(r) {
+    if (r.error) {
+        return { name: r.name, note: `Error: ${r.error}` };
+    }
+    return {
+        name: r.name,
+        "time (ms)": (r.elapsedMs ?? 0).toFixed(1),
+        "peak RSS (MB)": mbOrDash(r.peak?.rss),
+        "RSS growth (MB)": mbOrDash((r.peak?.rss ?? 0) - (r.baseline?.rss ?? 0)),
+        "peak anon (MB)": mbOrDash(r.peak?.rssAnon),
+        "peak file (MB)": mbOrDash(r.peak?.rssFile),
+        "minor faults": (r.pageFaults?.minor ?? 0).toLocaleString(),
+        "major faults": (r.pageFaults?.major ?? 0).toLocaleString(),
+        "peak arena (MB)": mbOrDash(r.arena?.peakArenaUsage),
+        "arena blocks": r.arena?.arenaBlocks ?? "-",
+    };
+}
+function printMemoryBlock(block) {
+    console.log("\n" + "=".repeat(60));
+    console.log(`Memory: CSV ${block.size} / ${block.variant}`);
+    console.log(`Dataset: ${(block.bytes / 1024 / 1024).toFixed(2)} MB`);
+    console.log("=".repeat(60));
+    console.table(block.results.map(formatMemoryResult));
+}
+function pct(v) {
+    return `${v >= 0 ? "+" : ""}${(v * 100).toFixed(1)}%`;
+}
+/** "+3.2% [+1.0%, +5.1%]": change of the median and its confidence interval, when known. */
+function formatDelta(r) {
+    if (r.delta === null)
+        return "-";
+    return r.ciLow !== null && r.ciHigh !== null ? `${pct(r.delta)} [${pct(r.ciLow)}, ${pct(r.ciHigh)}]` : pct(r.delta);
+}
+/** Rows that changed (or appeared or vanished) against the baseline, then a one-line verdict. */
+function printComparison(c) {
+    console.log("\n" + "=".repeat(60));
+    console.log(`Compared with ${c.baselinePath ?? "baseline"} (${c.baselineTimestamp})`);
+    console.log("=".repeat(60));
+    for (const w of c.warnings)
+        console.log(`warning: ${w}`);
+    const changed = c.rows.filter((r) => r.verdict !== "unchanged");
+    if (changed.length) {
+        console.table(changed.map((r) => ({
+            dataset: `${r.section} ${r.size}${r.variant ? ` / ${r.variant}` : ""}`,
+            parser: r.name,
+            metric: r.unit ? `${r.metric} (${r.unit})` : r.metric,
+            baseline: r.baseline !== null ? r.baseline.toFixed(2) : "-",
+            current: r.current !== null ? r.current.toFixed(2) : "-",
+            [`delta [${Math.round(c.confidence * 100)}% CI]`]: formatDelta(r),
+            verdict: r.verdict,
+        })));
+    }
+    const unchanged = c.rows.length - changed.length;
+    console.log(`${c.regressions} regression(s), ${c.improvements} improvement(s), ${unchanged} unchanged.`);
+}
 function printReport(report) {
     console.log("\nUltratab Benchmark Report");
     console.log("Generated:", report.timestamp);
@@ -49,5 +162,23 @@ function printReport(report) {
             printXlsxBlock(`XLSX ${block.size}`, block.bytes, block.results);
         }
     }
+    if (report.pathological) {
+        for (const block of report.pathological) {
+            printCsvBlock(`Pathological CSV ${block.size} / ${block.variant}`, block.bytes, block.results);
+        }
+    }
+    if (report.concurrency) {
+        for (const block of report.concurrency) {
+            printConcurrencyBlock(block);
+        }
+    }
+    if (report.memory) {
+        for (const block of report.memory) {
+            printMemoryBlock(block);
+        }
+    }
+    if (report.comparison) {
+        printComparison(report.comparison);
+    }
 }
-module.exports = { formatResult, printCsvBlock, printXlsxBlock, printReport };
+module.exports = { formatResult, formatConcurrencyResult, formatMemoryResult, printCsvBlock, printXlsxBlock, printConcurrencyBlock, printMemoryBlock, printComparison, printReport };
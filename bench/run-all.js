@@ -6,7 +6,9 @@ const { runXlsxBenchForDataset } = require("./runners/xlsx-runner");
 const { printReport } = require("./reporters/console");
 const jsonReporter = require("./reporters/json");
 const mdReporter = require("./reporters/markdown");
+const { loadBaseline, compareWithBaseline } = require("./lib/compare");
 async function main() {
+    const baseline = loadBaseline(process.argv.slice(2));
     const dataDir = config.DATA_DIR;
     const sizes = config.getActiveSizes();
     let csvVariants = config.CSV_VARIANTS;
@@ -62,6 +64,7 @@ async function main() {
             console.log("FAIL:", err.message);
         }
     }
+    const comparison = compareWithBaseline(report, baseline);
     printReport(report);
     const ts = new Date().toISOString().replace(/[:.]/g, "-").slice(0, 19);
     const jsonPath = jsonReporter.writeReport(report, ts);
@@ -69,6 +72,8 @@ async function main() {
     console.log("\nReports written:");
     console.log("  ", jsonPath);
     console.log("  ", mdPath);
+    if (comparison && comparison.regressions > 0)
+        process.exitCode = 1;
 }
 main().catch((err) => {
     console.error(err);
@@ -0,0 +1,89 @@
+"use strict";
+Object.defineProperty(exports, "__esModule", { value: true });
+const fs = require("fs");
+const path = require("path");
+const config = require("./config");
+const { runConcurrencyBench, threadpoolSize } = require("./runners/concurrency-runner");
+const { printReport } = require("./reporters/console");
+const jsonReporter = require("./reporters/json");
+const mdReporter = require("./reporters/markdown");
+const KINDS = ["csv", "columnar", "xlsx"];
+const MODES = ["asyncworker", "iterator"];
+function listFilter(name, allowed) {
+    const value = process.env[name];
+    if (!value)
+        return allowed;
+    const picked = value.split(",").map((s) => s.trim()).filter(Boolean);
+    for (const p of picked) {
+        if (!allowed.includes(p))
+            throw new Error(`Unknown ${name}=${p}`);
+    }
+    return picked;
+}
+async function main() {
+    const dataDir = config.DATA_DIR;
+    const sizeName = process.env.SIZE || "small";
+    if (!(sizeName in config.SIZES))
+        throw new Error(`Unknown SIZE=${sizeName}`);
+    const variant = process.env.VARIANT || "simple";
+    if (!config.CSV_VARIANTS.includes(variant))
+        throw new Error(`Unknown VARIANT=${variant}`);
+    const kinds = listFilter("KIND", KINDS);
+    const modes = listFilter("MODE", MODES);
+    const levels = process.env.CONCURRENCY
+        ? process.env.CONCURRENCY.split(",").map((s) => parseInt(s, 10)).filter((n) => n > 0)
+        : config.CONCURRENCY_LEVELS;
+    const withHttp = process.env.HTTP !== "0";
+    const report = {
+        timestamp: new Date().toISOString(),
+        type: "concurrency",
+        csv: null,
+        xlsx: null,
+        concurrency: [],
+    };
+    for (const kind of kinds) {
+        const fileName = kind === "xlsx" ? `xlsx_${sizeName}.xlsx` : `csv_${sizeName}_${variant}.csv`;
+        const filePath = path.join(dataDir, fileName);
+        if (!fs.existsSync(filePath)) {
+            console.log(`${kind}: FAIL: Dataset not found: ${filePath}. Run npm run bench:generate first.`);
+            continue;
+        }
+        const bytes = fs.statSync(filePath).size;
+        const block = {
+            kind,
+            size: sizeName,
+            variant: kind === "xlsx" ? null : variant,
+            bytes,
+            threadpoolSize: threadpoolSize(),
+            results: [],
+        };
+        for (const concurrency of levels) {
+            for (const mode of modes) {
+                process.stdout.write(`${kind} x${concurrency} (${mode})... `);
+                const result = await runConcurrencyBench({
+                    kind,
+                    mode,
+                    concurrency,
+                    filePath,
+                    fileSize: bytes,
+                    numCols: variant === "wide" ? 100 : 10,
+                    http: withHttp,
+                });
+                block.results.push(result);
+                console.log(result.error ? `FAIL: ${result.error}` : "OK");
+            }
+        }
+        report.concurrency.push(block);
+    }
+    printReport(report);
+    const ts = new Date().toISOString().replace(/[:.]/g, "-").slice(0, 19);
+    const jsonPath = jsonReporter.writeReport(report, ts);
+    const mdPath = mdReporter.writeReport(report, ts);
+    console.log("\nReports written:");
+    console.log("  ", jsonPath);
+    console.log("  ", mdPath);
+}
+main().catch((err) => {
+    console.error(err);
+    process.exit(1);
+});
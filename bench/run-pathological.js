@@ -0,0 +1,68 @@
+"use strict";
+Object.defineProperty(exports, "__esModule", { value: true });
+const config = require("./config");
+const { runPathologicalForDataset } = require("./runners/pathological-runner");
+const { printReport } = require("./reporters/console");
+const jsonReporter = require("./reporters/json");
+const mdReporter = require("./reporters/markdown");
+const { loadBaseline, compareWithBaseline } = require("./lib/compare");
+async function main() {
+    const baseline = loadBaseline(process.argv.slice(2));
+    const dataDir = config.DATA_DIR;
+    const sizes = config.getActiveSizes();
+    let variants = config.PATHOLOGICAL_VARIANTS;
+    const sizeFilter = process.env.SIZE;
+    const variantFilter = process.env.VARIANT;
+    if (sizeFilter) {
+        if (!(sizeFilter in sizes))
+            throw new Error(`Unknown SIZE=${sizeFilter}`);
+        for (const k of Object.keys(sizes)) {
+            if (k !== sizeFilter)
+                delete sizes[k];
+        }
+    }
+    if (variantFilter) {
+        if (!variants.includes(variantFilter))
+            throw new Error(`Unknown VARIANT=${variantFilter}`);
+        variants = [variantFilter];
+    }
+    const report = {
+        timestamp: new Date().toISOString(),
+        type: "pathological",
+        csv: null,
+        xlsx: null,
+        pathological: [],
+    };
+    for (const sizeName of Object.keys(sizes)) {
+        for (const variant of variants) {
+            process.stdout.write(`Pathological ${sizeName} / ${variant}... `);
+            try {
+                const block = await runPathologicalForDataset(sizeName, variant, dataDir);
+                report.pathological.push({
+                    size: block.size,
+                    variant: block.variant,
+                    bytes: block.bytes,
+                    results: block.results,
+                });
+                console.log("OK");
+            }
+            catch (err) {
+                console.log("FAIL:", err.message);
+            }
+        }
+    }
+    const comparison = compareWithBaseline(report, baseline);
+    printReport(report);
+    const ts = new Date().toISOString().replace(/[:.]/g, "-").slice(0, 19);
+    const jsonPath = jsonReporter.writeReport(report, ts);
+    const mdPath = mdReporter.writeReport(report, ts);
+    console.log("\nReports written:");
+    console.log("  ", jsonPath);
+    console.log("  ", mdPath);
+    if (comparison && comparison.regressions > 0)
+        process.exitCode = 1;
+}
+main().catch((err) => {
+    console.error(err);
+    process.exit(1);
+});
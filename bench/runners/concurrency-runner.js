@@ -0,0 +1,215 @@
+"use strict";
+Object.defineProperty(exports, "__esModule", { value: true });
+const fs = require("fs");
+const http = require("http");
+const { monitorEventLoopDelay } = require("node:perf_hooks");
+const { csv, csvColumns, xlsx, createParser, getNextBatch, destroyParser, createColumnarParser, getNextColumnarBatch, destroyColumnarParser, createXlsxParser, getNextXlsxBatch, destroyXlsxParser, } = require("../../index.js");
+const { median, p95 } = require("../lib/metrics");
+const { columnarSchema } = require("../lib/schema");
+const config = require("../config");
+const BATCH_SIZE = config.DEFAULT_BATCH_SIZE;
+function percentile(sorted, p) {
+    if (!sorted.length)
+        return 0;
+    const i = Math.ceil((p / 100) * sorted.length) - 1;
+    return sorted[Math.min(sorted.length - 1, Math.max(0, i))];
+}
+function summarizeLatencies(samples) {
+    const s = [...samples].sort((a, b) => a - b);
+    return { p50: percentile(s, 50), p99: percentile(s, 99), max: s.length ? s[s.length - 1] : 0, count: s.length };
+}
+/** Parse the whole file once with one parser; resolves to its row count. */
+async function consumeOne(opts) {
+    let rows = 0;
+    if (opts.mode === "iterator") {
+        if (opts.kind === "csv") {
+            for await (const batch of csv(opts.filePath, { headers: true, batchSize: BATCH_SIZE }))
+                rows += batch.length;
+        }
+        else if (opts.kind === "columnar") {
+            for await (const batch of csvColumns(opts.filePath, { headers: true, batchSize: BATCH_SIZE, schema: columnarSchema(opts.numCols) }))
+                rows += batch.rows;
+        }
+        else {
+            for await (const batch of xlsx(opts.filePath, { headers: true, batchSize: BATCH_SIZE }))
+                rows += batch.rowsCount;
+        }
+        return rows;
+    }
+    if (opts.kind === "csv") {
+        const parser = createParser(opts.filePath, { headers: true, batchSize: BATCH_SIZE });
+        try {
+            let batch;
+            while ((batch = await getNextBatch(parser)) !== undefined)
+                rows += batch.length;
+        }
+        finally {
+            destroyParser(parser);
+        }
+    }
+    else if (opts.kind === "columnar") {
+        const parser = createColumnarParser(opts.filePath, { headers: true, batchSize: BATCH_SIZE, schema: columnarSchema(opts.numCols) });
+        try {
+            let batch;
+            while ((batch = await getNextColumnarBatch(parser)) !== undefined)
+                rows += batch.rows;
+        }
+        finally {
+            destroyColumnarParser(parser);
+        }
+    }
+    else {
+        const parser = createXlsxParser(opts.filePath, { headers: true, batchSize: BATCH_SIZE });
+        try {
+            let batch;
+            while ((batch = await getNextXlsxBatch(parser)) !== undefined)
+                rows += batch.rowsCount;
+        }
+        finally {
+            destroyXlsxParser(parser);
+        }
+    }
+    return rows;
+}
+/** Back-to-back fs.stat calls until stopped; each records its round trip in ms. */
+function startThreadpoolProbe(filePath) {
+    const samples = [];
+    let running = true;
+    const loop = (async () => {
+        while (running) {
+            const t0 = process.hrtime.bigint();
+            await fs.promises.stat(filePath);
+            samples.push(Number(process.hrtime.bigint() - t0) / 1e6);
+            await new Promise((resolve) => setTimeout(resolve, config.THREADPOOL_PROBE_INTERVAL_MS));
+        }
+    })();
+    return {
+        stop: async () => {
+            running = false;
+            await loop;
+            return samples;
+        },
+    };
+}
+/** A local server plus one client issuing sequential keep-alive GETs; records ms per request. */
+async function startHttpTraffic() {
+    const server = http.createServer((_req, res) => res.end("ok"));
+    await new Promise((resolve) => server.listen(0, "127.0.0.1", resolve));
+    const { port } = server.address();
+    const agent = new http.Agent({ keepAlive: true, maxSockets: 1 });
+    const samples = [];
+    let running = true;
+    const get = () => new Promise((resolve, reject) => {
+        http
+            .get({ host: "127.0.0.1", port, path: "/", agent }, (res) => {
+            res.resume();
+            res.on("end", resolve);
+        })
+            .on("error", reject);
+    });
+    const loop = (async () => {
+        while (running) {
+            const t0 = process.hrtime.bigint();
+            await get();
+            samples.push(Number(process.hrtime.bigint() - t0) / 1e6);
+        }
+    })();
+    return {
+        stop: async () => {
+            running = false;
+            await loop;
+            agent.destroy();
+            await new Promise((resolve) => server.close(resolve));
+            return samples;
+        },
+    };
+}
+/** One timed run: `concurrency` parsers started together, each reading the whole file. */
+async function measureConcurrentRun(opts) {
+    const traffic = opts.http ? await startHttpTraffic() : null;
+    const probe = startThreadpoolProbe(opts.filePath);
+    const elMonitor = monitorEventLoopDelay({ resolution: config.EVENT_LOOP_RESOLUTION_MS });
+    elMonitor.enable();
+    const start = process.hrtime.bigint();
+    const counts = await Promise.all(Array.from({ length: opts.concurrency }, () => consumeOne(opts)));
+    const end = process.hrtime.bigint();
+    elMonitor.disable();
+    // The histogram records whole timer intervals; keep only the delay beyond the resolution.
+    const base = config.EVENT_LOOP_RESOLUTION_MS * 1e6;
+    const excess = (ns) => Math.max(0, ns - base);
+    const probeSamples = await probe.stop();
+    const httpSamples = traffic ? await traffic.stop() : null;
+    return {
+        elapsedMs: Number(end - start) / 1e6,
+        rowCount: counts.reduce((a, b) => a + b, 0),
+        eventLoop: {
+            p50: excess(elMonitor.percentile(50)),
+            p90: excess(elMonitor.percentile(90)),
+            p99: excess(elMonitor.percentile(99)),
+            max: excess(elMonitor.max),
+        },
+        threadpoolProbe: summarizeLatencies(probeSamples),
+        http: httpSamples ? summarizeLatencies(httpSamples) : null,
+    };
+}
+/** Warm up once, then time config.ITERATIONS runs; per-run figures are reduced by median. */
+async function runConcurrencyBench(opts) {
+    const name = `ultratab ${opts.kind} x${opts.concurrency} (${opts.mode})`;
+    try {
+        await measureConcurrentRun({ ...opts, http: false });
+        const runs = [];
+        for (let i = 0; i < config.ITERATIONS; i++) {
+            runs.push(await measureConcurrentRun(opts));
+        }
+        const medianMs = median(runs.map((r) => r.elapsedMs));
+        const totalBytes = opts.fileSize * opts.concurrency;
+        const mb = totalBytes / (1024 * 1024);
+        const pick = (fn) => median(runs.map(fn));
+        return {
+            name,
+            kind: opts.kind,
+            mode: opts.mode,
+            concurrency: opts.concurrency,
+            medianMs,
+            p95Ms: p95(runs.map((r) => r.elapsedMs)),
+            rowCount: runs[0].rowCount,
+            bytesProcessed: totalBytes,
+            aggregateMBps: mb / (medianMs / 1000),
+            perParserMBps: mb / opts.concurrency / (medianMs / 1000),
+            eventLoop: {
+                p50: pick((r) => r.eventLoop.p50),
+                p90: pick((r) => r.eventLoop.p90),
+                p99: pick((r) => r.eventLoop.p99),
+                max: pick((r) => r.eventLoop.max),
+            },
+            threadpoolProbe: {
+                p50: pick((r) => r.threadpoolProbe.p50),
+                p99: pick((r) => r.threadpoolProbe.p99),
+                max: pick((r) => r.threadpoolProbe.max),
+                count: pick((r) => r.threadpoolProbe.count),
+            },
+            http: opts.http
+                ? {
+                    p50: pick((r) => r.http?.p50 ?? 0),
+                    p99: pick((r) => r.http?.p99 ?? 0),
+                    max: pick((r) => r.http?.max ?? 0),
+                    count: pick((r) => r.http?.count ?? 0),
+                }
+                : null,
+            runs: runs.length,
+        };
+    }
+    catch (err) {
+        return { name, kind: opts.kind, mode: opts.mode, concurrency: opts.concurrency, error: err.message };
+    }
+}
+/** libuv pool size for this process (UV_THREADPOOL_SIZE, default 4). */
+function threadpoolSize() {
+    const n = parseInt(process.env.UV_THREADPOOL_SIZE ?? "", 10);
+    return Number.isFinite(n) && n > 0 ? n : 4;
+}
+module.exports = {
+    runConcurrencyBench,
+    measureConcurrentRun,
+    threadpoolSize,
+};
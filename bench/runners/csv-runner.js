@@ -2,21 +2,24 @@
 Object.defineProperty(exports, "__esModule", { value: true });
 const fs = require("fs");
 const path = require("path");
-const { csv, csvColumns } = require("../../index.js");
+const { createParser, getNextBatch, destroyParser, getParserMetrics, createColumnarParser, getNextColumnarBatch, destroyColumnarParser, getColumnarParserMetrics, } = require("../../index.js");
 const Papa = require("papaparse");
 const { parse } = require("csv-parse");
 const { parseStream } = require("@fast-csv/parse");
 const { runBenchmark } = require("../lib/run-bench");
+const { hwSummary, arenaSummary } = require("../lib/metrics");
+const { columnarSchema } = require("../lib/schema");
 const config = require("../config");
 const BATCH_SIZE = config.DEFAULT_BATCH_SIZE;
 async function runPapaParse(filePath, fileSize) {
-    return runBenchmark("papaparse (stream)", async () => {
+    return runBenchmark("papaparse (stream)", async (markFirstBatch) => {
         return new Promise((resolve, reject) => {
             let rowCount = 0;
             const stream = fs.createReadStream(filePath, { encoding: "utf8" });
             Papa.parse(stream, {
                 header: true,
                 step: (results) => {
+                    markFirstBatch();
                     rowCount += results.data.length;
                 },
                 complete: () => resolve({ rowCount, bytesProcessed: fileSize }),
@@ -26,7 +29,7 @@ async function runPapaParse(filePath, fileSize) {
     }, { streaming: true });
 }
 async function runCsvParse(filePath, fileSize) {
-    return runBenchmark("csv-parse (stream)", async () => {
+    return runBenchmark("csv-parse (stream)", async (markFirstBatch) => {
         return new Promise((resolve, reject) => {
             let rowCount = 0;
             const parser = parse({ delimiter: ",", relax_quotes: true });
@@ -34,6 +37,7 @@ async function runCsvParse(filePath, fileSize) {
             fs.createReadStream(filePath)
                 .pipe(parser)
                 .on("data", () => {
+                markFirstBatch();
                 if (first) {
                     first = false;
                     return;
@@ -46,13 +50,14 @@ async function runCsvParse(filePath, fileSize) {
     }, { streaming: true });
 }
 async function runFastCsv(filePath, fileSize) {
-    return runBenchmark("fast-csv (stream)", async () => {
+    return runBenchmark("fast-csv (stream)", async (markFirstBatch) => {
         return new Promise((resolve, reject) => {
             let rowCount = 0;
             const stream = fs.createReadStream(filePath);
             let first = true;
             parseStream(stream, { headers: false })
                 .on("data", () => {
+                markFirstBatch();
                 if (first) {
                     first = false;
                     return;
@@ -65,29 +70,47 @@ async function runFastCsv(filePath, fileSize) {
     }, { streaming: true });
 }
 async function runUltratabCsv(filePath, fileSize) {
-    return runBenchmark("ultratab (string batches)", async () => {
-        let rowCount = 0;
-        for await (const batch of csv(filePath, { headers: false, batchSize: BATCH_SIZE })) {
-            rowCount += batch.length;
+    return runBenchmark("ultratab (string batches)", async (markFirstBatch) => {
+        // Low-level API so the run can report the parser's hardware counters (null when the
+        // kernel does not expose them).
+        const parser = createParser(filePath, { headers: false, batchSize: BATCH_SIZE, perfCounters: true });
+        try {
+            let rowCount = 0;
+            let batch;
+            while ((batch = await getNextBatch(parser)) !== undefined) {
+                markFirstBatch();
+                rowCount += batch.length;
+            }
+            const metrics = getParserMetrics(parser);
+            return { rowCount, bytesProcessed: fileSize, hw: hwSummary(metrics, fileSize), arena: arenaSummary(metrics) };
+        }
+        finally {
+            destroyParser(parser);
         }
-        return { rowCount, bytesProcessed: fileSize };
     }, { streaming: true });
 }
 async function runUltratabColumnar(filePath, fileSize, numCols = 10) {
-    const schema = {};
-    for (let i = 0; i < numCols; i++) {
-        schema[`col${i}`] = i % 3 === 0 ? "string" : "float64";
-    }
-    return runBenchmark("ultratab (columnar typed)", async () => {
-        let rowCount = 0;
-        for await (const batch of csvColumns(filePath, {
+    const schema = columnarSchema(numCols);
+    return runBenchmark("ultratab (columnar typed)", async (markFirstBatch) => {
+        const parser = createColumnarParser(filePath, {
             headers: true,
             batchSize: BATCH_SIZE,
             schema,
-        })) {
-            rowCount += batch.rows;
+            perfCounters: true,
+        });
+        try {
+            let rowCount = 0;
+            let batch;
+            while ((batch = await getNextColumnarBatch(parser)) !== undefined) {
+                markFirstBatch();
+                rowCount += batch.rows;
+            }
+            const metrics = getColumnarParserMetrics(parser);
+            return { rowCount, bytesProcessed: fileSize, hw: hwSummary(metrics, fileSize), arena: arenaSummary(metrics) };
+        }
+        finally {
+            destroyColumnarParser(parser);
         }
-        return { rowCount, bytesProcessed: fileSize };
     }, { streaming: true });
 }
 async function runAllCsvParsers(filePath, fileSize, options = {}) {
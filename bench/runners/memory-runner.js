@@ -0,0 +1,128 @@
+"use strict";
+Object.defineProperty(exports, "__esModule", { value: true });
+const { fork } = require("child_process");
+const { metrics, createParser, getNextBatch, destroyParser, getParserMetrics, createColumnarParser, getNextColumnarBatch, destroyColumnarParser, getColumnarParserMetrics, } = require("../../index.js");
+const { startMemorySampler, timelineByProgress } = require("../lib/memory");
+const { columnarSchema } = require("../lib/schema");
+const config = require("../config");
+function arenaInUse() {
+    const snapshot = metrics();
+    return snapshot.arena?.bytes_in_use ?? 0;
+}
+/**
+ * One parse of the whole file in this process, sampling memory on a timer. Progress comes
+ * from each batch's meta.byteEnd, which works for mmap too (bytes_read jumps to the file
+ * size on the first read there).
+ */
+async function profileInProcess(opts) {
+    let consumed = 0;
+    const sampler = startMemorySampler(config.MEMORY_SAMPLE_INTERVAL_MS, () => (opts.fileSize > 0 ? consumed / opts.fileSize : 1), arenaInUse);
+    const parserOptions = {
+        headers: true,
+        batchSize: config.DEFAULT_BATCH_SIZE,
+        useMmap: opts.mode === "mmap",
+        batchInfo: true,
+    };
+    const start = process.hrtime.bigint();
+    let rowCount = 0;
+    let parserMetrics = null;
+    if (opts.api === "csv") {
+        const parser = createParser(opts.filePath, parserOptions);
+        try {
+            let batch;
+            while ((batch = await getNextBatch(parser)) !== undefined) {
+                rowCount += batch.length;
+                if (batch.meta)
+                    consumed = batch.meta.byteEnd;
+            }
+            parserMetrics = getParserMetrics(parser);
+        }
+        finally {
+            destroyParser(parser);
+        }
+    }
+    else {
+        const parser = createColumnarParser(opts.filePath, { ...parserOptions, schema: columnarSchema(opts.numCols) });
+        try {
+            let batch;
+            while ((batch = await getNextColumnarBatch(parser)) !== undefined) {
+                rowCount += batch.rows;
+                if (batch.meta)
+                    consumed = batch.meta.byteEnd;
+            }
+            parserMetrics = getColumnarParserMetrics(parser);
+        }
+        finally {
+            destroyColumnarParser(parser);
+        }
+    }
+    const elapsedMs = Number(process.hrtime.bigint() - start) / 1e6;
+    consumed = opts.fileSize;
+    const samples = sampler.stop();
+    const first = samples[0];
+    const peak = (fn) => {
+        if (fn(first) === null)
+            return null;
+        return Math.max(...samples.map((s) => fn(s) ?? 0));
+    };
+    const last = samples[samples.length - 1];
+    const points = config.MEMORY_TIMELINE_POINTS;
+    return {
+        name: `ultratab ${opts.api} (${opts.mode})`,
+        api: opts.api,
+        mode: opts.mode,
+        elapsedMs,
+        rowCount,
+        bytesProcessed: opts.fileSize,
+        baseline: { rss: first.rss, rssAnon: first.rssAnon, rssFile: first.rssFile },
+        peak: {
+            rss: peak((s) => s.rss),
+            rssAnon: peak((s) => s.rssAnon),
+            rssFile: peak((s) => s.rssFile),
+            heapUsed: peak((s) => s.heapUsed),
+            arenaInUse: peak((s) => s.arenaInUse),
+        },
+        pageFaults: {
+            minor: last.minorFaults - first.minorFaults,
+            major: last.majorFaults - first.majorFaults,
+        },
+        arena: {
+            peakArenaUsage: parserMetrics?.peak_arena_usage ?? null,
+            arenaBlocks: parserMetrics?.arena_blocks ?? null,
+            arenaBytesAllocated: parserMetrics?.arena_bytes_allocated ?? null,
+        },
+        samples: samples.length,
+        timeline: {
+            points,
+            rss: timelineByProgress(samples, points, (s) => s.rss),
+            rssAnon: first.rssAnon === null ? null : timelineByProgress(samples, points, (s) => s.rssAnon ?? 0),
+            rssFile: first.rssFile === null ? null : timelineByProgress(samples, points, (s) => s.rssFile ?? 0),
+            arenaInUse: timelineByProgress(samples, points, (s) => s.arenaInUse),
+        },
+    };
+}
+/** Runs one profile in a fresh child process so earlier runs do not inflate its RSS. */
+function runMemoryProfile(opts) {
+    const name = `ultratab ${opts.api} (${opts.mode})`;
+    return new Promise((resolve) => {
+        const child = fork(__filename, [JSON.stringify(opts)], { stdio: ["ignore", "inherit", "inherit", "ipc"] });
+        let result = null;
+        child.on("message", (msg) => {
+            result = msg;
+        });
+        child.on("error", (err) => resolve({ name, api: opts.api, mode: opts.mode, error: err.message }));
+        child.on("exit", (code) => {
+            resolve(result ?? { name, api: opts.api, mode: opts.mode, error: `profile process exited with code ${code}` });
+        });
+    });
+}
+if (require.main === module) {
+    const opts = JSON.parse(process.argv[2]);
+    profileInProcess(opts)
+        .catch((err) => ({ name: `ultratab ${opts.api} (${opts.mode})`, api: opts.api, mode: opts.mode, error: err.message }))
+        .then((result) => process.send(result, () => process.exit(0)));
+}
+module.exports = {
+    profileInProcess,
+    runMemoryProfile,
+};
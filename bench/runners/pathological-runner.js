@@ -0,0 +1,80 @@
+"use strict";
+Object.defineProperty(exports, "__esModule", { value: true });
+const fs = require("fs");
+const path = require("path");
+const { createParser, getNextBatch, destroyParser, getParserMetrics, createColumnarParser, getNextColumnarBatch, destroyColumnarParser, getColumnarParserMetrics, } = require("../../index.js");
+const { runBenchmark } = require("../lib/run-bench");
+const { hwSummary, arenaSummary } = require("../lib/metrics");
+const config = require("../config");
+const BATCH_SIZE = config.DEFAULT_BATCH_SIZE;
+/** Parser options shared by every run on a variant; buffer_boundary uses the smallest read buffer. */
+function variantOptions(variant) {
+    const opts = { headers: true, batchSize: BATCH_SIZE, perfCounters: true };
+    if (variant === "buffer_boundary")
+        opts.readBufferSize = config.BOUNDARY_READ_BUFFER_SIZE;
+    return opts;
+}
+async function runUltratabRows(name, filePath, fileSize, options) {
+    return runBenchmark(name, async (markFirstBatch) => {
+        const parser = createParser(filePath, options);
+        try {
+            let rowCount = 0;
+            let batch;
+            while ((batch = await getNextBatch(parser)) !== undefined) {
+                markFirstBatch();
+                rowCount += batch.length;
+            }
+            const metrics = getParserMetrics(parser);
+            return { rowCount, bytesProcessed: fileSize, hw: hwSummary(metrics, fileSize), arena: arenaSummary(metrics) };
+        }
+        finally {
+            destroyParser(parser);
+        }
+    }, { streaming: true });
+}
+/** Columnar with no schema: every column is a string column, so the cost is all tokenize and copy. */
+async function runUltratabColumnarStrings(filePath, fileSize, options) {
+    return runBenchmark("ultratab (columnar strings)", async (markFirstBatch) => {
+        const parser = createColumnarParser(filePath, options);
+        try {
+            let rowCount = 0;
+            let batch;
+            while ((batch = await getNextColumnarBatch(parser)) !== undefined) {
+                markFirstBatch();
+                rowCount += batch.rows;
+            }
+            const metrics = getColumnarParserMetrics(parser);
+            return { rowCount, bytesProcessed: fileSize, hw: hwSummary(metrics, fileSize), arena: arenaSummary(metrics) };
+        }
+        finally {
+            destroyColumnarParser(parser);
+        }
+    }, { streaming: true });
+}
+/** Both tokenizers plus the columnar path on one pathological dataset. */
+async function runPathologicalForDataset(sizeName, variant, dataDir) {
+    const filePath = path.join(dataDir, `csv_${sizeName}_${variant}.csv`);
+    if (!fs.existsSync(filePath)) {
+        throw new Error(`Dataset not found: ${filePath}. Run node bench/dataset/generate-pathological.js first.`);
+    }
+    const bytes = fs.statSync(filePath).size;
+    const options = variantOptions(variant);
+    const runners = [
+        () => runUltratabRows("ultratab (simd)", filePath, bytes, { ...options, engine: "simd" }),
+        () => runUltratabRows("ultratab (dfa)", filePath, bytes, { ...options, engine: "dfa" }),
+        () => runUltratabColumnarStrings(filePath, bytes, options),
+    ];
+    const results = [];
+    for (const run of runners) {
+        try {
+            results.push(await run());
+        }
+        catch (err) {
+            results.push({ name: err.name || "unknown", error: err.message, streaming: null });
+        }
+    }
+    return { size: sizeName, variant, filePath, bytes, results };
+}
+module.exports = {
+    runPathologicalForDataset,
+};
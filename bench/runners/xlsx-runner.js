@@ -14,12 +14,13 @@ async function runExcelJS(filePath, fileSize) {
     catch {
         return { name: "exceljs (stream)", error: "exceljs not installed", streaming: null };
     }
-    return runBenchmark("exceljs (stream)", async () => {
+    return runBenchmark("exceljs (stream)", async (markFirstBatch) => {
         let rowCount = 0;
         const stream = fs.createReadStream(filePath);
         const reader = new ExcelJS.stream.xlsx.WorkbookReader(stream, {});
         for await (const worksheetReader of reader) {
             for await (const _row of worksheetReader) {
+                markFirstBatch();
                 rowCount++;
             }
         }
@@ -31,12 +32,13 @@ async function runExcelJS(filePath, fileSize) {
     }));
 }
 async function runUltratabXlsx(filePath, fileSize) {
-    return runBenchmark("ultratab xlsx", async () => {
+    return runBenchmark("ultratab xlsx", async (markFirstBatch) => {
         let rowCount = 0;
         for await (const batch of ultratabXlsx(filePath, {
             headers: true,
             batchSize: BATCH_SIZE,
         })) {
+            markFirstBatch();
             rowCount += batch.rowsCount;
         }
         return { rowCount, bytesProcessed: fileSize };
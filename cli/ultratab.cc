@@ -0,0 +1,516 @@
+// ultratab: command-line front end to libultratab.
+//
+//   ultratab count   [options] FILE           number of data rows
+//   ultratab head    [options] [-n N] FILE    first N rows as CSV (default 10)
+//   ultratab convert [options] --to csv|tsv|jsonl [-o OUT] FILE
+//   ultratab stats   [options] FILE           per-column summary and parse throughput
+//
+// FILE is CSV unless it ends in .xlsx. Options: -d/--delimiter C, -q/--quote C,
+// --no-header, --engine auto|simd|dfa, --mmap, --batch-size N, --sheet N|NAME.
+
+#include "ultratab.h"
+#include "reader.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ultratab;
+
+namespace {
+
+struct CliOptions {
+  std::string command;
+  std::string path;
+  char delimiter = ',';
+  char quote = '"';
+  bool header = true;
+  TokenizerEngine engine = TokenizerEngine::Auto;
+  bool use_mmap = false;
+  std::size_t batch_size = 10000;
+  std::string sheet;
+  std::size_t head_rows = 10;
+  std::string to = "csv";
+  std::string output;
+};
+
+int usage() {
+  std::fprintf(stderr,
+               "usage: ultratab count   [options] FILE\n"
+               "       ultratab head    [options] [-n N] FILE\n"
+               "       ultratab convert [options] --to csv|tsv|jsonl [-o OUT] FILE\n"
+               "       ultratab stats   [options] FILE\n"
+               "options: -d/--delimiter C  -q/--quote C  --no-header  --engine auto|simd|dfa\n"
+               "         --mmap  --batch-size N  --sheet N|NAME (xlsx)\n");
+  return 2;
+}
+
+int fail(const std::string& message) {
+  std::fprintf(stderr, "ultratab: %s\n", message.c_str());
+  return 1;
+}
+
+bool isXlsx(const std::string& path) {
+  if (path.size() < 5) return false;
+  std::string ext = path.substr(path.size() - 5);
+  for (char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  return ext == ".xlsx";
+}
+
+/// "\t" and "tab" spell a tab; otherwise the first character.
+bool parseChar(const std::string& s, char& out) {
+  if (s == "\\t" || s == "tab") {
+    out = '\t';
+    return true;
+  }
+  if (s.empty()) return false;
+  out = s[0];
+  return true;
+}
+
+bool parseArgs(int argc, char** argv, CliOptions& opts) {
+  if (argc < 2) return false;
+  opts.command = argv[1];
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if ((arg == "-d" || arg == "--delimiter") && has_value) {
+      if (!parseChar(argv[++i], opts.delimiter)) return false;
+    } else if ((arg == "-q" || arg == "--quote") && has_value) {
+      if (!parseChar(argv[++i], opts.quote)) return false;
+    } else if (arg == "--no-header") {
+      opts.header = false;
+    } else if (arg == "--engine" && has_value) {
+      std::string e = argv[++i];
+      if (e == "auto") opts.engine = TokenizerEngine::Auto;
+      else if (e == "simd") opts.engine = TokenizerEngine::Simd;
+      else if (e == "dfa") opts.engine = TokenizerEngine::Dfa;
+      else return false;
+    } else if (arg == "--mmap") {
+      opts.use_mmap = true;
+    } else if (arg == "--batch-size" && has_value) {
+      long n = std::atol(argv[++i]);
+      if (n < 1 || n > 10000000) return false;
+      opts.batch_size = static_cast<std::size_t>(n);
+    } else if (arg == "--sheet" && has_value) {
+      opts.sheet = argv[++i];
+    } else if (arg == "-n" && has_value) {
+      long n = std::atol(argv[++i]);
+      if (n < 0) return false;
+      opts.head_rows = static_cast<std::size_t>(n);
+    } else if (arg == "--to" && has_value) {
+      opts.to = argv[++i];
+      if (opts.to != "csv" && opts.to != "tsv" && opts.to != "jsonl") return false;
+    } else if (arg == "-o" && has_value) {
+      opts.output = argv[++i];
+    } else if (!arg.empty() && arg[0] == '-' && arg != "-") {
+      return false;
+    } else if (opts.path.empty()) {
+      opts.path = arg;
+    } else {
+      return false;
+    }
+  }
+  return !opts.path.empty();
+}
+
+// --- Row sources ---
+
+/// Data rows of a CSV or XLSX file, batch by batch, with the header split off.
+class RowSource {
+ public:
+  virtual ~RowSource() = default;
+
+  /// Next batch of data rows; false at the end or on error (then error() is set).
+  virtual bool next(Batch& rows) = 0;
+  virtual const PipelineMetrics& metrics() const = 0;
+
+  /// Header names; empty with --no-header, filled once the first batch is read.
+  const std::vector<std::string>& header() const { return header_; }
+  const std::string& error() const { return error_; }
+
+ protected:
+  std::vector<std::string> header_;
+  std::string error_;
+};
+
+class CsvSource : public RowSource {
+ public:
+  CsvSource(const CliOptions& opts, std::size_t batch_size)
+      : want_header_(opts.header),
+        parser_(opts.path, csvOptions(opts, batch_size), 2, opts.use_mmap) {}
+
+  bool next(Batch& rows) override {
+    BatchResult r;
+    if (!parser_.queue().pop(r)) return false;
+    if (r.kind == BatchResultKind::Error) {
+      error_ = r.error_message;
+      return false;
+    }
+    if (r.kind != BatchResultKind::Batch) return false;
+    rows = std::move(r.batch);
+    if (want_header_) {
+      want_header_ = false;
+      if (!rows.empty()) {
+        header_ = std::move(rows.front());
+        rows.erase(rows.begin());
+      }
+    }
+    return true;
+  }
+
+  const PipelineMetrics& metrics() const override { return parser_.metrics(); }
+
+ private:
+  static CsvOptions csvOptions(const CliOptions& opts, std::size_t batch_size) {
+    CsvOptions o;
+    o.delimiter = opts.delimiter;
+    o.quote = opts.quote;
+    o.has_header = false;
+    o.batch_size = batch_size;
+    o.engine = opts.engine;
+    return o;
+  }
+
+  bool want_header_;
+  StreamingCsvParser parser_;
+};
+
+class XlsxSource : public RowSource {
+ public:
+  XlsxSource(const CliOptions& opts, std::size_t batch_size)
+      : want_header_(opts.header), parser_(opts.path, xlsxOptions(opts, batch_size)) {}
+
+  bool next(Batch& rows) override {
+    XlsxBatchResult r;
+    if (!parser_.queue().pop(r)) return false;
+    if (r.kind == XlsxResultKind::Error) {
+      error_ = r.error_message;
+      return false;
+    }
+    if (r.kind != XlsxResultKind::Batch) return false;
+    if (want_header_ && header_.empty()) header_ = r.batch.headers;
+    rows = std::move(r.batch.rows);
+    return true;
+  }
+
+  const PipelineMetrics& metrics() const override { return parser_.metrics(); }
+
+ private:
+  static XlsxOptions xlsxOptions(const CliOptions& opts, std::size_t batch_size) {
+    XlsxOptions o;
+    o.headers = opts.header;
+    o.batch_size = batch_size;
+    if (!opts.sheet.empty()) {
+      bool numeric = std::all_of(opts.sheet.begin(), opts.sheet.end(),
+                                 [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+      if (numeric) {
+        o.sheet_index = std::atoi(opts.sheet.c_str());
+      } else {
+        o.sheet_index = 0;
+        o.sheet_name = opts.sheet;
+      }
+    }
+    return o;
+  }
+
+  bool want_header_;
+  StreamingXlsxParser parser_;
+};
+
+std::unique_ptr<RowSource> openSource(const CliOptions& opts, std::size_t batch_size) {
+  if (isXlsx(opts.path)) return std::unique_ptr<RowSource>(new XlsxSource(opts, batch_size));
+  return std::unique_ptr<RowSource>(new CsvSource(opts, batch_size));
+}
+
+// --- Writers ---
+
+enum class OutputFormat { Csv, Tsv, Jsonl };
+
+class RowWriter {
+ public:
+  RowWriter(std::FILE* out, OutputFormat format) : out_(out), format_(format) {}
+
+  void setHeader(const std::vector<std::string>& header) {
+    header_ = header;
+    if (format_ != OutputFormat::Jsonl && !header_.empty()) write(header_);
+  }
+
+  void write(const std::vector<std::string>& row) {
+    if (format_ == OutputFormat::Jsonl) {
+      writeJson(row);
+      return;
+    }
+    char sep = format_ == OutputFormat::Tsv ? '\t' : ',';
+    for (std::size_t i = 0; i < row.size(); ++i) {
+      if (i) std::fputc(sep, out_);
+      writeDelimited(row[i], sep);
+    }
+    std::fputc('\n', out_);
+  }
+
+ private:
+  void writeDelimited(const std::string& field, char sep) {
+    bool needs_quotes = field.find_first_of(std::string{sep, '"', '\r', '\n'}) != std::string::npos;
+    if (!needs_quotes) {
+      std::fwrite(field.data(), 1, field.size(), out_);
+      return;
+    }
+    std::fputc('"', out_);
+    for (char c : field) {
+      if (c == '"') std::fputc('"', out_);
+      std::fputc(c, out_);
+    }
+    std::fputc('"', out_);
+  }
+
+  void writeJsonString(const std::string& s) {
+    std::fputc('"', out_);
+    for (char c : s) {
+      unsigned char u = static_cast<unsigned char>(c);
+      if (c == '"' || c == '\\') {
+        std::fputc('\\', out_);
+        std::fputc(c, out_);
+      } else if (c == '\n') {
+        std::fputs("\\n", out_);
+      } else if (c == '\r') {
+        std::fputs("\\r", out_);
+      } else if (c == '\t') {
+        std::fputs("\\t", out_);
+      } else if (u < 0x20) {
+        std::fprintf(out_, "\\u%04x", u);
+      } else {
+        std::fputc(c, out_);
+      }
+    }
+    std::fputc('"', out_);
+  }
+
+  /// An object keyed by header name with a header, else an array.
+  void writeJson(const std::vector<std::string>& row) {
+    bool object = !header_.empty();
+    std::fputc(object ? '{' : '[', out_);
+    for (std::size_t i = 0; i < row.size(); ++i) {
+      if (i) std::fputc(',', out_);
+      if (object) {
+        writeJsonString(i < header_.size() ? header_[i] : "column" + std::to_string(i + 1));
+        std::fputc(':', out_);
+      }
+      writeJsonString(row[i]);
+    }
+    std::fputs(object ? "}\n" : "]\n", out_);
+  }
+
+  std::FILE* out_;
+  OutputFormat format_;
+  std::vector<std::string> header_;
+};
+
+// --- Commands ---
+
+/// CSV rows are counted straight off the tokenizer, without building strings.
+int countCsv(const CliOptions& opts) {
+  ReaderOptions ropts;
+  ropts.use_mmap = opts.use_mmap;
+  ropts.buffer_size = 256 * 1024;
+  FileReader reader(opts.path, ropts);
+  if (reader.hasError()) return fail(reader.errorMessage());
+  CsvOptions o;
+  o.delimiter = opts.delimiter;
+  o.quote = opts.quote;
+  o.batch_size = 64 * 1024;
+  o.engine = opts.engine;
+  SliceCsvParser parser(o);
+  if (opts.header) parser.skipOneRow();
+  SliceBatch batch;
+  std::uint64_t rows = 0;
+  for (;;) {
+    ByteSpan chunk = reader.getNext();
+    if (chunk.empty()) break;
+    for (std::size_t consumed = 0; consumed < chunk.size;) {
+      consumed += parser.feed(chunk.data + consumed, chunk.size - consumed);
+      if (!parser.hasBatch()) break;
+      parser.takeBatch(batch);
+      rows += batch.rows.size();
+    }
+  }
+  parser.flush();
+  while (parser.hasBatch()) {
+    parser.takeBatch(batch);
+    rows += batch.rows.size();
+  }
+  std::printf("%llu\n", static_cast<unsigned long long>(rows));
+  return 0;
+}
+
+int count(const CliOptions& opts) {
+  if (!isXlsx(opts.path)) return countCsv(opts);
+  std::unique_ptr<RowSource> source = openSource(opts, opts.batch_size);
+  std::uint64_t rows = 0;
+  Batch batch;
+  while (source->next(batch)) rows += batch.size();
+  if (!source->error().empty()) return fail(source->error());
+  std::printf("%llu\n", static_cast<unsigned long long>(rows));
+  return 0;
+}
+
+int head(const CliOptions& opts) {
+  // The header row counts against the batch, so one batch covers header and rows.
+  std::unique_ptr<RowSource> source =
+      openSource(opts, std::max<std::size_t>(1, std::min(opts.head_rows + 1, opts.batch_size)));
+  RowWriter writer(stdout, OutputFormat::Csv);
+  bool header_written = false;
+  std::size_t left = opts.head_rows;
+  Batch batch;
+  while (source->next(batch)) {
+    if (!header_written) {
+      writer.setHeader(source->header());
+      header_written = true;
+    }
+    for (std::size_t i = 0; i < batch.size() && left > 0; ++i, --left) writer.write(batch[i]);
+    if (left == 0) break;
+  }
+  if (!source->error().empty()) return fail(source->error());
+  return 0;
+}
+
+int convert(const CliOptions& opts) {
+  std::FILE* out = stdout;
+  if (!opts.output.empty()) {
+    out = std::fopen(opts.output.c_str(), "wb");
+    if (!out) return fail("cannot write " + opts.output + ": " + std::strerror(errno));
+  }
+  std::setvbuf(out, nullptr, _IOFBF, 1 << 20);
+  OutputFormat format = opts.to == "jsonl" ? OutputFormat::Jsonl
+                        : opts.to == "tsv" ? OutputFormat::Tsv
+                                           : OutputFormat::Csv;
+  std::unique_ptr<RowSource> source = openSource(opts, opts.batch_size);
+  RowWriter writer(out, format);
+  bool header_written = false;
+  Batch batch;
+  while (source->next(batch)) {
+    if (!header_written) {
+      writer.setHeader(source->header());
+      header_written = true;
+    }
+    for (const Row& row : batch) writer.write(row);
+  }
+  bool write_failed = std::ferror(out) != 0;
+  if (out != stdout && std::fclose(out) != 0) write_failed = true;
+  if (!source->error().empty()) return fail(source->error());
+  if (write_failed) return fail("write failed");
+  return 0;
+}
+
+/// Running summary of one column.
+struct ColumnStats {
+  std::uint64_t present = 0;
+  std::uint64_t empty = 0;
+  std::uint64_t ints = 0;
+  std::uint64_t numbers = 0;
+  std::uint64_t bools = 0;
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+  double sum = 0;
+  std::size_t max_len = 0;
+
+  void add(const std::string& v) {
+    max_len = std::max(max_len, v.size());
+    if (v.empty()) {
+      ++empty;
+      return;
+    }
+    ++present;
+    const char* b = v.data();
+    const char* e = b + v.size();
+    std::int64_t i = 0;
+    double d = 0;
+    bool flag = false;
+    if (parseInt64(b, e, i)) {
+      ++ints;
+      ++numbers;
+      d = static_cast<double>(i);
+    } else if (parseFloat64(b, e, d)) {
+      ++numbers;
+    } else {
+      if (parseBool(b, e, flag)) ++bools;
+      return;
+    }
+    min = std::min(min, d);
+    max = std::max(max, d);
+    sum += d;
+  }
+
+  /// The narrowest type every non-empty value parses as.
+  const char* type() const {
+    if (present == 0) return "empty";
+    if (ints == present) return "int";
+    if (numbers == present) return "float";
+    if (bools == present) return "bool";
+    return "string";
+  }
+};
+
+int stats(const CliOptions& opts) {
+  auto start = std::chrono::steady_clock::now();
+  std::unique_ptr<RowSource> source = openSource(opts, opts.batch_size);
+  std::vector<ColumnStats> columns;
+  std::uint64_t rows = 0;
+  Batch batch;
+  while (source->next(batch)) {
+    rows += batch.size();
+    for (const Row& row : batch) {
+      if (row.size() > columns.size()) columns.resize(row.size());
+      for (std::size_t c = 0; c < row.size(); ++c) columns[c].add(row[c]);
+    }
+  }
+  if (!source->error().empty()) return fail(source->error());
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const PipelineMetrics& m = source->metrics();
+  double bytes = static_cast<double>(m.bytes_read.load());
+
+  std::printf("file     %s\n", opts.path.c_str());
+  std::printf("bytes    %.0f\n", bytes);
+  std::printf("rows     %llu\n", static_cast<unsigned long long>(rows));
+  std::printf("columns  %zu\n", columns.size());
+  std::printf("time     %.3f s  (%.1f MB/s, %.0f rows/s)\n", secs,
+              secs > 0 ? bytes / (1024.0 * 1024.0) / secs : 0.0,
+              secs > 0 ? static_cast<double>(rows) / secs : 0.0);
+  std::printf("\n%-24s %-7s %12s %10s %14s %14s %14s %8s\n", "column", "type", "non-empty", "empty",
+              "min", "max", "mean", "max len");
+  const std::vector<std::string>& header = source->header();
+  for (std::size_t c = 0; c < columns.size(); ++c) {
+    const ColumnStats& s = columns[c];
+    std::string name = c < header.size() ? header[c] : "column" + std::to_string(c + 1);
+    std::printf("%-24s %-7s %12llu %10llu", name.c_str(), s.type(),
+                static_cast<unsigned long long>(s.present), static_cast<unsigned long long>(s.empty));
+    if (s.numbers > 0) {
+      std::printf(" %14.6g %14.6g %14.6g", s.min, s.max, s.sum / static_cast<double>(s.numbers));
+    } else {
+      std::printf(" %14s %14s %14s", "-", "-", "-");
+    }
+    std::printf(" %8zu\n", s.max_len);
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  CliOptions opts;
+  if (!parseArgs(argc, argv, opts)) return usage();
+  if (opts.command == "count") return count(opts);
+  if (opts.command == "head") return head(opts);
+  if (opts.command == "convert") return convert(opts);
+  if (opts.command == "stats") return stats(opts);
+  return usage();
+}
@@ -145,16 +145,43 @@ function getColumnarParserMetrics(parser) {
         return null;
     return addon.getColumnarParserMetrics?.(parser) ?? null;
 }
+function metrics(options) {
+    if (options?.format === "openmetrics")
+        return addon.getOpenMetrics();
+    return addon.getMetricsSnapshot();
+}
+function getParserTrace(parser) {
+    if (!parser)
+        return null;
+    return addon.getParserTrace?.(parser) ?? null;
+}
+function getColumnarParserTrace(parser) {
+    if (!parser)
+        return null;
+    return addon.getColumnarParserTrace?.(parser) ?? null;
+}
+function getXlsxParserMetrics(parser) {
+    if (!parser)
+        return null;
+    return addon.getXlsxParserMetrics?.(parser) ?? null;
+}
 module.exports = {
     csv,
     csvColumns,
     xlsx,
+    metrics,
     getParserMetrics,
     getColumnarParserMetrics,
+    getXlsxParserMetrics,
+    getParserTrace,
+    getColumnarParserTrace,
     createParser: (p, opts) => addon.createParser(p, opts),
     getNextBatch: (parser) => addon.getNextBatch(parser),
     destroyParser: (parser) => addon.destroyParser(parser),
     createColumnarParser: (p, opts) => addon.createColumnarParser(p, opts),
     getNextColumnarBatch: (parser) => addon.getNextColumnarBatch(parser),
     destroyColumnarParser: (parser) => addon.destroyColumnarParser(parser),
+    createXlsxParser: (p, opts) => addon.createXlsxParser(p, opts),
+    getNextXlsxBatch: (parser) => addon.getNextXlsxBatch(parser),
+    destroyXlsxParser: (parser) => addon.destroyXlsxParser(parser),
 };
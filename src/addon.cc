@@ -1,10 +1,13 @@
-#include "streaming_parser.h"
-#include "streaming_columnar_parser.h"
-#include "streaming_xlsx_parser.h"
-#include "pipeline_metrics.h"
+#include "ultratab.h"
+#include "alloc_stats.h"
+#include "arena_pool.h"
+#include "perf_counters.h"
+#include "trace_recorder.h"
 #include <napi.h>
+#include <cstdio>
 #include <cstring>
 #include <memory>
+#include <utility>
 
 namespace ultratab {
 
@@ -22,29 +25,59 @@ static Value BatchToValue(Env env, const Batch& batch) {
   return arr;
 }
 
+/// Batch provenance as { index, firstRow, byteStart, byteEnd, tokenizeNs, buildNs,
+/// rowOffsets? }. Offsets are exact as doubles up to 2^53 bytes.
+static Value BatchInfoToValue(Env env, std::uint64_t sequence, const BatchInfo& info,
+                              bool row_offsets) {
+  Object obj = Object::New(env);
+  obj.Set("index", Number::New(env, static_cast<double>(sequence)));
+  obj.Set("firstRow", Number::New(env, static_cast<double>(info.first_row)));
+  obj.Set("byteStart", Number::New(env, static_cast<double>(info.byte_start)));
+  obj.Set("byteEnd", Number::New(env, static_cast<double>(info.byte_end)));
+  obj.Set("tokenizeNs", Number::New(env, static_cast<double>(info.tokenize_ns)));
+  obj.Set("buildNs", Number::New(env, static_cast<double>(info.build_ns)));
+  if (row_offsets) {
+    Float64Array offsets = Float64Array::New(env, info.row_offsets.size());
+    for (std::size_t i = 0; i < info.row_offsets.size(); ++i) {
+      offsets[i] = static_cast<double>(info.row_offsets[i]);
+    }
+    obj.Set("rowOffsets", offsets);
+  }
+  return obj;
+}
+
 class GetNextBatchWorker : public AsyncWorker {
  public:
   GetNextBatchWorker(Napi::Env env, StreamingCsvParser* parser)
       : AsyncWorker(env),
         deferred_(Promise::Deferred::New(env)),
-        parser_(parser),
+        queue_(parser->sharedQueue()),
+        metrics_(parser->sharedMetrics()),
+        tracer_(parser->sharedTracer()),
+        batch_pool_(parser->batchPool()),
+        row_offsets_(parser->batchInfoMode() == BatchInfoMode::RowOffsets),
         result_kind_(BatchResultKind::Done) {}
 
   Promise GetPromise() { return deferred_.Promise(); }
 
   void Execute() override {
+    TraceSpan span(tracer_.get(), TraceStage::Pop, TraceTrack::Pool, 0);
     BatchResult result;
-    if (!parser_->queue().pop(result)) {
+    if (!queue_->pop(result)) {
       result_kind_ = BatchResultKind::Cancelled;
       return;
     }
     result_kind_ = result.kind;
+    sequence_ = result.sequence;
+    span.setBatch(sequence_);
     if (result.kind == BatchResultKind::Error) {
       SetError(result.error_message);
       return;
     }
     if (result.kind == BatchResultKind::Batch) {
       batch_ = std::move(result.batch);
+      has_info_ = result.has_info;
+      info_ = std::move(result.info);
     }
   }
 
@@ -54,18 +87,71 @@ class GetNextBatchWorker : public AsyncWorker {
       deferred_.Resolve(Env().Undefined());
       return;
     }
-    deferred_.Resolve(BatchToValue(Env(), batch_));
+    std::uint64_t t_convert_start = CycleClock::now();
+    Value value;
+    {
+      TraceSpan span(tracer_.get(), TraceStage::Convert, TraceTrack::Main, sequence_);
+      value = BatchToValue(Env(), batch_);
+      if (has_info_) {
+        value.As<Object>().Set("meta", BatchInfoToValue(Env(), sequence_, info_, row_offsets_));
+      }
+    }
+    metrics_->convert_latency.record(CycleClock::elapsedNs(t_convert_start));
+    deferred_.Resolve(value);
+    if (batch_pool_) batch_pool_->release(std::move(batch_));
   }
 
   void OnError(const Error& e) override { deferred_.Reject(e.Value()); }
 
  private:
   Promise::Deferred deferred_;
-  StreamingCsvParser* parser_;
+  std::shared_ptr<RingQueue<BatchResult>> queue_;
+  std::shared_ptr<PipelineMetrics> metrics_;
+  std::shared_ptr<TraceRecorder> tracer_;
+  std::shared_ptr<RecyclePool<Batch>> batch_pool_;
+  bool row_offsets_;
   BatchResultKind result_kind_;
+  std::uint64_t sequence_ = 0;
   Batch batch_;
+  bool has_info_ = false;
+  BatchInfo info_;
 };
 
+static void ParseEngineOption(Object options, TokenizerEngine& engine) {
+  if (!options.Has("engine")) return;
+  Value e = options.Get("engine");
+  if (!e.IsString()) return;
+  std::string s = e.As<String>().Utf8Value();
+  if (s == "auto") engine = TokenizerEngine::Auto;
+  else if (s == "simd") engine = TokenizerEngine::Simd;
+  else if (s == "dfa") engine = TokenizerEngine::Dfa;
+}
+
+/// trace: true for the default ring size, or a number of events.
+static void ParseTraceOption(Object options, std::size_t& capacity) {
+  if (!options.Has("trace")) return;
+  Value t = options.Get("trace");
+  if (t.IsBoolean()) {
+    capacity = t.As<Boolean>().Value() ? TraceRecorder::kDefaultCapacity : 0;
+  } else if (t.IsNumber()) {
+    double n = t.As<Number>().DoubleValue();
+    if (n >= 1 && n <= 16 * 1024 * 1024) capacity = static_cast<std::size_t>(n);
+  }
+}
+
+/// batchInfo: attach a meta object to every batch; rowOffsets: include per-row offsets
+/// (implies batchInfo).
+static void ParseBatchInfoOption(Object options, BatchInfoMode& mode) {
+  if (options.Has("batchInfo")) {
+    Value v = options.Get("batchInfo");
+    if (v.IsBoolean() && v.As<Boolean>().Value()) mode = BatchInfoMode::Ranges;
+  }
+  if (options.Has("rowOffsets")) {
+    Value v = options.Get("rowOffsets");
+    if (v.IsBoolean() && v.As<Boolean>().Value()) mode = BatchInfoMode::RowOffsets;
+  }
+}
+
 static Value CreateParser(const CallbackInfo& info) {
   Env env = info.Env();
   if (info.Length() < 1 || !info[0].IsString()) {
@@ -104,11 +190,16 @@ static Value CreateParser(const CallbackInfo& info) {
           opts.batch_size = static_cast<std::size_t>(n);
       }
     }
+    ParseEngineOption(options, opts.engine);
   }
 
   std::size_t max_queue = 2;
   bool use_mmap = false;
   std::size_t read_buffer_size = 0;
+  bool pooled = false;
+  std::size_t trace_capacity = 0;
+  bool perf_counters = false;
+  BatchInfoMode batch_info = BatchInfoMode::Off;
   if (info.Length() >= 2 && info[1].IsObject()) {
     Object options = info[1].As<Object>();
     if (options.Has("maxQueueBatches")) {
@@ -130,11 +221,22 @@ static Value CreateParser(const CallbackInfo& info) {
           read_buffer_size = static_cast<std::size_t>(n);
       }
     }
+    if (options.Has("pooled")) {
+      Value v = options.Get("pooled");
+      if (v.IsBoolean()) pooled = v.As<Boolean>().Value();
+    }
+    ParseTraceOption(options, trace_capacity);
+    if (options.Has("perfCounters")) {
+      Value v = options.Get("perfCounters");
+      if (v.IsBoolean()) perf_counters = v.As<Boolean>().Value();
+    }
+    ParseBatchInfoOption(options, batch_info);
   }
 
   try {
     auto* parser = new StreamingCsvParser(path, opts, max_queue, use_mmap,
-                                         read_buffer_size);
+                                         read_buffer_size, pooled, trace_capacity,
+                                         perf_counters, batch_info);
     return External<StreamingCsvParser>::New(env, parser);
   } catch (const std::exception& e) {
     Error::New(env, std::string("Failed to create parser: ") + e.what())
@@ -169,6 +271,65 @@ static Value DestroyParser(const CallbackInfo& info) {
   return env.Undefined();
 }
 
+/// Per-parser pool hits/misses plus the process-wide pool size.
+static void SetArenaPoolMetrics(Env env, Object obj, const PipelineMetrics& m) {
+  double hits = static_cast<double>(m.arena_pool_hits.load());
+  double misses = static_cast<double>(m.arena_pool_misses.load());
+  const ArenaBlockPool& pool = ArenaBlockPool::instance();
+  obj.Set("arena_pool_hits", Number::New(env, hits));
+  obj.Set("arena_pool_misses", Number::New(env, misses));
+  obj.Set("arena_pool_hit_rate", Number::New(env, hits + misses > 0 ? hits / (hits + misses) : 0));
+  obj.Set("arena_pool_bytes", Number::New(env, static_cast<double>(pool.pooledBytes())));
+  obj.Set("arena_pool_blocks", Number::New(env, static_cast<double>(pool.pooledBlocks())));
+  obj.Set("arena_pool_huge_pages", Number::New(env, pool.hugePages() ? 1 : 0));
+}
+
+/// Heap allocations per pipeline stage (alloc_<stage>_count / alloc_<stage>_bytes);
+/// alloc_stats is 1 when the addon was built with ULTRATAB_ALLOC_STATS, else all are 0.
+static void SetAllocMetrics(Env env, Object obj, const PipelineMetrics& m) {
+  obj.Set("alloc_stats", Number::New(env, kAllocStatsEnabled ? 1 : 0));
+  for (std::size_t i = 0; i < kAllocStageCount; ++i) {
+    std::string name = allocStageName(static_cast<AllocStage>(i));
+    obj.Set("alloc_" + name + "_count", Number::New(env, static_cast<double>(m.stage_allocs[i].load())));
+    obj.Set("alloc_" + name + "_bytes", Number::New(env, static_cast<double>(m.stage_alloc_bytes[i].load())));
+  }
+}
+
+/// hw_<stage>_<event> counter totals for the events that could be opened; hw_counters is 1
+/// when the parser was created with perfCounters and the kernel granted at least cycles.
+static void SetHwMetrics(Env env, Object obj, const PipelineMetrics& m) {
+  std::uint32_t mask = m.hw_event_mask.load();
+  obj.Set("hw_counters", Number::New(env, mask != 0 ? 1 : 0));
+  for (std::size_t s = 0; s < kHwStageCount; ++s) {
+    for (std::size_t e = 0; e < kHwEventCount; ++e) {
+      if (!(mask & (1u << e))) continue;
+      std::string key = std::string("hw_") + hwStageName(static_cast<HwStage>(s)) + "_" +
+                        hwEventName(static_cast<HwEvent>(e));
+      obj.Set(key, Number::New(env, static_cast<double>(m.hw_counts[s][e].load())));
+    }
+  }
+}
+
+/// latency_<stage>_{count,p50_ns,p99_ns,max_ns} for read (per chunk), tokenize, build,
+/// queue_wait (per batch, worker thread) and convert (per batch, JS thread).
+static void SetLatencyMetrics(Env env, Object obj, const PipelineMetrics& m) {
+  const std::pair<const char*, const LatencyHistogram*> stages[] = {
+      {"read", &m.read_latency},
+      {"tokenize", &m.tokenize_latency},
+      {"build", &m.build_latency},
+      {"queue_wait", &m.queue_wait_latency},
+      {"convert", &m.convert_latency},
+  };
+  for (const auto& stage : stages) {
+    std::string prefix = std::string("latency_") + stage.first;
+    const LatencyHistogram& h = *stage.second;
+    obj.Set(prefix + "_count", Number::New(env, static_cast<double>(h.count())));
+    obj.Set(prefix + "_p50_ns", Number::New(env, static_cast<double>(h.percentile(0.5))));
+    obj.Set(prefix + "_p99_ns", Number::New(env, static_cast<double>(h.percentile(0.99))));
+    obj.Set(prefix + "_max_ns", Number::New(env, static_cast<double>(h.max())));
+  }
+}
+
 static Value GetParserMetrics(const CallbackInfo& info) {
   Env env = info.Env();
   if (info.Length() < 1 || !info[0].IsExternal()) {
@@ -193,119 +354,207 @@ static Value GetParserMetrics(const CallbackInfo& info) {
   obj.Set("arena_blocks", Number::New(env, static_cast<double>(m.arena_blocks.load())));
   obj.Set("arena_resets", Number::New(env, static_cast<double>(m.arena_resets.load())));
   obj.Set("peak_arena_usage", Number::New(env, static_cast<double>(m.peak_arena_usage.load())));
+  obj.Set("quote_free_windows", Number::New(env, static_cast<double>(m.quote_free_windows.load())));
+  obj.Set("arena_large_blocks", Number::New(env, static_cast<double>(m.arena_large_blocks.load())));
+  obj.Set("arena_bytes_trimmed", Number::New(env, static_cast<double>(m.arena_bytes_trimmed.load())));
+  SetArenaPoolMetrics(env, obj, m);
+  SetAllocMetrics(env, obj, m);
+  SetLatencyMetrics(env, obj, m);
+  SetHwMetrics(env, obj, m);
   return obj;
 }
 
 // --- Columnar API ---
 
-static Value ColumnarBatchToValue(Env env, const ColumnarBatch& batch) {
-  Object obj = Object::New(env);
-  Array headers = Array::New(env, batch.headers.size());
-  for (std::size_t i = 0; i < batch.headers.size(); ++i) {
-    headers[i] = String::New(env, batch.headers[i]);
-  }
-  obj.Set("headers", headers);
-  obj.Set("rows", Number::New(env, static_cast<double>(batch.rows)));
-
-  Object columns = Object::New(env);
-  Object nullMask = Object::New(env);
-
-  for (const auto& pair : batch.columns) {
-    const std::string& name = pair.first;
-    const ColumnarColumn& col = pair.second;
+/// Column storage as the TypedArray of the same element type.
+template <typename T>
+static Value TypedArrayValue(Env env, const std::vector<T>& data) {
+  TypedArrayOf<T> arr = TypedArrayOf<T>::New(env, data.size());
+  std::memcpy(arr.Data(), data.data(), data.size() * sizeof(T));
+  return arr;
+}
 
-    switch (col.type) {
-      case ColumnType::String: {
-        Array arr = Array::New(env, col.strings.size());
-        for (std::size_t i = 0; i < col.strings.size(); ++i) {
-          arr[i] = String::New(env, col.strings[i]);
-        }
-        columns.Set(name, arr);
-        break;
-      }
-      case ColumnType::Int32: {
-        Int32Array arr = Int32Array::New(env, col.int32_data->size());
-        std::memcpy(arr.Data(), col.int32_data->data(),
-                    col.int32_data->size() * sizeof(std::int32_t));
-        columns.Set(name, arr);
-        if (col.null_mask) {
-          Uint8Array nm = Uint8Array::New(env, col.null_mask->size());
-          std::memcpy(nm.Data(), col.null_mask->data(), col.null_mask->size());
-          nullMask.Set(name, nm);
-        }
-        break;
-      }
-      case ColumnType::Int64: {
-        BigInt64Array arr = BigInt64Array::New(env, col.int64_data->size());
-        std::memcpy(arr.Data(), col.int64_data->data(),
-                    col.int64_data->size() * sizeof(std::int64_t));
-        columns.Set(name, arr);
-        if (col.null_mask) {
-          Uint8Array nm = Uint8Array::New(env, col.null_mask->size());
-          std::memcpy(nm.Data(), col.null_mask->data(), col.null_mask->size());
-          nullMask.Set(name, nm);
-        }
-        break;
-      }
-      case ColumnType::Float64: {
-        Float64Array arr = Float64Array::New(env, col.float64_data->size());
-        std::memcpy(arr.Data(), col.float64_data->data(),
-                    col.float64_data->size() * sizeof(double));
-        columns.Set(name, arr);
-        if (col.null_mask) {
-          Uint8Array nm = Uint8Array::New(env, col.null_mask->size());
-          std::memcpy(nm.Data(), col.null_mask->data(), col.null_mask->size());
-          nullMask.Set(name, nm);
-        }
-        break;
-      }
-      case ColumnType::Bool: {
-        Uint8Array arr = Uint8Array::New(env, col.bool_data->size());
-        std::memcpy(arr.Data(), col.bool_data->data(), col.bool_data->size());
-        columns.Set(name, arr);
-        if (col.null_mask) {
-          Uint8Array nm = Uint8Array::New(env, col.null_mask->size());
-          std::memcpy(nm.Data(), col.null_mask->data(), col.null_mask->size());
-          nullMask.Set(name, nm);
-        }
-        break;
+/// A column's values: strings as an Array, every other type as the TypedArray of its
+/// storage (Date32 as Int32Array, TimestampUs and Decimal as BigInt64Array, ...).
+static Value ColumnToValue(Env env, const ColumnarColumn& col) {
+  switch (col.type) {
+    case ColumnType::String: {
+      Array arr = Array::New(env, col.strings.size());
+      for (std::size_t i = 0; i < col.strings.size(); ++i) {
+        arr[i] = String::New(env, col.strings[i]);
       }
+      return arr;
     }
+    case ColumnType::Int32:
+    case ColumnType::Date32:
+      return TypedArrayValue(env, *col.int32_data);
+    case ColumnType::Int64:
+    case ColumnType::TimestampUs:
+    case ColumnType::Decimal:
+      return TypedArrayValue(env, *col.int64_data);
+    case ColumnType::Float64:
+    case ColumnType::TimestampMs:
+      return TypedArrayValue(env, *col.float64_data);
+    case ColumnType::Bool:
+      return TypedArrayValue(env, *col.bool_data);
+    case ColumnType::Int8:
+      return TypedArrayValue(env, *col.int8_data);
+    case ColumnType::Int16:
+      return TypedArrayValue(env, *col.int16_data);
+    case ColumnType::UInt8:
+      return TypedArrayValue(env, *col.uint8_data);
+    case ColumnType::UInt16:
+      return TypedArrayValue(env, *col.uint16_data);
+    case ColumnType::UInt32:
+      return TypedArrayValue(env, *col.uint32_data);
+    case ColumnType::Float32:
+      return TypedArrayValue(env, *col.float32_data);
   }
-  obj.Set("columns", columns);
+  return env.Undefined();
+}
 
+/// Null count per typed column; String columns have none.
+static Object NullCounts(Env env, const ColumnarBatch& batch) {
+  Object counts = Object::New(env);
+  for (const auto& pair : batch.columns) {
+    if (pair.second.type == ColumnType::String) continue;
+    counts.Set(pair.first, Number::New(env, static_cast<double>(pair.second.null_count)));
+  }
+  return counts;
+}
+
+/// Columns under \a key, plus nullMask (when any column has one) and nullCount. csvColumns
+/// batches use "columns", columnar XLSX batches "rows".
+static void SetColumns(Env env, Object obj, const char* key, const ColumnarBatch& batch) {
+  Object columns = Object::New(env);
+  Object nullMask = Object::New(env);
   bool hasNullMask = false;
   for (const auto& pair : batch.columns) {
-    if (pair.second.null_mask && !pair.second.null_mask->empty()) {
-      hasNullMask = true;
-      break;
+    const ColumnarColumn& col = pair.second;
+    columns.Set(pair.first, ColumnToValue(env, col));
+    if (!col.null_mask) continue;
+    if (col.type != ColumnType::String) {
+      nullMask.Set(pair.first, TypedArrayValue(env, *col.null_mask));
     }
+    if (!col.null_mask->empty()) hasNullMask = true;
   }
+  obj.Set(key, columns);
   if (hasNullMask) obj.Set("nullMask", nullMask);
+  obj.Set("nullCount", NullCounts(env, batch));
+}
 
+static Value ColumnarBatchToValue(Env env, const ColumnarBatch& batch) {
+  Object obj = Object::New(env);
+  Array headers = Array::New(env, batch.headers.size());
+  for (std::size_t i = 0; i < batch.headers.size(); ++i) {
+    headers[i] = String::New(env, batch.headers[i]);
+  }
+  obj.Set("headers", headers);
+  obj.Set("rows", Number::New(env, static_cast<double>(batch.rows)));
+  SetColumns(env, obj, "columns", batch);
   return obj;
 }
 
-static void ParseColumnarOptions(Env env, Object options, ColumnarOptions& opts) {
-  (void)env;
-  if (options.Has("delimiter")) {
-    Value d = options.Get("delimiter");
-    if (d.IsString()) {
-      std::string s = d.As<String>().Utf8Value();
-      if (!s.empty()) opts.delimiter = s[0];
-    }
+/// "decimal(p,s)" or "decimal(p)", with 1 <= p <= 38 and s <= p.
+static bool ParseDecimalType(const std::string& t, DecimalType& out) {
+  unsigned precision = 0, scale = 0;
+  int used = 0;
+  const char* s = t.c_str();
+  if (std::sscanf(s, "decimal ( %u , %u ) %n", &precision, &scale, &used) != 2 ||
+      static_cast<std::size_t>(used) != t.size()) {
+    scale = 0;
+    used = 0;
+    if (std::sscanf(s, "decimal ( %u ) %n", &precision, &used) != 1 ||
+        static_cast<std::size_t>(used) != t.size())
+      return false;
   }
-  if (options.Has("quote")) {
-    Value q = options.Get("quote");
-    if (q.IsString()) {
-      std::string s = q.As<String>().Utf8Value();
-      if (!s.empty()) opts.quote = s[0];
-    }
+  if (precision < 1 || precision > kMaxDecimalPrecision || scale > precision) return false;
+  out.precision = precision;
+  out.scale = scale;
+  return true;
+}
+
+/// Schema type name to ColumnType (and \a decimal for decimal(p,s)); false for an unknown
+/// name, which is ignored.
+static bool ParseColumnType(const std::string& t, ColumnType& out, DecimalType& decimal) {
+  if (t.compare(0, 7, "decimal") == 0) {
+    if (!ParseDecimalType(t, decimal)) return false;
+    out = ColumnType::Decimal;
+    return true;
   }
-  if (options.Has("headers")) {
-    Value h = options.Get("headers");
-    if (h.IsBoolean()) opts.has_header = h.As<Boolean>().Value();
+  if (t == "string") out = ColumnType::String;
+  else if (t == "int32") out = ColumnType::Int32;
+  else if (t == "int64") out = ColumnType::Int64;
+  else if (t == "float64") out = ColumnType::Float64;
+  else if (t == "bool") out = ColumnType::Bool;
+  else if (t == "int8") out = ColumnType::Int8;
+  else if (t == "int16") out = ColumnType::Int16;
+  else if (t == "uint8") out = ColumnType::UInt8;
+  else if (t == "uint16") out = ColumnType::UInt16;
+  else if (t == "uint32") out = ColumnType::UInt32;
+  else if (t == "float32") out = ColumnType::Float32;
+  else if (t == "date32") out = ColumnType::Date32;
+  else if (t == "timestamp" || t == "timestamp[ms]") out = ColumnType::TimestampMs;
+  else if (t == "timestamp[us]") out = ColumnType::TimestampUs;
+  else return false;
+  return true;
+}
+
+/// timeFormats: { column: pattern }.
+static void ParseTimeFormats(Object options,
+                             std::unordered_map<std::string, std::string>& formats) {
+  if (!options.Has("timeFormats")) return;
+  Value tf = options.Get("timeFormats");
+  if (!tf.IsObject()) return;
+  Object obj = tf.As<Object>();
+  Array keys = obj.GetPropertyNames();
+  for (uint32_t i = 0; i < keys.Length(); ++i) {
+    std::string key = keys.Get(i).As<String>().Utf8Value();
+    Value v = obj.Get(key);
+    if (v.IsString()) formats[key] = v.As<String>().Utf8Value();
   }
+}
+
+/// numberFormats: { col: { decimal, grouping, currency, percent } }. A format whose
+/// decimal is not one byte, or whose separators contain digits or clash, is ignored.
+static void ParseNumberFormats(Object options,
+                               std::unordered_map<std::string, NumberFormat>& formats) {
+  if (!options.Has("numberFormats")) return;
+  Value nf = options.Get("numberFormats");
+  if (!nf.IsObject()) return;
+  Object obj = nf.As<Object>();
+  Array keys = obj.GetPropertyNames();
+  auto hasDigit = [](const std::string& s) {
+    return s.find_first_of("0123456789") != std::string::npos;
+  };
+  for (uint32_t i = 0; i < keys.Length(); ++i) {
+    std::string key = keys.Get(i).As<String>().Utf8Value();
+    Value v = obj.Get(key);
+    if (!v.IsObject()) continue;
+    Object f = v.As<Object>();
+    NumberFormat format;
+    std::string decimal = ".";
+    if (f.Has("decimal") && f.Get("decimal").IsString())
+      decimal = f.Get("decimal").As<String>().Utf8Value();
+    if (f.Has("grouping") && f.Get("grouping").IsString())
+      format.grouping = f.Get("grouping").As<String>().Utf8Value();
+    if (f.Has("currency") && f.Get("currency").IsString())
+      format.currency = f.Get("currency").As<String>().Utf8Value();
+    if (f.Has("percent") && f.Get("percent").IsBoolean())
+      format.percent = f.Get("percent").As<Boolean>().Value();
+    if (decimal.size() != 1 || hasDigit(decimal) || hasDigit(format.grouping) ||
+        hasDigit(format.currency) || format.grouping.find(decimal[0]) != std::string::npos)
+      continue;
+    format.decimal = decimal[0];
+    formats[key] = format;
+  }
+}
+
+/// Options csvColumns and columnar XLSX share: batchSize, select, an object schema,
+/// nullValues, trim, typedFallback, bitPacked, omitEmptyNullMask, timeFormats and
+/// numberFormats. Opts is ColumnarOptions or XlsxOptions.
+template <typename Opts>
+static void ParseTypedColumnOptions(Object options, Opts& opts) {
   if (options.Has("batchSize")) {
     Value b = options.Get("batchSize");
     if (b.IsNumber()) {
@@ -334,12 +583,12 @@ static void ParseColumnarOptions(Env env, Object options, ColumnarOptions& opts)
         std::string key = keys.Get(i).As<String>().Utf8Value();
         Value v = schemaObj.Get(key);
         if (v.IsString()) {
-          std::string t = v.As<String>().Utf8Value();
-          if (t == "string") opts.schema[key] = ColumnType::String;
-          else if (t == "int32") opts.schema[key] = ColumnType::Int32;
-          else if (t == "int64") opts.schema[key] = ColumnType::Int64;
-          else if (t == "float64") opts.schema[key] = ColumnType::Float64;
-          else if (t == "bool") opts.schema[key] = ColumnType::Bool;
+          ColumnType type;
+          DecimalType decimal;
+          if (ParseColumnType(v.As<String>().Utf8Value(), type, decimal)) {
+            opts.schema[key] = type;
+            if (type == ColumnType::Decimal) opts.decimal_types[key] = decimal;
+          }
         }
       }
     }
@@ -367,6 +616,54 @@ static void ParseColumnarOptions(Env env, Object options, ColumnarOptions& opts)
       else if (s == "null") opts.typed_fallback = TypedFallback::Null;
     }
   }
+  if (options.Has("bitPacked")) {
+    Value bp = options.Get("bitPacked");
+    if (bp.IsBoolean()) opts.bit_packed = bp.As<Boolean>().Value();
+  }
+  if (options.Has("omitEmptyNullMask")) {
+    Value om = options.Get("omitEmptyNullMask");
+    if (om.IsBoolean()) opts.omit_empty_null_mask = om.As<Boolean>().Value();
+  }
+  ParseTimeFormats(options, opts.time_formats);
+  ParseNumberFormats(options, opts.number_formats);
+}
+
+static void ParseColumnarOptions(Env env, Object options, ColumnarOptions& opts) {
+  (void)env;
+  if (options.Has("delimiter")) {
+    Value d = options.Get("delimiter");
+    if (d.IsString()) {
+      std::string s = d.As<String>().Utf8Value();
+      if (!s.empty()) opts.delimiter = s[0];
+    }
+  }
+  if (options.Has("quote")) {
+    Value q = options.Get("quote");
+    if (q.IsString()) {
+      std::string s = q.As<String>().Utf8Value();
+      if (!s.empty()) opts.quote = s[0];
+    }
+  }
+  if (options.Has("headers")) {
+    Value h = options.Get("headers");
+    if (h.IsBoolean()) opts.has_header = h.As<Boolean>().Value();
+  }
+  ParseTypedColumnOptions(options, opts);
+  if (options.Has("schema")) {
+    Value sch = options.Get("schema");
+    if (sch.IsString() && sch.As<String>().Utf8Value() == "infer") {
+      opts.infer_schema = true;
+      opts.schema.clear();
+    }
+  }
+  if (options.Has("inferRows")) {
+    Value n = options.Get("inferRows");
+    if (n.IsNumber()) {
+      double v = n.As<Number>().DoubleValue();
+      if (v >= 1 && v <= 10000000) opts.infer_rows = static_cast<std::size_t>(v);
+    }
+  }
+  ParseEngineOption(options, opts.engine);
 }
 
 class GetNextColumnarBatchWorker : public AsyncWorker {
@@ -374,24 +671,32 @@ class GetNextColumnarBatchWorker : public AsyncWorker {
   GetNextColumnarBatchWorker(Napi::Env env, StreamingColumnarParser* parser)
       : AsyncWorker(env),
         deferred_(Promise::Deferred::New(env)),
-        parser_(parser),
+        queue_(parser->sharedQueue()),
+        metrics_(parser->sharedMetrics()),
+        tracer_(parser->sharedTracer()),
+        row_offsets_(parser->batchInfoMode() == BatchInfoMode::RowOffsets),
         result_kind_(ColumnarResultKind::Done) {}
 
   Promise GetPromise() { return deferred_.Promise(); }
 
   void Execute() override {
+    TraceSpan span(tracer_.get(), TraceStage::Pop, TraceTrack::Pool, 0);
     ColumnarBatchResult result;
-    if (!parser_->queue().pop(result)) {
+    if (!queue_->pop(result)) {
       result_kind_ = ColumnarResultKind::Cancelled;
       return;
     }
     result_kind_ = result.kind;
+    sequence_ = result.sequence;
+    span.setBatch(sequence_);
     if (result.kind == ColumnarResultKind::Error) {
       SetError(result.error_message);
       return;
     }
     if (result.kind == ColumnarResultKind::Batch) {
       batch_ = std::move(result.batch);
+      has_info_ = result.has_info;
+      info_ = std::move(result.info);
     }
   }
 
@@ -401,16 +706,32 @@ class GetNextColumnarBatchWorker : public AsyncWorker {
       deferred_.Resolve(Env().Undefined());
       return;
     }
-    deferred_.Resolve(ColumnarBatchToValue(Env(), batch_));
+    std::uint64_t t_convert_start = CycleClock::now();
+    Value value;
+    {
+      TraceSpan span(tracer_.get(), TraceStage::Convert, TraceTrack::Main, sequence_);
+      value = ColumnarBatchToValue(Env(), batch_);
+      if (has_info_) {
+        value.As<Object>().Set("meta", BatchInfoToValue(Env(), sequence_, info_, row_offsets_));
+      }
+    }
+    metrics_->convert_latency.record(CycleClock::elapsedNs(t_convert_start));
+    deferred_.Resolve(value);
   }
 
   void OnError(const Error& e) override { deferred_.Reject(e.Value()); }
 
  private:
   Promise::Deferred deferred_;
-  StreamingColumnarParser* parser_;
+  std::shared_ptr<RingQueue<ColumnarBatchResult>> queue_;
+  std::shared_ptr<PipelineMetrics> metrics_;
+  std::shared_ptr<TraceRecorder> tracer_;
+  bool row_offsets_;
   ColumnarResultKind result_kind_;
+  std::uint64_t sequence_ = 0;
   ColumnarBatch batch_;
+  bool has_info_ = false;
+  BatchInfo info_;
 };
 
 static Value CreateColumnarParser(const CallbackInfo& info) {
@@ -430,6 +751,9 @@ static Value CreateColumnarParser(const CallbackInfo& info) {
   std::size_t max_queue = 2;
   bool use_mmap = false;
   std::size_t read_buffer_size = 0;
+  std::size_t trace_capacity = 0;
+  bool perf_counters = false;
+  BatchInfoMode batch_info = BatchInfoMode::Off;
   if (info.Length() >= 2 && info[1].IsObject()) {
     Object options = info[1].As<Object>();
     if (options.Has("maxQueueBatches")) {
@@ -451,11 +775,18 @@ static Value CreateColumnarParser(const CallbackInfo& info) {
           read_buffer_size = static_cast<std::size_t>(n);
       }
     }
+    ParseTraceOption(options, trace_capacity);
+    if (options.Has("perfCounters")) {
+      Value v = options.Get("perfCounters");
+      if (v.IsBoolean()) perf_counters = v.As<Boolean>().Value();
+    }
+    ParseBatchInfoOption(options, batch_info);
   }
 
   try {
     auto* parser = new StreamingColumnarParser(path, opts, max_queue, use_mmap,
-                                               read_buffer_size);
+                                               read_buffer_size, trace_capacity, perf_counters,
+                                               batch_info);
     return External<StreamingColumnarParser>::New(env, parser);
   } catch (const std::exception& e) {
     Error::New(env, std::string("Failed to create columnar parser: ") + e.what())
@@ -503,79 +834,7 @@ static Value XlsxBatchToValue(Env env, const XlsxBatch& batch) {
   obj.Set("rowsCount", Number::New(env, static_cast<double>(batch.rowsCount())));
 
   if (batch.columnar) {
-    const ColumnarBatch& col = batch.columnar_batch;
-    Object columns = Object::New(env);
-    Object nullMask = Object::New(env);
-    for (const auto& pair : col.columns) {
-      const std::string& name = pair.first;
-      const ColumnarColumn& col_col = pair.second;
-      switch (col_col.type) {
-        case ColumnType::String: {
-          Array arr = Array::New(env, col_col.strings.size());
-          for (std::size_t i = 0; i < col_col.strings.size(); ++i) {
-            arr[i] = String::New(env, col_col.strings[i]);
-          }
-          columns.Set(name, arr);
-          break;
-        }
-        case ColumnType::Int32: {
-          Int32Array arr = Int32Array::New(env, col_col.int32_data->size());
-          std::memcpy(arr.Data(), col_col.int32_data->data(),
-                      col_col.int32_data->size() * sizeof(std::int32_t));
-          columns.Set(name, arr);
-          if (col_col.null_mask) {
-            Uint8Array nm = Uint8Array::New(env, col_col.null_mask->size());
-            std::memcpy(nm.Data(), col_col.null_mask->data(), col_col.null_mask->size());
-            nullMask.Set(name, nm);
-          }
-          break;
-        }
-        case ColumnType::Int64: {
-          BigInt64Array arr = BigInt64Array::New(env, col_col.int64_data->size());
-          std::memcpy(arr.Data(), col_col.int64_data->data(),
-                      col_col.int64_data->size() * sizeof(std::int64_t));
-          columns.Set(name, arr);
-          if (col_col.null_mask) {
-            Uint8Array nm = Uint8Array::New(env, col_col.null_mask->size());
-            std::memcpy(nm.Data(), col_col.null_mask->data(), col_col.null_mask->size());
-            nullMask.Set(name, nm);
-          }
-          break;
-        }
-        case ColumnType::Float64: {
-          Float64Array arr = Float64Array::New(env, col_col.float64_data->size());
-          std::memcpy(arr.Data(), col_col.float64_data->data(),
-                      col_col.float64_data->size() * sizeof(double));
-          columns.Set(name, arr);
-          if (col_col.null_mask) {
-            Uint8Array nm = Uint8Array::New(env, col_col.null_mask->size());
-            std::memcpy(nm.Data(), col_col.null_mask->data(), col_col.null_mask->size());
-            nullMask.Set(name, nm);
-          }
-          break;
-        }
-        case ColumnType::Bool: {
-          Uint8Array arr = Uint8Array::New(env, col_col.bool_data->size());
-          std::memcpy(arr.Data(), col_col.bool_data->data(), col_col.bool_data->size());
-          columns.Set(name, arr);
-          if (col_col.null_mask) {
-            Uint8Array nm = Uint8Array::New(env, col_col.null_mask->size());
-            std::memcpy(nm.Data(), col_col.null_mask->data(), col_col.null_mask->size());
-            nullMask.Set(name, nm);
-          }
-          break;
-        }
-      }
-    }
-    obj.Set("rows", columns);
-    bool hasNullMask = false;
-    for (const auto& pair : col.columns) {
-      if (pair.second.null_mask && !pair.second.null_mask->empty()) {
-        hasNullMask = true;
-        break;
-      }
-    }
-    if (hasNullMask) obj.Set("nullMask", nullMask);
+    SetColumns(env, obj, "rows", batch.columnar_batch);
   } else {
     Array rowsArr = Array::New(env, batch.rows.size());
     for (std::size_t i = 0; i < batch.rows.size(); ++i) {
@@ -606,67 +865,7 @@ static void ParseXlsxOptions(Env env, Object options, XlsxOptions& opts) {
     Value h = options.Get("headers");
     if (h.IsBoolean()) opts.headers = h.As<Boolean>().Value();
   }
-  if (options.Has("batchSize")) {
-    Value b = options.Get("batchSize");
-    if (b.IsNumber()) {
-      double n = b.As<Number>().DoubleValue();
-      if (n >= 1 && n <= 10000000)
-        opts.batch_size = static_cast<std::size_t>(n);
-    }
-  }
-  if (options.Has("select")) {
-    Value sel = options.Get("select");
-    if (sel.IsArray()) {
-      Array arr = sel.As<Array>();
-      opts.select.clear();
-      for (uint32_t i = 0; i < arr.Length(); ++i) {
-        Value v = arr[i];
-        if (v.IsString()) opts.select.push_back(v.As<String>().Utf8Value());
-      }
-    }
-  }
-  if (options.Has("schema")) {
-    Value sch = options.Get("schema");
-    if (sch.IsObject()) {
-      Object schemaObj = sch.As<Object>();
-      Array keys = schemaObj.GetPropertyNames();
-      for (uint32_t i = 0; i < keys.Length(); ++i) {
-        std::string key = keys.Get(i).As<String>().Utf8Value();
-        Value v = schemaObj.Get(key);
-        if (v.IsString()) {
-          std::string t = v.As<String>().Utf8Value();
-          if (t == "string") opts.schema[key] = ColumnType::String;
-          else if (t == "int32") opts.schema[key] = ColumnType::Int32;
-          else if (t == "int64") opts.schema[key] = ColumnType::Int64;
-          else if (t == "float64") opts.schema[key] = ColumnType::Float64;
-          else if (t == "bool") opts.schema[key] = ColumnType::Bool;
-        }
-      }
-    }
-  }
-  if (options.Has("nullValues")) {
-    Value nv = options.Get("nullValues");
-    if (nv.IsArray()) {
-      Array arr = nv.As<Array>();
-      opts.null_values.clear();
-      for (uint32_t i = 0; i < arr.Length(); ++i) {
-        Value v = arr[i];
-        if (v.IsString()) opts.null_values.push_back(v.As<String>().Utf8Value());
-      }
-    }
-  }
-  if (options.Has("trim")) {
-    Value t = options.Get("trim");
-    if (t.IsBoolean()) opts.trim = t.As<Boolean>().Value();
-  }
-  if (options.Has("typedFallback")) {
-    Value tf = options.Get("typedFallback");
-    if (tf.IsString()) {
-      std::string s = tf.As<String>().Utf8Value();
-      if (s == "string") opts.typed_fallback = TypedFallback::String;
-      else if (s == "null") opts.typed_fallback = TypedFallback::Null;
-    }
-  }
+  ParseTypedColumnOptions(options, opts);
 }
 
 class GetNextXlsxBatchWorker : public AsyncWorker {
@@ -763,6 +962,22 @@ static Value DestroyXlsxParser(const CallbackInfo& info) {
   return env.Undefined();
 }
 
+static Value GetXlsxParserMetrics(const CallbackInfo& info) {
+  Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsExternal()) {
+    TypeError::New(env, "Expected parser (external) as first argument")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  auto* parser = info[0].As<External<StreamingXlsxParser>>().Data();
+  const PipelineMetrics& m = parser->metrics();
+  Object obj = Object::New(env);
+  obj.Set("rows_parsed", Number::New(env, static_cast<double>(m.rows_parsed.load())));
+  obj.Set("batches_emitted", Number::New(env, static_cast<double>(m.batches_emitted.load())));
+  SetAllocMetrics(env, obj, m);
+  return obj;
+}
+
 static Value GetColumnarParserMetrics(const CallbackInfo& info) {
   Env env = info.Env();
   if (info.Length() < 1 || !info[0].IsExternal()) {
@@ -787,21 +1002,96 @@ static Value GetColumnarParserMetrics(const CallbackInfo& info) {
   obj.Set("arena_blocks", Number::New(env, static_cast<double>(m.arena_blocks.load())));
   obj.Set("arena_resets", Number::New(env, static_cast<double>(m.arena_resets.load())));
   obj.Set("peak_arena_usage", Number::New(env, static_cast<double>(m.peak_arena_usage.load())));
+  obj.Set("quote_free_windows", Number::New(env, static_cast<double>(m.quote_free_windows.load())));
+  obj.Set("arena_large_blocks", Number::New(env, static_cast<double>(m.arena_large_blocks.load())));
+  obj.Set("arena_bytes_trimmed", Number::New(env, static_cast<double>(m.arena_bytes_trimmed.load())));
+  SetArenaPoolMetrics(env, obj, m);
+  SetAllocMetrics(env, obj, m);
+  SetLatencyMetrics(env, obj, m);
+  SetHwMetrics(env, obj, m);
+  return obj;
+}
+
+static Object KindTotalsToObject(Env env, const ParserKindTotals& t) {
+  Object obj = Object::New(env);
+  obj.Set("created", Number::New(env, static_cast<double>(t.created)));
+  obj.Set("active", Number::New(env, static_cast<double>(t.active)));
+  obj.Set("bytes_read", Number::New(env, static_cast<double>(t.bytes_read)));
+  obj.Set("rows_parsed", Number::New(env, static_cast<double>(t.rows_parsed)));
+  obj.Set("batches_emitted", Number::New(env, static_cast<double>(t.batches_emitted)));
+  obj.Set("parse_time_ns", Number::New(env, static_cast<double>(t.parse_time_ns)));
+  obj.Set("queue_wait_ns", Number::New(env, static_cast<double>(t.queue_wait_ns)));
+  obj.Set("queue_depth", Number::New(env, static_cast<double>(t.queue_depth)));
+  return obj;
+}
+
+/// Process-wide totals over all parsers, live and destroyed (see MetricsRegistry).
+static Value GetMetricsSnapshot(const CallbackInfo& info) {
+  Env env = info.Env();
+  MetricsSnapshot s = MetricsRegistry::instance().snapshot();
+  Object parsers = Object::New(env);
+  ParserKindTotals total;
+  for (std::size_t k = 0; k < kParserKindCount; ++k) {
+    const ParserKindTotals& t = s.kinds[k];
+    parsers.Set(parserKindName(static_cast<ParserKind>(k)), KindTotalsToObject(env, t));
+    total.created += t.created;
+    total.active += t.active;
+    total.bytes_read += t.bytes_read;
+    total.rows_parsed += t.rows_parsed;
+    total.batches_emitted += t.batches_emitted;
+    total.parse_time_ns += t.parse_time_ns;
+    total.queue_wait_ns += t.queue_wait_ns;
+    total.queue_depth += t.queue_depth;
+  }
+  Object arena = Object::New(env);
+  arena.Set("bytes_in_use", Number::New(env, static_cast<double>(s.arena_bytes_in_use)));
+  arena.Set("pool_bytes", Number::New(env, static_cast<double>(s.arena_pool_bytes)));
+  arena.Set("pool_blocks", Number::New(env, static_cast<double>(s.arena_pool_blocks)));
+  arena.Set("pool_hits", Number::New(env, static_cast<double>(s.arena_pool_hits)));
+  arena.Set("pool_misses", Number::New(env, static_cast<double>(s.arena_pool_misses)));
+  Object obj = Object::New(env);
+  obj.Set("parsers", parsers);
+  obj.Set("total", KindTotalsToObject(env, total));
+  obj.Set("arena", arena);
   return obj;
 }
 
+static Value GetOpenMetrics(const CallbackInfo& info) {
+  return String::New(info.Env(), MetricsRegistry::instance().toOpenMetrics());
+}
+
+/// Chrome trace JSON of a parser created with trace enabled; null otherwise.
+template <typename Parser>
+static Value GetTrace(const CallbackInfo& info) {
+  Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsExternal()) {
+    TypeError::New(env, "Expected parser (external) as first argument")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  auto* parser = info[0].As<External<Parser>>().Data();
+  TraceRecorder* tracer = parser->tracer();
+  if (!tracer) return env.Null();
+  return String::New(env, tracer->toChromeJson());
+}
+
 static Object Init(Env env, Object exports) {
   exports.Set("createParser", Function::New(env, CreateParser));
   exports.Set("getNextBatch", Function::New(env, GetNextBatch));
   exports.Set("destroyParser", Function::New(env, DestroyParser));
   exports.Set("getParserMetrics", Function::New(env, GetParserMetrics));
+  exports.Set("getParserTrace", Function::New(env, GetTrace<StreamingCsvParser>));
   exports.Set("createColumnarParser", Function::New(env, CreateColumnarParser));
   exports.Set("getNextColumnarBatch", Function::New(env, GetNextColumnarBatch));
   exports.Set("destroyColumnarParser", Function::New(env, DestroyColumnarParser));
   exports.Set("getColumnarParserMetrics", Function::New(env, GetColumnarParserMetrics));
+  exports.Set("getColumnarParserTrace", Function::New(env, GetTrace<StreamingColumnarParser>));
   exports.Set("createXlsxParser", Function::New(env, CreateXlsxParser));
   exports.Set("getNextXlsxBatch", Function::New(env, GetNextXlsxBatch));
   exports.Set("destroyXlsxParser", Function::New(env, DestroyXlsxParser));
+  exports.Set("getXlsxParserMetrics", Function::New(env, GetXlsxParserMetrics));
+  exports.Set("getMetricsSnapshot", Function::New(env, GetMetricsSnapshot));
+  exports.Set("getOpenMetrics", Function::New(env, GetOpenMetrics));
   return exports;
 }
 
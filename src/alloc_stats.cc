@@ -0,0 +1,82 @@
+#include "alloc_stats.h"
+
+#ifdef ULTRATAB_ALLOC_STATS
+
+#include <cstdlib>
+#include <new>
+
+namespace ultratab {
+
+namespace {
+
+thread_local PipelineMetrics* t_metrics = nullptr;
+thread_local AllocStage t_stage = AllocStage::Read;
+
+inline void recordAlloc(std::size_t size) {
+  PipelineMetrics* m = t_metrics;
+  if (!m) return;
+  std::size_t i = static_cast<std::size_t>(t_stage);
+  m->stage_allocs[i].fetch_add(1, std::memory_order_relaxed);
+  m->stage_alloc_bytes[i].fetch_add(size, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+AllocStageScope::AllocStageScope(PipelineMetrics* metrics, AllocStage stage)
+    : prev_metrics_(t_metrics), prev_stage_(t_stage) {
+  t_metrics = metrics;
+  t_stage = stage;
+}
+
+AllocStageScope::~AllocStageScope() {
+  t_metrics = prev_metrics_;
+  t_stage = prev_stage_;
+}
+
+}  // namespace ultratab
+
+// Replacement global allocation functions. On Linux the CMake option also links with
+// -Bsymbolic and a static libstdc++, so the addon's calls (including std::string
+// internals) bind to these while Node and V8 keep the host's allocator.
+
+namespace {
+
+void* countedAlloc(std::size_t size) {
+  ultratab::recordAlloc(size);
+  return std::malloc(size > 0 ? size : 1);
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  void* p = countedAlloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](std::size_t size) {
+  void* p = countedAlloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+
+#endif  // ULTRATAB_ALLOC_STATS
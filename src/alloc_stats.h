@@ -0,0 +1,51 @@
+#ifndef ULTRATAB_ALLOC_STATS_H
+#define ULTRATAB_ALLOC_STATS_H
+
+#include "pipeline_metrics.h"
+
+namespace ultratab {
+
+/// True when built with ULTRATAB_ALLOC_STATS (CMake option of the same name): the addon's
+/// global operator new/delete are replaced by counting wrappers.
+#ifdef ULTRATAB_ALLOC_STATS
+constexpr bool kAllocStatsEnabled = true;
+#else
+constexpr bool kAllocStatsEnabled = false;
+#endif
+
+/// Metric key suffix for a stage ("read", "tokenize", "build", "emit").
+inline const char* allocStageName(AllocStage stage) {
+  switch (stage) {
+    case AllocStage::Read: return "read";
+    case AllocStage::Tokenize: return "tokenize";
+    case AllocStage::Build: return "build";
+    case AllocStage::Emit: return "emit";
+  }
+  return "";
+}
+
+/// Attributes heap allocations made on the current thread to (metrics, stage) until
+/// destroyed. Scopes nest; the enclosing one is restored on exit. Compiles to nothing
+/// without ULTRATAB_ALLOC_STATS.
+class AllocStageScope {
+ public:
+#ifdef ULTRATAB_ALLOC_STATS
+  AllocStageScope(PipelineMetrics* metrics, AllocStage stage);
+  ~AllocStageScope();
+#else
+  AllocStageScope(PipelineMetrics*, AllocStage) {}
+#endif
+
+  AllocStageScope(const AllocStageScope&) = delete;
+  AllocStageScope& operator=(const AllocStageScope&) = delete;
+
+#ifdef ULTRATAB_ALLOC_STATS
+ private:
+  PipelineMetrics* prev_metrics_;
+  AllocStage prev_stage_;
+#endif
+};
+
+}  // namespace ultratab
+
+#endif  // ULTRATAB_ALLOC_STATS_H
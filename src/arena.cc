@@ -1,5 +1,8 @@
 #include "arena.h"
+#include "arena_pool.h"
 #include "pipeline_metrics.h"
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
@@ -15,15 +18,24 @@ inline std::size_t alignUp(std::size_t value, std::size_t alignment) {
   return (value + alignment - 1) & ~(alignment - 1);
 }
 
+/// Offset within \a data at or after \a used where the address is \a alignment-aligned.
+inline std::size_t alignedOffset(const char* data, std::size_t used, std::size_t alignment) {
+  std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(data) + used;
+  return used + (alignUp(addr, alignment) - addr);
+}
+
 }  // namespace
 
 Arena::Arena(std::size_t block_size) {
   block_size_ = std::max(kMinBlockSize, std::min(kMaxBlockSize, block_size));
+  // Huge-page mode: let blocks grow to at least one full huge page.
+  if (ArenaBlockPool::instance().hugePages())
+    block_size_ = std::max(block_size_, ArenaBlockPool::kHugePageSize);
 }
 
 Arena::~Arena() {
   for (Block& b : blocks_) {
-    std::free(b.data);
+    ArenaBlockPool::instance().release(b.data, b.capacity);
     b.data = nullptr;
     b.capacity = 0;
     b.used = 0;
@@ -31,16 +43,39 @@ Arena::~Arena() {
   blocks_.clear();
 }
 
-void Arena::addBlock() {
+void Arena::addBlock(std::size_t capacity, bool dedicated) {
   Block b;
-  b.data = static_cast<char*>(std::malloc(block_size_));
+  bool pool_hit = false;
+  b.data = ArenaBlockPool::instance().acquire(capacity, &pool_hit);
   if (!b.data) {
     std::abort();
   }
-  b.capacity = block_size_;
+  b.capacity = capacity;
   b.used = 0;
-  blocks_.push_back(b);
-  bytes_allocated_ += block_size_;
+  b.dedicated = dedicated;
+  std::size_t pos = blocks_.empty() ? 0 : current_ + 1;
+  blocks_.insert(blocks_.begin() + static_cast<std::ptrdiff_t>(pos), b);
+  current_ = pos;
+  if (!dedicated) last_block_size_ = capacity;
+  bytes_allocated_ += capacity;
+  if (metrics_) {
+    metrics_->arena_resizes.fetch_add(1);
+    if (dedicated) metrics_->arena_large_blocks.fetch_add(1);
+    if (pool_hit) metrics_->arena_pool_hits.fetch_add(1);
+    else metrics_->arena_pool_misses.fetch_add(1);
+  }
+  publishBlockStats();
+}
+
+void Arena::freeBlock(Block& b) {
+  bytes_allocated_ -= b.capacity;
+  ArenaBlockPool::instance().release(b.data, b.capacity);
+  b.data = nullptr;
+  b.capacity = 0;
+  b.used = 0;
+}
+
+void Arena::publishBlockStats() {
   if (metrics_) {
     metrics_->arena_bytes_allocated.store(bytes_allocated_);
     metrics_->arena_blocks.store(static_cast<std::uint64_t>(blocks_.size()));
@@ -65,32 +100,47 @@ void* Arena::allocate(std::size_t size, std::size_t alignment,
   if (alignment == 0) alignment = 1;
   if ((alignment & (alignment - 1)) != 0) alignment = 1;
 
-  if (blocks_.empty()) {
-    addBlock();
-  }
-
-  Block& cur = blocks_.back();
-  std::size_t aligned_used = alignUp(cur.used, alignment);
-  std::size_t need = aligned_used + size;
-  if (need > cur.capacity) {
-    addBlock();
-    Block& next = blocks_.back();
-    std::size_t aligned_start = alignUp(0, alignment);
-    if (out_logical_offset) *out_logical_offset = logical_used_;
-    logical_used_ += size;
-    next.used = aligned_start + size;
-    updatePeakUsage();
-    if (metrics_) {
-      metrics_->arena_bytes_allocated.store(bytes_allocated_);
+  // Current block first, then the empty spares retained by reset().
+  while (current_ < blocks_.size()) {
+    Block& cur = blocks_[current_];
+    std::size_t aligned_used = alignedOffset(cur.data, cur.used, alignment);
+    if (aligned_used + size <= cur.capacity) {
+      // Padding is part of the linearized buffer, so it counts towards used().
+      if (out_logical_offset) *out_logical_offset = logical_used_ + (aligned_used - cur.used);
+      logical_used_ += (aligned_used - cur.used) + size;
+      cur.used = aligned_used + size;
+      updatePeakUsage();
+      return cur.data + aligned_used;
     }
-    return next.data + aligned_start;
+    if (current_ + 1 == blocks_.size()) break;
+    ++current_;
   }
 
-  cur.used = aligned_used + size;
-  if (out_logical_offset) *out_logical_offset = logical_used_;
-  logical_used_ += size;
+  // malloc alignment covers the usual cases; larger alignments are added to the size.
+  std::size_t need = size + (alignment > alignof(std::max_align_t) ? alignment : 0);
+  if (need > block_size_) {
+    addBlock(need, true);
+  } else {
+    std::size_t next = last_block_size_ == 0 ? kInitialBlockSize
+                                             : std::min(block_size_, last_block_size_ * 2);
+    while (next < need) next *= 2;
+    addBlock(std::min(block_size_, next), false);
+  }
+  Block& b = blocks_[current_];
+  std::size_t aligned_start = alignedOffset(b.data, 0, alignment);
+  if (out_logical_offset) *out_logical_offset = logical_used_ + aligned_start;
+  logical_used_ += aligned_start + size;
+  b.used = aligned_start + size;
   updatePeakUsage();
-  return cur.data + aligned_used;
+  return b.data + aligned_start;
+}
+
+void Arena::release(std::size_t size) {
+  if (blocks_.empty()) return;
+  Block& cur = blocks_[current_];
+  size = std::min(size, cur.used);
+  cur.used -= size;
+  logical_used_ -= size;
 }
 
 std::size_t Arena::write(const char* data, std::size_t size) {
@@ -104,7 +154,8 @@ std::size_t Arena::write(const char* data, std::size_t size) {
 
 void Arena::copyUsedTo(std::vector<char>& out) const {
   out.clear();
-  out.reserve(logical_used_);
+  // Headroom so a reused buffer is not reallocated for a batch a few bytes larger.
+  if (out.capacity() < logical_used_) out.reserve(logical_used_ + logical_used_ / 8);
   for (const Block& b : blocks_) {
     if (b.used > 0) {
       out.insert(out.end(), b.data, b.data + b.used);
@@ -113,14 +164,33 @@ void Arena::copyUsedTo(std::vector<char>& out) const {
 }
 
 void Arena::reset() {
-  for (Block& b : blocks_) {
+  // Keep regular blocks (in order) up to the furthest one either of the last two batches
+  // reached, tails skipped by writes that did not fit included; free dedicated blocks
+  // and the remaining spares.
+  std::size_t reached = blocks_.empty() ? 0 : current_ + 1;
+  std::size_t keep_blocks = std::max(reached, prev_batch_blocks_);
+  prev_batch_blocks_ = reached;
+  std::uint64_t trimmed = 0;
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < blocks_.size(); ++i) {
+    Block& b = blocks_[i];
+    if (b.dedicated || i >= keep_blocks) {
+      trimmed += b.capacity;
+      freeBlock(b);
+      continue;
+    }
     b.used = 0;
+    blocks_[kept++] = b;
   }
+  blocks_.resize(kept);
+  current_ = 0;
   logical_used_ = 0;
   ++resets_;
   if (metrics_) {
     metrics_->arena_resets.store(resets_);
+    if (trimmed > 0) metrics_->arena_bytes_trimmed.fetch_add(trimmed);
   }
+  publishBlockStats();
 }
 
 }  // namespace ultratab
@@ -9,12 +9,21 @@ namespace ultratab {
 
 struct PipelineMetrics;
 
-/// Production-grade arena allocator: large blocks, bump-pointer, reset per batch.
+/// Production-grade arena allocator: bump-pointer blocks, reset per batch.
 /// Used for temporary parse structures, slice byte storage, and row metadata.
 /// Does not hold memory that must survive beyond batch emission; copy out on takeBatch.
+///
+/// Blocks grow geometrically from kInitialBlockSize up to the maximum block size, so a
+/// small batch only pays for a small block. A request larger than the maximum block size
+/// (e.g. a multi-MB cell) gets a dedicated block of exactly that size. reset() frees the
+/// dedicated blocks and trims regular blocks down to the recent high-water mark.
 class Arena {
  public:
-  /// \a block_size bytes per block (clamped to [1<<20, 16<<20]).
+  /// First regular block size in bytes.
+  static constexpr std::size_t kInitialBlockSize = 64 * 1024;
+
+  /// \a block_size: maximum regular block size (clamped to [1<<20, 16<<20]; at least
+  /// 2MB when the block pool runs in huge-page mode). Blocks come from ArenaBlockPool.
   explicit Arena(std::size_t block_size = 1024 * 1024);
 
   ~Arena();
@@ -32,6 +41,10 @@ class Arena {
   /// Alignment applies to the returned pointer; logical offset may differ.
   void* allocate(std::size_t size, std::size_t alignment, std::size_t* out_logical_offset);
 
+  /// Give back the last \a size bytes of the most recent allocation (for writers that
+  /// reserve an upper bound, e.g. unescaping into the arena).
+  void release(std::size_t size);
+
   /// Convenience: allocate and copy \a data[0..size]; returns logical offset.
   std::size_t write(const char* data, std::size_t size);
 
@@ -41,7 +54,8 @@ class Arena {
   /// Copy all used bytes in order (block0[0..used0], block1[0..used1], ...) into \a out.
   void copyUsedTo(std::vector<char>& out) const;
 
-  /// Reset bump pointers so all blocks can be reused. Does not free blocks; updates stats.
+  /// Reset bump pointers so retained blocks can be reused. Frees dedicated (oversized)
+  /// blocks and regular blocks beyond what the last two batches needed; updates stats.
   void reset();
 
   /// Current total capacity (sum of all block sizes). Debug only.
@@ -61,14 +75,24 @@ class Arena {
     char* data = nullptr;
     std::size_t capacity = 0;
     std::size_t used = 0;
+    bool dedicated = false;
   };
 
-  void addBlock();
+  /// Insert a block after the current one and make it current.
+  void addBlock(std::size_t capacity, bool dedicated);
+  void freeBlock(Block& b);
+  void publishBlockStats();
   void updatePeakUsage();
 
   std::size_t block_size_;
   std::vector<Block> blocks_;
+  /// Index of the block being filled; blocks after it are empty spares.
+  std::size_t current_ = 0;
+  /// Size of the most recent regular block (geometric growth).
+  std::size_t last_block_size_ = 0;
   std::size_t logical_used_ = 0;
+  /// Blocks the previous batch reached (trim keeps the larger of the last two batches).
+  std::size_t prev_batch_blocks_ = 0;
   std::uint64_t bytes_allocated_ = 0;
   std::uint64_t resets_ = 0;
   std::uint64_t peak_usage_ = 0;
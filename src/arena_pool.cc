@@ -0,0 +1,94 @@
+#include "arena_pool.h"
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace ultratab {
+
+namespace {
+
+const std::size_t kDefaultPoolBytes = 64u * 1024 * 1024;  // 64MB
+const std::size_t kMaxPooledBlock = 16u * 1024 * 1024;    // largest regular block
+
+inline bool isPowerOfTwo(std::size_t v) { return v != 0 && (v & (v - 1)) == 0; }
+
+std::size_t poolBudgetFromEnv() {
+  const char* v = std::getenv("ULTRATAB_ARENA_POOL_MB");
+  if (!v || !*v) return kDefaultPoolBytes;
+  char* end = nullptr;
+  unsigned long mb = std::strtoul(v, &end, 10);
+  if (end == v) return kDefaultPoolBytes;
+  return static_cast<std::size_t>(mb) * 1024 * 1024;
+}
+
+bool hugePagesFromEnv() {
+  const char* v = std::getenv("ULTRATAB_HUGEPAGES");
+  return v && (v[0] == '1' || v[0] == 't' || v[0] == 'T');
+}
+
+}  // namespace
+
+ArenaBlockPool& ArenaBlockPool::instance() {
+  static ArenaBlockPool* pool = new ArenaBlockPool();
+  return *pool;
+}
+
+ArenaBlockPool::ArenaBlockPool()
+    : max_bytes_(poolBudgetFromEnv()), huge_pages_(hugePagesFromEnv()) {}
+
+char* ArenaBlockPool::allocateBlock(std::size_t capacity) const {
+#if defined(__linux__)
+  if (huge_pages_ && capacity >= kHugePageSize) {
+    std::size_t rounded = (capacity + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    void* p = nullptr;
+    if (posix_memalign(&p, kHugePageSize, rounded) == 0) {
+#if defined(MADV_HUGEPAGE)
+      madvise(p, rounded, MADV_HUGEPAGE);
+#endif
+      return static_cast<char*>(p);
+    }
+  }
+#endif
+  return static_cast<char*>(std::malloc(capacity));
+}
+
+char* ArenaBlockPool::acquire(std::size_t capacity, bool* hit) {
+  if (isPowerOfTwo(capacity) && capacity <= kMaxPooledBlock) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = free_blocks_.find(capacity);
+    if (it != free_blocks_.end() && !it->second.empty()) {
+      char* data = it->second.back();
+      it->second.pop_back();
+      pooled_bytes_.fetch_sub(capacity, std::memory_order_relaxed);
+      pooled_blocks_.fetch_sub(1, std::memory_order_relaxed);
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      in_use_bytes_.fetch_add(capacity, std::memory_order_relaxed);
+      if (hit) *hit = true;
+      return data;
+    }
+  }
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  if (hit) *hit = false;
+  char* data = allocateBlock(capacity);
+  if (data) in_use_bytes_.fetch_add(capacity, std::memory_order_relaxed);
+  return data;
+}
+
+void ArenaBlockPool::release(char* data, std::size_t capacity) {
+  if (!data) return;
+  in_use_bytes_.fetch_sub(capacity, std::memory_order_relaxed);
+  if (isPowerOfTwo(capacity) && capacity <= kMaxPooledBlock) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pooled_bytes_.load(std::memory_order_relaxed) + capacity <= max_bytes_) {
+      free_blocks_[capacity].push_back(data);
+      pooled_bytes_.fetch_add(capacity, std::memory_order_relaxed);
+      pooled_blocks_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  }
+  std::free(data);
+}
+
+}  // namespace ultratab
@@ -0,0 +1,68 @@
+#ifndef ULTRATAB_ARENA_POOL_H
+#define ULTRATAB_ARENA_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace ultratab {
+
+/// Process-wide, thread-safe pool of arena blocks shared by all parsers, so services
+/// that open many parsers reuse MB-sized blocks instead of churning malloc/free.
+///
+/// Only power-of-two block sizes (the regular Arena growth sizes) are pooled, up to a
+/// byte budget: ULTRATAB_ARENA_POOL_MB (default 64; 0 disables pooling). With
+/// ULTRATAB_HUGEPAGES=1, blocks of 2 MB and larger are 2 MB-aligned and advised
+/// MADV_HUGEPAGE (Linux only) to cut TLB misses on large batches.
+class ArenaBlockPool {
+ public:
+  /// Huge page size used for aligned blocks in huge-page mode.
+  static constexpr std::size_t kHugePageSize = 2 * 1024 * 1024;
+
+  /// The process-wide pool. Never destroyed, so arenas may release blocks during exit.
+  static ArenaBlockPool& instance();
+
+  ArenaBlockPool(const ArenaBlockPool&) = delete;
+  ArenaBlockPool& operator=(const ArenaBlockPool&) = delete;
+
+  /// Get a block of \a capacity bytes. *hit is set to true when it came from the pool.
+  char* acquire(std::size_t capacity, bool* hit);
+
+  /// Return a block obtained from acquire(). Pooled if the size and budget allow, else freed.
+  void release(char* data, std::size_t capacity);
+
+  /// Bytes / blocks currently held by the pool.
+  std::uint64_t pooledBytes() const { return pooled_bytes_.load(std::memory_order_relaxed); }
+  std::uint64_t pooledBlocks() const { return pooled_blocks_.load(std::memory_order_relaxed); }
+
+  /// Bytes of blocks handed out by acquire() and not yet released, process-wide.
+  std::uint64_t inUseBytes() const { return in_use_bytes_.load(std::memory_order_relaxed); }
+
+  /// acquire() calls served from / missing the pool, process-wide.
+  std::uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+  std::uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+  bool hugePages() const { return huge_pages_; }
+
+ private:
+  ArenaBlockPool();
+
+  char* allocateBlock(std::size_t capacity) const;
+
+  std::mutex mutex_;
+  std::unordered_map<std::size_t, std::vector<char*>> free_blocks_;  // by capacity
+  std::size_t max_bytes_;
+  bool huge_pages_;
+  std::atomic<std::uint64_t> pooled_bytes_{0};
+  std::atomic<std::uint64_t> pooled_blocks_{0};
+  std::atomic<std::uint64_t> in_use_bytes_{0};
+  std::atomic<std::uint64_t> hits_{0};
+  std::atomic<std::uint64_t> misses_{0};
+};
+
+}  // namespace ultratab
+
+#endif  // ULTRATAB_ARENA_POOL_H
@@ -1,5 +1,8 @@
 #include "batch_builder.h"
+#include "datetime_parser.h"
+#include <algorithm>
 #include <cstring>
+#include <memory>
 #include <string>
 
 namespace ultratab {
@@ -14,6 +17,29 @@ std::string sliceToStr(const FieldSlice& s, const char* arena_data,
   return std::string(arena_data + s.offset, end - s.offset);
 }
 
+/// Like sliceToStr, but assigns into an existing string so its capacity is reused.
+void assignSlice(std::string& dst, const FieldSlice& s, const char* arena_data,
+                 std::size_t arena_size) {
+  if (s.offset >= arena_size || s.len == 0) {
+    dst.clear();
+    return;
+  }
+  std::size_t end = s.offset + s.len;
+  if (end > arena_size) end = arena_size;
+  dst.assign(arena_data + s.offset, end - s.offset);
+}
+
+/// Slice \a s clamped to the arena as [start, end), trimmed with \a features when \a trim.
+void sliceBounds(const FieldSlice& s, const char* arena_data, std::size_t arena_size,
+                 bool trim, const CpuFeatures& features, const char*& start,
+                 const char*& end) {
+  std::size_t begin = s.offset < arena_size ? s.offset : arena_size;
+  std::size_t stop = s.offset + s.len < arena_size ? s.offset + s.len : arena_size;
+  start = arena_data + begin;
+  end = arena_data + (stop > begin ? stop : begin);
+  if (trim) trimSlice(start, end, features);
+}
+
 }  // namespace
 
 std::vector<std::string> sliceRowToStrings(const SliceRow& row,
@@ -28,27 +54,89 @@ std::vector<std::string> sliceRowToStrings(const SliceRow& row,
 }
 
 void buildRowBatch(const SliceBatch& slice_batch, Batch& out) {
-  out.clear();
   const char* arena = slice_batch.arena.data();
   std::size_t arena_size = slice_batch.arena.size();
-  out.reserve(slice_batch.rows.size());
-  for (const auto& row : slice_batch.rows) {
-    out.push_back(sliceRowToStrings(row, arena, arena_size));
+  // Overwrite in place: a recycled batch keeps its row vectors and string buffers.
+  out.resize(slice_batch.rows.size());
+  for (std::size_t i = 0; i < slice_batch.rows.size(); ++i) {
+    const SliceRow& row = slice_batch.rows[i];
+    Row& dst = out[i];
+    dst.resize(row.size());
+    for (std::size_t j = 0; j < row.size(); ++j) {
+      assignSlice(dst[j], row[j], arena, arena_size);
+    }
   }
 }
 
 void buildColumnarBatch(const SliceBatch& slice_batch,
                         const std::vector<std::string>& headers,
                         const ColumnarOptions& options,
+                        const NullMatcher& nulls,
                         ColumnarBatch& out) {
   const char* arena = slice_batch.arena.data();
   std::size_t arena_size = slice_batch.arena.size();
-  Batch row_batch;
-  row_batch.reserve(slice_batch.rows.size());
-  for (const auto& row : slice_batch.rows) {
-    row_batch.push_back(sliceRowToStrings(row, arena, arena_size));
+  const CpuFeatures& features = trimFeatures(options.engine);
+  // Cells are views into the arena, so typed values are parsed where they lie and only
+  // String columns copy. Trimming narrows each view here; the conversion's own check on
+  // an already trimmed cell stops at two compares.
+  CellViews cells;
+  std::size_t total = 0;
+  for (const SliceRow& row : slice_batch.rows) total += row.size();
+  cells.cells.reserve(total);
+  cells.row_start.reserve(slice_batch.rows.size() + 1);
+  for (const SliceRow& row : slice_batch.rows) {
+    for (const FieldSlice& slice : row) {
+      const char* start;
+      const char* end;
+      sliceBounds(slice, arena, arena_size, options.trim, features, start, end);
+      cells.cells.emplace_back(start, static_cast<std::size_t>(end - start));
+    }
+    cells.row_start.push_back(cells.cells.size());
+  }
+  rowsToColumnar(cells, headers, options, nulls, out);
+}
+
+void inferSchema(const SliceBatch& slice_batch, const std::vector<std::string>& headers,
+                 const NullMatcher& nulls, ColumnarOptions& options) {
+  const char* arena = slice_batch.arena.data();
+  std::size_t arena_size = slice_batch.arena.size();
+  std::size_t rows = std::min(slice_batch.rows.size(), options.infer_rows);
+  const CpuFeatures& features = trimFeatures(options.engine);
+  std::unordered_set<std::string> select_set(options.select.begin(), options.select.end());
+  for (std::size_t col_idx = 0; col_idx < headers.size(); ++col_idx) {
+    const std::string& hdr = headers[col_idx];
+    if (!select_set.empty() && select_set.count(hdr) == 0) continue;
+    auto nf = options.number_formats.find(hdr);
+    const NumberFormat* number_format =
+        nf != options.number_formats.end() ? &nf->second : nullptr;
+    std::unique_ptr<TimeFormat> time_format;
+    auto fmt = options.time_formats.find(hdr);
+    if (fmt != options.time_formats.end()) {
+      time_format.reset(new TimeFormat(fmt->second));
+      if (!time_format->valid()) time_format.reset();
+    }
+    char num_buf[kMaxNumberText];
+    bool seen = false;
+    ColumnType type = ColumnType::String;
+    for (std::size_t r = 0; r < rows; ++r) {
+      const SliceRow& row = slice_batch.rows[r];
+      const char* start = arena;
+      const char* end = arena;
+      if (col_idx < row.size())
+        sliceBounds(row[col_idx], arena, arena_size, options.trim, features, start, end);
+      if (nulls.match(start, static_cast<std::size_t>(end - start))) continue;
+      std::size_t num_len = 0;
+      if (number_format && normalizeNumber(start, end, *number_format, num_buf, num_len)) {
+        start = num_buf;
+        end = num_buf + num_len;
+      }
+      type = seen ? widenColumnType(type, time_format.get(), start, end)
+                  : inferValueType(time_format.get(), start, end);
+      seen = true;
+      if (type == ColumnType::String) break;
+    }
+    options.schema[hdr] = type;
   }
-  rowsToColumnar(row_batch, headers, options, out);
 }
 
 }  // namespace ultratab
@@ -13,12 +13,21 @@ namespace ultratab {
 void buildRowBatch(const SliceBatch& slice_batch, Batch& out);
 
 /// Build columnar ColumnarBatch from SliceBatch. Uses arena for string views;
-/// typed columns parsed in place. Headers and options for schema/select/null/trim.
+/// typed columns parsed in place. Headers and options for schema/select/null/trim;
+/// \a nulls is options.null_values compiled once by the caller.
 void buildColumnarBatch(const SliceBatch& slice_batch,
                         const std::vector<std::string>& headers,
                         const ColumnarOptions& options,
+                        const NullMatcher& nulls,
                         ColumnarBatch& out);
 
+/// schema: "infer". Set options.schema for every selected column to the narrowest type
+/// that holds its first options.infer_rows values in \a slice_batch, reading times through
+/// the column's options.time_formats pattern when it has one; null values are skipped and
+/// a column with no other value stays String.
+void inferSchema(const SliceBatch& slice_batch, const std::vector<std::string>& headers,
+                 const NullMatcher& nulls, ColumnarOptions& options);
+
 /// Extract header row from first row of a SliceBatch (arena-backed).
 std::vector<std::string> sliceRowToStrings(const SliceRow& row,
                                             const char* arena_data,
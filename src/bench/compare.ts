@@ -0,0 +1,29 @@
+"use strict";
+
+const fs = require("fs");
+const { compareReports, parseCompareArgs } = require("./lib/compare");
+const { printComparison } = require("./reporters/console");
+
+/**
+ * Compares two saved JSON reports without re-running anything:
+ *   node bench/compare.js baseline.json current.json [--threshold 0.05]
+ * Exits 1 when any metric regressed.
+ */
+function main(): void {
+  const argv = process.argv.slice(2);
+  const files = argv.filter((a, i) => !a.startsWith("--") && !(i > 0 && argv[i - 1] === "--threshold"));
+  if (files.length !== 2) {
+    console.error("usage: node bench/compare.js <baseline.json> <current.json> [--threshold <fraction>]");
+    process.exit(2);
+  }
+  const { threshold } = parseCompareArgs(argv);
+  const [baselinePath, currentPath] = files;
+  const baseline = JSON.parse(fs.readFileSync(baselinePath, "utf8"));
+  const current = JSON.parse(fs.readFileSync(currentPath, "utf8"));
+  const comparison = compareReports(baseline, current, { threshold });
+  comparison.baselinePath = baselinePath;
+  printComparison(comparison);
+  if (comparison.regressions > 0) process.exitCode = 1;
+}
+
+main();
@@ -3,6 +3,7 @@
 const config = require("../config");
 const { generateAllCsv } = require("./generate-csv");
 const { generateAllXlsx } = require("./generate-xlsx");
+const { generateAllPathological } = require("./generate-pathological");
 
 function ensureReportsDir(): void {
   if (!require("fs").existsSync(config.REPORTS_DIR)) {
@@ -16,8 +17,10 @@ async function main(): Promise<void> {
   ensureReportsDir();
   const csvManifest = generateAllCsv();
   console.log("");
+  generateAllPathological();
+  console.log("");
   const xlsxManifest = await generateAllXlsx();
-  console.log("\nDone. CSV and XLSX datasets ready.");
+  console.log("\nDone. CSV, pathological CSV and XLSX datasets ready.");
 }
 
 main()
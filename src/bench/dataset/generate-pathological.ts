@@ -0,0 +1,133 @@
+"use strict";
+
+const fs = require("fs");
+const path = require("path");
+const config = require("../config");
+const { ensureDataDir } = require("./generate-csv");
+const { seededRandom } = require("../lib/metrics");
+
+interface GenerateResult {
+  path: string;
+  bytes: number;
+  rows: number;
+}
+
+/** A quoted field of exactly `len` bytes (quotes included) holding commas, newlines and "" pairs. */
+function quotedBlob(len: number, seq: number): string {
+  const unit = `x${seq % 10},y ""z""\n`;
+  let inner = unit.repeat(Math.ceil(len / unit.length)).slice(0, Math.max(0, len - 2));
+  // An odd run of trailing quotes means the cut split a "" pair.
+  const trailing = inner.length - inner.replace(/"+$/, "").length;
+  if (trailing % 2) inner = inner.slice(0, -1) + "q";
+  return `"${inner}"`;
+}
+
+/**
+ * Writes one pathological CSV of about `targetBytes`:
+ * - cols_10k: 10,000 short fields per row.
+ * - huge_field: every eighth row carries a quoted field of config.HUGE_FIELD_BYTES.
+ * - all_quoted: every field quoted, each with embedded "" escapes.
+ * - mixed_eol: LF and CRLF endings mixed at random, plus quoted CRLFs inside fields.
+ * - buffer_boundary: CRLF rows of exactly config.BOUNDARY_ROW_BYTES (a prime), so successive
+ *   read-buffer boundaries land on every byte offset within a row, quotes and CR/LF included.
+ * - skewed_rows: field lengths drawn from a Pareto distribution, from bytes to about a MB.
+ */
+function generatePathologicalCsv(filePath: string, targetBytes: number, variant: string): GenerateResult {
+  ensureDataDir();
+  const fd = fs.openSync(filePath, "w");
+  const bufSize = 256 * 1024;
+  let buf = "";
+  let bytes = 0;
+  let rows = 0;
+  const random = seededRandom(0x5eed);
+
+  const flush = (): void => {
+    if (buf.length > 0) {
+      fs.writeSync(fd, buf);
+      bytes += Buffer.byteLength(buf, "utf8");
+      buf = "";
+    }
+  };
+
+  const cols = variant === "cols_10k" ? 10000 : variant === "huge_field" || variant === "skewed_rows" ? 4 : 10;
+  const eol = variant === "buffer_boundary" ? "\r\n" : "\n";
+  const header = Array.from({ length: cols }, (_, i) => `col${i}`).join(",") + eol;
+  fs.writeSync(fd, header);
+  bytes += Buffer.byteLength(header, "utf8");
+  rows++;
+
+  const hugeBytes = Math.min(config.HUGE_FIELD_BYTES, Math.floor(targetBytes / 2));
+
+  const generators: Record<string, () => string> = {
+    cols_10k() {
+      return Array.from({ length: cols }, (_, i) => String((rows + i) % 1000)).join(",") + "\n";
+    },
+    huge_field() {
+      const blob = rows % 8 === 1 ? quotedBlob(hugeBytes, rows) : quotedBlob(64, rows);
+      return `${rows},${blob},v${rows},end\n`;
+    },
+    all_quoted() {
+      return Array.from({ length: cols }, (_, i) => `"a ""quoted"" value, ${rows}_${i}"`).join(",") + "\n";
+    },
+    mixed_eol() {
+      const parts = Array.from({ length: cols }, (_, i) => `${rows}_${i}`);
+      if (rows % 10 === 0) parts[cols - 1] = `"cell\r\nwith CRLF ${rows}"`;
+      return parts.join(",") + (random() < 0.5 ? "\r\n" : "\n");
+    },
+    buffer_boundary() {
+      const head = `${rows},"q ""${rows}"", x",`;
+      const tail = eol;
+      const fill = Math.max(0, config.BOUNDARY_ROW_BYTES - head.length - tail.length - (cols - 3));
+      const rest = Array.from({ length: cols - 2 }, () => "");
+      rest[0] = "p".repeat(fill);
+      return head + rest.join(",") + tail;
+    },
+    skewed_rows() {
+      return (
+        Array.from({ length: cols }, (_, i) => {
+          // Pareto with alpha 1.1: median around 16 bytes, a few fields near the 1 MB cap.
+          const len = Math.min(1024 * 1024, Math.floor(12 / Math.pow(1 - random(), 1 / 1.1)));
+          return i === 0 ? String(rows) : "s".repeat(len);
+        }).join(",") + "\n"
+      );
+    },
+  };
+
+  const gen = generators[variant];
+  if (!gen) {
+    fs.closeSync(fd);
+    throw new Error(`Unknown pathological variant: ${variant}`);
+  }
+
+  while (bytes + buf.length < targetBytes) {
+    buf += gen();
+    rows++;
+    if (buf.length >= bufSize) flush();
+  }
+  flush();
+  fs.closeSync(fd);
+  return { path: filePath, bytes, rows };
+}
+
+function generateAllPathological(): Record<string, Record<string, GenerateResult>> {
+  const sizes = config.getActiveSizes();
+  const results: Record<string, Record<string, GenerateResult>> = {};
+  for (const [sizeName, targetBytes] of Object.entries(sizes) as [string, number][]) {
+    results[sizeName] = {};
+    for (const variant of config.PATHOLOGICAL_VARIANTS) {
+      const name = `csv_${sizeName}_${variant}.csv`;
+      const filePath = path.join(config.DATA_DIR, name);
+      console.log(`Generating ${name} (target ${(targetBytes / 1024 / 1024).toFixed(1)} MB)...`);
+      const result = generatePathologicalCsv(filePath, targetBytes, variant);
+      results[sizeName][variant] = result;
+      console.log(`  -> ${(result.bytes / 1024 / 1024).toFixed(2)} MB, ${result.rows} rows`);
+    }
+  }
+  return results;
+}
+
+if (require.main === module) {
+  generateAllPathological();
+}
+
+module.exports = { generatePathologicalCsv, generateAllPathological };
@@ -0,0 +1,110 @@
+"use strict";
+
+const fs = require("fs");
+
+/** Resident memory split by backing (bytes). File-backed includes mmap'd input pages. */
+interface MemoryReading {
+  rss: number;
+  rssAnon: number | null;
+  rssFile: number | null;
+  rssShmem: number | null;
+  /** Resident and shared pages from /proc/self/statm, in bytes. */
+  statmResident: number | null;
+  statmShared: number | null;
+}
+
+interface MemorySample extends MemoryReading {
+  tMs: number;
+  /** Fraction of the input consumed so far (0..1). */
+  progress: number;
+  heapUsed: number;
+  /** Arena bytes held by live parsers (metrics().arena.bytes_in_use). */
+  arenaInUse: number;
+  minorFaults: number;
+  majorFaults: number;
+}
+
+const PAGE_SIZE = 4096;
+
+function statusKb(status: string, key: string): number | null {
+  const m = status.match(new RegExp(`^${key}:\\s+(\\d+) kB`, "m"));
+  return m ? parseInt(m[1], 10) * 1024 : null;
+}
+
+/** Current RSS; the anon/file/shmem split and statm fields are null off Linux. */
+function readMemory(): MemoryReading {
+  let status = "";
+  let statm: number[] = [];
+  try {
+    status = fs.readFileSync("/proc/self/status", "utf8");
+    statm = fs.readFileSync("/proc/self/statm", "utf8").trim().split(/\s+/).map(Number);
+  } catch {
+    // Not Linux: fall through to process.memoryUsage().
+  }
+  return {
+    rss: statusKb(status, "VmRSS") ?? process.memoryUsage().rss,
+    rssAnon: statusKb(status, "RssAnon"),
+    rssFile: statusKb(status, "RssFile"),
+    rssShmem: statusKb(status, "RssShmem"),
+    statmResident: statm.length > 1 ? statm[1] * PAGE_SIZE : null,
+    statmShared: statm.length > 2 ? statm[2] * PAGE_SIZE : null,
+  };
+}
+
+/**
+ * Samples memory, page faults and arena usage on a timer until stop(). progress() and
+ * arenaInUse() are polled with each sample.
+ */
+function startMemorySampler(
+  intervalMs: number,
+  progress: () => number,
+  arenaInUse: () => number
+): { sample: () => void; stop: () => MemorySample[] } {
+  const samples: MemorySample[] = [];
+  const t0 = process.hrtime.bigint();
+  const sample = (): void => {
+    const usage = process.resourceUsage();
+    samples.push({
+      ...readMemory(),
+      tMs: Number(process.hrtime.bigint() - t0) / 1e6,
+      progress: progress(),
+      heapUsed: process.memoryUsage().heapUsed,
+      arenaInUse: arenaInUse(),
+      minorFaults: usage.minorPageFault,
+      majorFaults: usage.majorPageFault,
+    });
+  };
+  sample();
+  const timer = setInterval(sample, intervalMs);
+  return {
+    sample,
+    stop: () => {
+      clearInterval(timer);
+      sample();
+      return samples;
+    },
+  };
+}
+
+/**
+ * Reduces a timeline to `points` evenly spaced progress steps (0..1). Each step holds the
+ * highest value sampled since the previous step, or repeats the previous step if none was.
+ */
+function timelineByProgress(samples: MemorySample[], points: number, value: (s: MemorySample) => number): number[] {
+  const out: number[] = [];
+  let i = 0;
+  let last = samples.length ? value(samples[0]) : 0;
+  for (let p = 0; p < points; p++) {
+    const upTo = points > 1 ? p / (points - 1) : 1;
+    let high = -1;
+    while (i < samples.length && samples[i].progress <= upTo) {
+      high = Math.max(high, value(samples[i]));
+      i++;
+    }
+    if (high >= 0) last = high;
+    out.push(last);
+  }
+  return out;
+}
+
+module.exports = { readMemory, startMemorySampler, timelineByProgress };
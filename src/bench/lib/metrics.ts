@@ -6,19 +6,75 @@ const config = require("../config");
 interface MeasureResult {
   elapsedNs: number;
   elapsedMs: number;
+  /** From the start of the run to the first batch (or row), when the runner marked it. */
+  timeToFirstBatchMs: number | null;
   peakRss: number;
   cpuUserUs: number;
   cpuSystemUs: number;
   eventLoop: { min: number; max: number; mean: number; stddev: number; p50: number; p95: number; count: number };
   rowCount: number;
   bytesProcessed: number;
+  hw: HwSummary | null;
+  arena: ArenaSummary | null;
+}
+
+/** Per-stage hardware counters of one ultratab run (parser metrics with perfCounters). */
+interface HwStageSummary {
+  cycles: number;
+  instructions: number | null;
+  cyclesPerByte: number;
+  ipc: number | null;
+  branchMisses: number | null;
+  llcMisses: number | null;
+}
+
+type HwSummary = Record<"read" | "tokenize" | "build", HwStageSummary>;
+
+/** Hardware counter summary from getParserMetrics output; null when counters were unavailable. */
+function hwSummary(metrics: Record<string, number> | null, bytes: number): HwSummary | null {
+  if (!metrics || !metrics.hw_counters) return null;
+  const stage = (name: string): HwStageSummary => {
+    const get = (event: string): number | null => metrics[`hw_${name}_${event}`] ?? null;
+    const cycles = get("cycles") ?? 0;
+    const instructions = get("instructions");
+    return {
+      cycles,
+      instructions,
+      cyclesPerByte: bytes > 0 ? cycles / bytes : 0,
+      ipc: instructions !== null && cycles > 0 ? instructions / cycles : null,
+      branchMisses: get("branch_misses"),
+      llcMisses: get("llc_misses"),
+    };
+  };
+  return { read: stage("read"), tokenize: stage("tokenize"), build: stage("build") };
+}
+
+/** Arena high-water of one ultratab run. */
+interface ArenaSummary {
+  peakArenaUsage: number;
+  arenaBlocks: number;
+  arenaBytesAllocated: number;
+}
+
+/** Arena figures from getParserMetrics output; null for parsers that do not report them. */
+function arenaSummary(metrics: Record<string, number> | null): ArenaSummary | null {
+  if (!metrics || metrics.peak_arena_usage === undefined) return null;
+  return {
+    peakArenaUsage: metrics.peak_arena_usage,
+    arenaBlocks: metrics.arena_blocks ?? 0,
+    arenaBytesAllocated: metrics.arena_bytes_allocated ?? 0,
+  };
 }
 
 interface MeasureOptions {
   sampleRssIntervalMs?: number;
 }
 
-async function measureRun(fn: () => Promise<{ rowCount?: number; rows?: number; bytesProcessed?: number }>, options: MeasureOptions = {}): Promise<MeasureResult> {
+/**
+ * Times one run of fn. fn receives markFirstBatch and calls it as each batch (or row) arrives;
+ * the first call sets timeToFirstBatchMs.
+ */
+async function measureRun(fn: (markFirstBatch: () => void) => Promise<{ rowCount?: number; rows?: number; bytesProcessed?: number; hw?: HwSummary | null; arena?: ArenaSummary | null }>, options: MeasureOptions = {}): Promise<MeasureResult> {
   const rssSamples: number[] = [];
   let rssInterval: ReturnType<typeof setInterval> | undefined;
 
@@ -35,8 +91,13 @@ async function measureRun(fn: () => Promise<{ rowCount?: number; rows?: number;
     }, sampleRssIntervalMs);
   }
 
+  let firstBatchAt = 0n;
+  const markFirstBatch = (): void => {
+    if (firstBatchAt === 0n) firstBatchAt = process.hrtime.bigint();
+  };
+
   const start = process.hrtime.bigint();
-  const result = await fn();
+  const result = await fn(markFirstBatch);
   const end = process.hrtime.bigint();
 
   if (rssInterval) clearInterval(rssInterval);
@@ -53,6 +114,7 @@ async function measureRun(fn: () => Promise<{ rowCount?: number; rows?: number;
   return {
     elapsedNs,
     elapsedMs,
+    timeToFirstBatchMs: firstBatchAt === 0n ? null : Number(firstBatchAt - start) / 1e6,
     peakRss,
     cpuUserUs: cpuAfter.user,
     cpuSystemUs: cpuAfter.system,
@@ -67,6 +129,8 @@ async function measureRun(fn: () => Promise<{ rowCount?: number; rows?: number;
     },
     rowCount: result?.rowCount ?? result?.rows ?? 0,
     bytesProcessed: result?.bytesProcessed ?? 0,
+    hw: result?.hw ?? null,
+    arena: result?.arena ?? null,
   };
 }
 
@@ -84,18 +148,35 @@ function p95(arr: number[]): number {
   return s[Math.max(0, i)];
 }
 
+/** Small seeded PRNG (mulberry32) for reproducible datasets and resampling. */
+function seededRandom(seed: number): () => number {
+  let a = seed >>> 0;
+  return () => {
+    a = (a + 0x6d2b79f5) >>> 0;
+    let t = a;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
 interface RunSummary {
   medianMs: number;
   p95Ms: number;
   medianPeakRss: number;
   p95PeakRss: number;
+  medianTimeToFirstBatchMs: number | null;
   medianEventLoopMax: number;
   p95EventLoopP95: number;
   cpuUserUs: number;
   cpuSystemUs: number;
   rowCount: number;
   bytesProcessed: number;
+  hw: HwSummary | null;
+  arena: ArenaSummary | null;
   runs: number;
+  /** Per-iteration values, kept so bench --compare can put confidence intervals on deltas. */
+  samples: { elapsedMs: number[]; peakRss: number[]; timeToFirstBatchMs: number[] | null };
 }
 
 function summarizeRuns(runs: MeasureResult[]): RunSummary {
@@ -106,19 +187,25 @@ function summarizeRuns(runs: MeasureResult[]): RunSummary {
 
   const elMax = runs.map((r) => r.eventLoop.max);
   const elP95 = runs.map((r) => r.eventLoop.p95);
+  const ttfb = runs.map((r) => r.timeToFirstBatchMs).filter((v): v is number => v !== null);
+  const allTtfb = ttfb.length === runs.length && ttfb.length > 0;
 
   return {
     medianMs: median(elapsedMs),
     p95Ms: p95(elapsedMs),
     medianPeakRss: median(peakRss),
     p95PeakRss: p95(peakRss),
+    medianTimeToFirstBatchMs: allTtfb ? median(ttfb) : null,
     medianEventLoopMax: median(elMax),
     p95EventLoopP95: p95(elP95),
     cpuUserUs: runs.reduce((s, r) => s + r.cpuUserUs, 0) / runs.length,
     cpuSystemUs: runs.reduce((s, r) => s + r.cpuSystemUs, 0) / runs.length,
     rowCount,
     bytesProcessed,
+    hw: runs[runs.length - 1]?.hw ?? null,
+    arena: runs[runs.length - 1]?.arena ?? null,
     runs: runs.length,
+    samples: { elapsedMs, peakRss, timeToFirstBatchMs: allTtfb ? ttfb : null },
   };
 }
 
@@ -127,4 +214,7 @@ module.exports = {
   median,
   p95,
   summarizeRuns,
+  hwSummary,
+  arenaSummary,
+  seededRandom,
 };
@@ -13,18 +13,20 @@ interface RunBenchmarkOptions {
 interface BenchmarkResult {
   rowCount: number;
   bytesProcessed: number;
+  hw?: Record<string, unknown> | null;
+  arena?: Record<string, number> | null;
 }
 
 async function runBenchmark(
   name: string,
-  fn: () => Promise<BenchmarkResult>,
+  fn: (markFirstBatch: () => void) => Promise<BenchmarkResult>,
   options: RunBenchmarkOptions = {}
 ): Promise<Record<string, unknown>> {
   const warmup = options.warmup ?? config.WARMUP_RUNS;
   const iterations = options.iterations ?? config.ITERATIONS;
 
   for (let i = 0; i < warmup; i++) {
-    await fn();
+    await fn(() => {});
   }
 
   const runs = [];
@@ -7,8 +7,11 @@ interface BenchResult {
   p95Ms?: number;
   medianPeakRss?: number;
   p95EventLoopP95?: number;
+  medianTimeToFirstBatchMs?: number | null;
   rowCount?: number;
   streaming?: boolean | null;
+  hw?: Record<string, { cyclesPerByte: number; ipc: number | null; branchMisses: number | null; llcMisses: number | null }> | null;
+  arena?: { peakArenaUsage: number; arenaBlocks: number; arenaBytesAllocated: number } | null;
 }
 
 function formatResult(r: BenchResult, bytes: number): Record<string, string | number> {
@@ -24,11 +27,36 @@ function formatResult(r: BenchResult, bytes: number): Record<string, string | nu
     name: r.name,
     "median (ms)": (r.medianMs ?? 0).toFixed(1),
     "p95 (ms)": (r.p95Ms ?? 0).toFixed(1),
+    "first batch (ms)": r.medianTimeToFirstBatchMs != null ? r.medianTimeToFirstBatchMs.toFixed(1) : "-",
     "MB/s": mbPerSec.toFixed(2),
     "rows/s": Math.round(rowsPerSec).toLocaleString(),
     "peak RSS (MB)": rssMb.toFixed(2),
     "event loop p95 (ms)": elP95Ms.toFixed(2),
     streaming: r.streaming === true ? "yes" : r.streaming === false ? "no" : "-",
+    ...formatHw(r),
+    ...formatArena(r),
+  };
+}
+
+/** Tokenize/build cycles per byte and IPC when the run reported hardware counters. */
+function formatHw(r: BenchResult): Record<string, string> {
+  if (!r.hw) return {};
+  const out: Record<string, string> = {};
+  for (const stage of ["tokenize", "build"]) {
+    const s = r.hw[stage];
+    if (!s) continue;
+    out[`${stage} cyc/B`] = s.cyclesPerByte.toFixed(2);
+    out[`${stage} IPC`] = s.ipc !== null ? s.ipc.toFixed(2) : "-";
+  }
+  return out;
+}
+
+/** Parser arena high-water for ultratab runs. */
+function formatArena(r: BenchResult): Record<string, string | number> {
+  if (!r.arena) return {};
+  return {
+    "peak arena (MB)": (r.arena.peakArenaUsage / (1024 * 1024)).toFixed(2),
+    "arena blocks": r.arena.arenaBlocks,
   };
 }
 
@@ -50,10 +78,171 @@ function printXlsxBlock(title: string, bytes: number, results: BenchResult[]): v
   console.table(rows);
 }
 
+interface ConcurrencyResult {
+  name: string;
+  error?: string;
+  concurrency?: number;
+  medianMs?: number;
+  aggregateMBps?: number;
+  perParserMBps?: number;
+  eventLoop?: { p50: number; p90: number; p99: number; max: number };
+  threadpoolProbe?: { p50: number; p99: number; max: number };
+  http?: { p50: number; p99: number } | null;
+}
+
+interface ConcurrencyBlock {
+  kind: string;
+  size: string;
+  variant: string | null;
+  bytes: number;
+  threadpoolSize: number;
+  results: ConcurrencyResult[];
+}
+
+/** Aggregate throughput, event-loop delay and pool/HTTP probe latency per level and mode. */
+function formatConcurrencyResult(r: ConcurrencyResult): Record<string, string | number> {
+  if (r.error) {
+    return { name: r.name, note: `Error: ${r.error}` };
+  }
+  const el = r.eventLoop ?? { p50: 0, p90: 0, p99: 0, max: 0 };
+  const pool = r.threadpoolProbe ?? { p50: 0, p99: 0, max: 0 };
+  const row: Record<string, string | number> = {
+    name: r.name,
+    "median (ms)": (r.medianMs ?? 0).toFixed(1),
+    "aggregate MB/s": (r.aggregateMBps ?? 0).toFixed(2),
+    "per-parser MB/s": (r.perParserMBps ?? 0).toFixed(2),
+    "loop p50 (ms)": (el.p50 / 1e6).toFixed(2),
+    "loop p99 (ms)": (el.p99 / 1e6).toFixed(2),
+    "loop max (ms)": (el.max / 1e6).toFixed(2),
+    "pool probe p99 (ms)": pool.p99.toFixed(2),
+  };
+  if (r.http) row["http p99 (ms)"] = r.http.p99.toFixed(2);
+  return row;
+}
+
+function printConcurrencyBlock(block: ConcurrencyBlock): void {
+  console.log("\n" + "=".repeat(60));
+  console.log(`Concurrency: ${block.kind} ${block.size}${block.variant ? ` / ${block.variant}` : ""}`);
+  console.log(`Dataset: ${(block.bytes / 1024 / 1024).toFixed(2)} MB per parser, libuv pool: ${block.threadpoolSize} threads`);
+  console.log("=".repeat(60));
+  console.table(block.results.map(formatConcurrencyResult));
+}
+
+interface MemoryResult {
+  name: string;
+  error?: string;
+  elapsedMs?: number;
+  peak?: { rss: number | null; rssAnon: number | null; rssFile: number | null; arenaInUse: number | null };
+  baseline?: { rss: number };
+  pageFaults?: { minor: number; major: number };
+  arena?: { peakArenaUsage: number | null; arenaBlocks: number | null };
+}
+
+interface MemoryBlock {
+  size: string;
+  variant: string;
+  bytes: number;
+  results: MemoryResult[];
+}
+
+function mbOrDash(v: number | null | undefined): string {
+  return v === null || v === undefined ? "-" : (v / (1024 * 1024)).toFixed(1);
+}
+
+/** Peak RSS split into anonymous and file-backed pages, page faults and arena high-water. */
+function formatMemoryResult(r: MemoryResult): Record<string, string | number> {
+  if (r.error) {
+    return { name: r.name, note: `Error: ${r.error}` };
+  }
+  return {
+    name: r.name,
+    "time (ms)": (r.elapsedMs ?? 0).toFixed(1),
+    "peak RSS (MB)": mbOrDash(r.peak?.rss),
+    "RSS growth (MB)": mbOrDash((r.peak?.rss ?? 0) - (r.baseline?.rss ?? 0)),
+    "peak anon (MB)": mbOrDash(r.peak?.rssAnon),
+    "peak file (MB)": mbOrDash(r.peak?.rssFile),
+    "minor faults": (r.pageFaults?.minor ?? 0).toLocaleString(),
+    "major faults": (r.pageFaults?.major ?? 0).toLocaleString(),
+    "peak arena (MB)": mbOrDash(r.arena?.peakArenaUsage),
+    "arena blocks": r.arena?.arenaBlocks ?? "-",
+  };
+}
+
+function printMemoryBlock(block: MemoryBlock): void {
+  console.log("\n" + "=".repeat(60));
+  console.log(`Memory: CSV ${block.size} / ${block.variant}`);
+  console.log(`Dataset: ${(block.bytes / 1024 / 1024).toFixed(2)} MB`);
+  console.log("=".repeat(60));
+  console.table(block.results.map(formatMemoryResult));
+}
+
+interface ComparisonRow {
+  section: string;
+  size: string;
+  variant: string;
+  name: string;
+  metric: string;
+  unit: string;
+  baseline: number | null;
+  current: number | null;
+  delta: number | null;
+  ciLow: number | null;
+  ciHigh: number | null;
+  verdict: string;
+}
+
+interface Comparison {
+  baselinePath: string | null;
+  baselineTimestamp: string;
+  confidence: number;
+  rows: ComparisonRow[];
+  regressions: number;
+  improvements: number;
+  warnings: string[];
+}
+
+function pct(v: number): string {
+  return `${v >= 0 ? "+" : ""}${(v * 100).toFixed(1)}%`;
+}
+
+/** "+3.2% [+1.0%, +5.1%]": change of the median and its confidence interval, when known. */
+function formatDelta(r: ComparisonRow): string {
+  if (r.delta === null) return "-";
+  return r.ciLow !== null && r.ciHigh !== null ? `${pct(r.delta)} [${pct(r.ciLow)}, ${pct(r.ciHigh)}]` : pct(r.delta);
+}
+
+/** Rows that changed (or appeared or vanished) against the baseline, then a one-line verdict. */
+function printComparison(c: Comparison): void {
+  console.log("\n" + "=".repeat(60));
+  console.log(`Compared with ${c.baselinePath ?? "baseline"} (${c.baselineTimestamp})`);
+  console.log("=".repeat(60));
+  for (const w of c.warnings) console.log(`warning: ${w}`);
+  const changed = c.rows.filter((r) => r.verdict !== "unchanged");
+  if (changed.length) {
+    console.table(
+      changed.map((r) => ({
+        dataset: `${r.section} ${r.size}${r.variant ? ` / ${r.variant}` : ""}`,
+        parser: r.name,
+        metric: r.unit ? `${r.metric} (${r.unit})` : r.metric,
+        baseline: r.baseline !== null ? r.baseline.toFixed(2) : "-",
+        current: r.current !== null ? r.current.toFixed(2) : "-",
+        [`delta [${Math.round(c.confidence * 100)}% CI]`]: formatDelta(r),
+        verdict: r.verdict,
+      }))
+    );
+  }
+  const unchanged = c.rows.length - changed.length;
+  console.log(`${c.regressions} regression(s), ${c.improvements} improvement(s), ${unchanged} unchanged.`);
+}
+
 interface Report {
   timestamp: string;
-  csv?: { size: string; variant: string; bytes: number; results: BenchResult[] }[];
-  xlsx?: { size: string; bytes: number; results: BenchResult[] }[];
+  csv?: { size: string; variant: string; bytes: number; results: BenchResult[] }[] | null;
+  xlsx?: { size: string; bytes: number; results: BenchResult[] }[] | null;
+  concurrency?: ConcurrencyBlock[];
+  memory?: MemoryBlock[];
+  pathological?: { size: string; variant: string; bytes: number; results: BenchResult[] }[];
+  comparison?: Comparison;
 }
 
 function printReport(report: Report): void {
@@ -75,6 +264,28 @@ function printReport(report: Report): void {
       printXlsxBlock(`XLSX ${block.size}`, block.bytes, block.results);
     }
   }
+
+  if (report.pathological) {
+    for (const block of report.pathological) {
+      printCsvBlock(`Pathological CSV ${block.size} / ${block.variant}`, block.bytes, block.results);
+    }
+  }
+
+  if (report.concurrency) {
+    for (const block of report.concurrency) {
+      printConcurrencyBlock(block);
+    }
+  }
+
+  if (report.memory) {
+    for (const block of report.memory) {
+      printMemoryBlock(block);
+    }
+  }
+
+  if (report.comparison) {
+    printComparison(report.comparison);
+  }
 }
 
-module.exports = { formatResult, printCsvBlock, printXlsxBlock, printReport };
+module.exports = { formatResult, formatConcurrencyResult, formatMemoryResult, printCsvBlock, printXlsxBlock, printConcurrencyBlock, printMemoryBlock, printComparison, printReport };
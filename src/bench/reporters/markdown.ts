@@ -11,41 +11,249 @@ interface BenchResult {
   p95Ms?: number;
   rowCount?: number;
   medianPeakRss?: number;
+  medianTimeToFirstBatchMs?: number | null;
   p95EventLoopP95?: number;
   streaming?: boolean | null;
+  hw?: Record<string, { cyclesPerByte: number; ipc: number | null; branchMisses: number | null; llcMisses: number | null }> | null;
+  arena?: { peakArenaUsage: number; arenaBlocks: number; arenaBytesAllocated: number } | null;
 }
 
 function formatResultRow(r: BenchResult, bytes: number): string {
   if (r.error) {
-    return `| ${r.name} | - | - | - | - | - | - | ${r.error} |`;
+    return `| ${r.name} | - | - | - | - | - | - | - | ${r.error} |`;
   }
   const mb = bytes / (1024 * 1024);
   const mbPerSec = ((mb / ((r.medianMs ?? 0) / 1000))).toFixed(2);
   const rowsPerSec = Math.round((r.rowCount ?? 0) / ((r.medianMs ?? 0) / 1000)).toLocaleString();
   const rssMb = (((r.medianPeakRss ?? 0) / (1024 * 1024))).toFixed(2);
   const elP95Ms = (((r.p95EventLoopP95 ?? 0) / 1e6)).toFixed(2);
+  const ttfb = r.medianTimeToFirstBatchMs != null ? r.medianTimeToFirstBatchMs.toFixed(1) : "-";
   const stream = r.streaming === true ? "yes" : r.streaming === false ? "no" : "-";
-  return `| ${r.name} | ${(r.medianMs ?? 0).toFixed(1)} | ${(r.p95Ms ?? 0).toFixed(1)} | ${mbPerSec} | ${rowsPerSec} | ${rssMb} | ${elP95Ms} | ${stream} |`;
+  return `| ${r.name} | ${(r.medianMs ?? 0).toFixed(1)} | ${(r.p95Ms ?? 0).toFixed(1)} | ${ttfb} | ${mbPerSec} | ${rowsPerSec} | ${rssMb} | ${elP95Ms} | ${stream} |`;
 }
 
 function sectionCsv(size: string, variant: string, bytes: number, results: BenchResult[]): string {
-  const header = "| Parser | Median (ms) | P95 (ms) | MB/s | rows/s | Peak RSS (MB) | Event loop p95 (ms) | Streaming |";
-  const sep = "| --- | --- | --- | --- | --- | --- | --- | --- |";
+  const header = "| Parser | Median (ms) | P95 (ms) | First batch (ms) | MB/s | rows/s | Peak RSS (MB) | Event loop p95 (ms) | Streaming |";
+  const sep = "| --- | --- | --- | --- | --- | --- | --- | --- | --- |";
   const rows = results.map((r) => formatResultRow(r, bytes)).join("\n");
-  return `### CSV – ${size} / ${variant}\n\nDataset: ${(bytes / 1024 / 1024).toFixed(2)} MB\n\n${header}\n${sep}\n${rows}\n`;
+  return `### CSV – ${size} / ${variant}\n\nDataset: ${(bytes / 1024 / 1024).toFixed(2)} MB\n\n${header}\n${sep}\n${rows}\n${sectionHw(results)}${sectionArena(results)}`;
+}
+
+function fmtCount(v: number | null | undefined): string {
+  return v === null || v === undefined ? "-" : Math.round(v).toLocaleString();
+}
+
+/** Per-stage hardware counters for the results that reported them (Linux, perf_event_open). */
+function sectionHw(results: BenchResult[]): string {
+  const withHw = results.filter((r) => !r.error && r.hw);
+  if (!withHw.length) return "";
+  const header = "| Parser | Stage | cycles/byte | IPC | branch misses | LLC misses |";
+  const sep = "| --- | --- | --- | --- | --- | --- |";
+  const rows: string[] = [];
+  for (const r of withHw) {
+    for (const stage of ["tokenize", "build"]) {
+      const s = r.hw![stage];
+      if (!s) continue;
+      const ipc = s.ipc !== null ? s.ipc.toFixed(2) : "-";
+      rows.push(`| ${r.name} | ${stage} | ${s.cyclesPerByte.toFixed(2)} | ${ipc} | ${fmtCount(s.branchMisses)} | ${fmtCount(s.llcMisses)} |`);
+    }
+  }
+  return `\nHardware counters (last run):\n\n${header}\n${sep}\n${rows.join("\n")}\n`;
+}
+
+/** Arena high-water of the ultratab results (last run). */
+function sectionArena(results: BenchResult[]): string {
+  const withArena = results.filter((r) => !r.error && r.arena);
+  if (!withArena.length) return "";
+  const header = "| Parser | Peak arena (MB) | Arena blocks | Arena bytes allocated (MB) |";
+  const sep = "| --- | --- | --- | --- |";
+  const mb = (v: number): string => (v / (1024 * 1024)).toFixed(2);
+  const rows = withArena.map((r) => `| ${r.name} | ${mb(r.arena!.peakArenaUsage)} | ${fmtCount(r.arena!.arenaBlocks)} | ${mb(r.arena!.arenaBytesAllocated)} |`);
+  return `\nArena (last run):\n\n${header}\n${sep}\n${rows.join("\n")}\n`;
 }
 
 function sectionXlsx(size: string, bytes: number, results: BenchResult[]): string {
-  const header = "| Parser | Median (ms) | P95 (ms) | MB/s | rows/s | Peak RSS (MB) | Event loop p95 (ms) | Streaming |";
-  const sep = "| --- | --- | --- | --- | --- | --- | --- | --- |";
+  const header = "| Parser | Median (ms) | P95 (ms) | First batch (ms) | MB/s | rows/s | Peak RSS (MB) | Event loop p95 (ms) | Streaming |";
+  const sep = "| --- | --- | --- | --- | --- | --- | --- | --- | --- |";
   const rows = results.map((r) => formatResultRow(r, bytes)).join("\n");
   return `### XLSX – ${size}\n\nDataset: ${(bytes / 1024 / 1024).toFixed(2)} MB\n\n${header}\n${sep}\n${rows}\n`;
 }
 
+interface ConcurrencyResult {
+  name: string;
+  error?: string;
+  medianMs?: number;
+  aggregateMBps?: number;
+  perParserMBps?: number;
+  eventLoop?: { p50: number; p90: number; p99: number; max: number };
+  threadpoolProbe?: { p50: number; p99: number; max: number };
+  http?: { p50: number; p99: number } | null;
+}
+
+interface ConcurrencyBlock {
+  kind: string;
+  size: string;
+  variant: string | null;
+  bytes: number;
+  threadpoolSize: number;
+  results: ConcurrencyResult[];
+}
+
+function formatConcurrencyRow(r: ConcurrencyResult): string {
+  if (r.error) {
+    return `| ${r.name} | - | - | - | - | - | - | - | - | ${r.error} |`;
+  }
+  const el = r.eventLoop ?? { p50: 0, p90: 0, p99: 0, max: 0 };
+  const pool = r.threadpoolProbe ?? { p50: 0, p99: 0, max: 0 };
+  const ms = (ns: number): string => (ns / 1e6).toFixed(2);
+  const httpP99 = r.http ? r.http.p99.toFixed(2) : "-";
+  return `| ${r.name} | ${(r.medianMs ?? 0).toFixed(1)} | ${(r.aggregateMBps ?? 0).toFixed(2)} | ${(r.perParserMBps ?? 0).toFixed(2)} | ${ms(el.p50)} | ${ms(el.p99)} | ${ms(el.max)} | ${pool.p50.toFixed(2)} | ${pool.p99.toFixed(2)} | ${httpP99} |`;
+}
+
+/** N parsers at once: aggregate throughput next to event-loop delay and libuv pool probe latency. */
+function sectionConcurrency(block: ConcurrencyBlock): string {
+  const header = "| Run | Median (ms) | Aggregate MB/s | Per-parser MB/s | Loop p50 (ms) | Loop p99 (ms) | Loop max (ms) | Pool probe p50 (ms) | Pool probe p99 (ms) | HTTP p99 (ms) |";
+  const sep = "| --- | --- | --- | --- | --- | --- | --- | --- | --- | --- |";
+  const rows = block.results.map(formatConcurrencyRow).join("\n");
+  const dataset = `${block.size}${block.variant ? ` / ${block.variant}` : ""}`;
+  return `### ${block.kind} – ${dataset}\n\nDataset: ${(block.bytes / 1024 / 1024).toFixed(2)} MB per parser; libuv pool: ${block.threadpoolSize} threads\n\n${header}\n${sep}\n${rows}\n`;
+}
+
+interface MemoryResult {
+  name: string;
+  error?: string;
+  api?: string;
+  mode?: string;
+  elapsedMs?: number;
+  peak?: { rss: number | null; rssAnon: number | null; rssFile: number | null; arenaInUse: number | null };
+  baseline?: { rss: number };
+  pageFaults?: { minor: number; major: number };
+  arena?: { peakArenaUsage: number | null; arenaBlocks: number | null };
+  timeline?: { points: number; rss: number[] };
+}
+
+interface MemoryBlock {
+  size: string;
+  variant: string;
+  bytes: number;
+  results: MemoryResult[];
+}
+
+function mbOrDash(v: number | null | undefined): string {
+  return v === null || v === undefined ? "-" : (v / (1024 * 1024)).toFixed(1);
+}
+
+function formatMemoryRow(r: MemoryResult): string {
+  if (r.error) {
+    return `| ${r.name} | - | - | - | - | - | - | - | - | ${r.error} |`;
+  }
+  const growth = (r.peak?.rss ?? 0) - (r.baseline?.rss ?? 0);
+  return `| ${r.name} | ${(r.elapsedMs ?? 0).toFixed(1)} | ${mbOrDash(r.peak?.rss)} | ${mbOrDash(growth)} | ${mbOrDash(r.peak?.rssAnon)} | ${mbOrDash(r.peak?.rssFile)} | ${fmtCount(r.pageFaults?.minor)} | ${fmtCount(r.pageFaults?.major)} | ${mbOrDash(r.arena?.peakArenaUsage)} | ${fmtCount(r.arena?.arenaBlocks)} |`;
+}
+
+/**
+ * Text chart of RSS (MB) against input progress, one mark per series; "*" where series
+ * overlap. Renders in any Markdown viewer.
+ */
+function rssChart(series: { mark: string; label: string; values: number[] }[], height = 10): string {
+  const all = series.flatMap((s) => s.values).map((v) => v / (1024 * 1024));
+  if (!all.length) return "";
+  const lo = Math.min(...all);
+  const hi = Math.max(...all);
+  const span = hi - lo || 1;
+  const cols = Math.max(...series.map((s) => s.values.length));
+  const grid: string[][] = Array.from({ length: height }, () => Array(cols).fill(" "));
+  for (const s of series) {
+    s.values.forEach((v, x) => {
+      const y = height - 1 - Math.round(((v / (1024 * 1024) - lo) / span) * (height - 1));
+      grid[y][x] = grid[y][x] === " " || grid[y][x] === s.mark ? s.mark : "*";
+    });
+  }
+  const lines = grid.map((row, y) => {
+    const mb = hi - (span * y) / (height - 1);
+    return `${mb.toFixed(1).padStart(8)} | ${row.join("  ")}`.trimEnd();
+  });
+  const width = (cols - 1) * 3 + 1;
+  lines.push(`${" ".repeat(8)} +-${"-".repeat(width)}`);
+  lines.push(`${" ".repeat(10)}0%${" ".repeat(Math.max(1, width - 6))}100%`);
+  lines.push(`${" ".repeat(10)}${series.map((s) => `${s.mark} = ${s.label}`).join(", ")}; RSS (MB) vs input consumed`);
+  return "```\n" + lines.join("\n") + "\n```\n";
+}
+
+/** Peak memory table, then an RSS-vs-progress chart per API comparing buffered and mmap reads. */
+function sectionMemory(block: MemoryBlock): string {
+  const header = "| Run | Time (ms) | Peak RSS (MB) | RSS growth (MB) | Peak anon (MB) | Peak file-backed (MB) | Minor faults | Major faults | Peak arena (MB) | Arena blocks |";
+  const sep = "| --- | --- | --- | --- | --- | --- | --- | --- | --- | --- |";
+  const rows = block.results.map(formatMemoryRow).join("\n");
+  const charts: string[] = [];
+  const apis = [...new Set(block.results.filter((r) => !r.error && r.timeline).map((r) => r.api as string))];
+  for (const api of apis) {
+    const runs = block.results.filter((r) => !r.error && r.api === api && r.timeline);
+    const series = runs.map((r) => ({ mark: r.mode === "mmap" ? "m" : "b", label: r.mode ?? "", values: r.timeline!.rss }));
+    charts.push(`RSS over the run, ${api}:\n\n${rssChart(series)}`);
+  }
+  return `### CSV – ${block.size} / ${block.variant}\n\nDataset: ${(block.bytes / 1024 / 1024).toFixed(2)} MB\n\n${header}\n${sep}\n${rows}\n\n${charts.join("\n")}`;
+}
+
+interface ComparisonRow {
+  section: string;
+  size: string;
+  variant: string;
+  name: string;
+  metric: string;
+  unit: string;
+  baseline: number | null;
+  current: number | null;
+  delta: number | null;
+  ciLow: number | null;
+  ciHigh: number | null;
+  verdict: string;
+}
+
+interface Comparison {
+  baselinePath: string | null;
+  baselineTimestamp: string;
+  confidence: number;
+  rows: ComparisonRow[];
+  regressions: number;
+  improvements: number;
+  warnings: string[];
+}
+
+function pct(v: number): string {
+  return `${v >= 0 ? "+" : ""}${(v * 100).toFixed(1)}%`;
+}
+
+/** "+3.2% [+1.0%, +5.1%]": change of the median and its confidence interval, when known. */
+function formatDelta(r: ComparisonRow): string {
+  if (r.delta === null) return "-";
+  return r.ciLow !== null && r.ciHigh !== null ? `${pct(r.delta)} [${pct(r.ciLow)}, ${pct(r.ciHigh)}]` : pct(r.delta);
+}
+
+/** Every compared metric; regressions in bold so they stand out in a long table. */
+function sectionComparison(c: Comparison): string {
+  const ci = Math.round(c.confidence * 100);
+  const header = `| Dataset | Parser | Metric | Baseline | Current | Delta [${ci}% CI] | Verdict |`;
+  const sep = "| --- | --- | --- | --- | --- | --- | --- |";
+  const num = (v: number | null): string => (v !== null ? v.toFixed(2) : "-");
+  const rows = c.rows.map((r) => {
+    const verdict = r.verdict === "regression" ? "**regression**" : r.verdict;
+    const metric = r.unit ? `${r.metric} (${r.unit})` : r.metric;
+    return `| ${r.section} ${r.size}${r.variant ? ` / ${r.variant}` : ""} | ${r.name} | ${metric} | ${num(r.baseline)} | ${num(r.current)} | ${formatDelta(r)} | ${verdict} |`;
+  });
+  const warnings = c.warnings.map((w) => `> ${w}\n`).join("");
+  const summary = `${c.regressions} regression(s), ${c.improvements} improvement(s) against \`${c.baselinePath ?? "baseline"}\` (${c.baselineTimestamp}).`;
+  return `${summary}\n\n${warnings ? warnings + "\n" : ""}${header}\n${sep}\n${rows.join("\n")}\n`;
+}
+
 interface Report {
   timestamp: string;
-  csv?: { size: string; variant: string; bytes: number; results: BenchResult[] }[];
-  xlsx?: { size: string; bytes: number; results: BenchResult[] }[];
+  csv?: { size: string; variant: string; bytes: number; results: BenchResult[] }[] | null;
+  xlsx?: { size: string; bytes: number; results: BenchResult[] }[] | null;
+  concurrency?: ConcurrencyBlock[];
+  memory?: MemoryBlock[];
+  pathological?: { size: string; variant: string; bytes: number; results: BenchResult[] }[];
+  comparison?: Comparison;
 }
 
 function toMarkdown(report: Report): string {
@@ -71,6 +279,36 @@ function toMarkdown(report: Report): string {
       lines.push(sectionXlsx(block.size, block.bytes, block.results));
     }
   }
+  if (report.pathological && report.pathological.length) {
+    lines.push("## Pathological Inputs");
+    lines.push("");
+    for (const block of report.pathological) {
+      lines.push(sectionCsv(block.size, block.variant, block.bytes, block.results));
+    }
+  }
+  if (report.concurrency && report.concurrency.length) {
+    lines.push("## Concurrency");
+    lines.push("");
+    lines.push("Pool probe: `fs.stat` round trip, which waits for a free libuv pool thread. HTTP: sequential keep-alive requests to a local server during the run.");
+    lines.push("");
+    for (const block of report.concurrency) {
+      lines.push(sectionConcurrency(block));
+    }
+  }
+  if (report.memory && report.memory.length) {
+    lines.push("## Memory");
+    lines.push("");
+    lines.push("Sampled from `/proc/self/status` (anonymous vs file-backed RSS) and `getrusage` page faults; each run in a fresh process. Peak arena is the parser's `peak_arena_usage`.");
+    lines.push("");
+    for (const block of report.memory) {
+      lines.push(sectionMemory(block));
+    }
+  }
+  if (report.comparison) {
+    lines.push("## Comparison with Baseline");
+    lines.push("");
+    lines.push(sectionComparison(report.comparison));
+  }
   return lines.join("\n");
 }
 
@@ -84,4 +322,4 @@ function writeReport(report: Report, timestamp?: string): string {
   return filePath;
 }
 
-module.exports = { toMarkdown, writeReport, formatResultRow, sectionCsv, sectionXlsx };
+module.exports = { toMarkdown, writeReport, formatResultRow, sectionCsv, sectionXlsx, sectionConcurrency, sectionMemory, sectionComparison, rssChart };
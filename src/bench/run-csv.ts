@@ -5,8 +5,10 @@ const { runCsvBenchForDataset } = require("./runners/csv-runner");
 const { printReport } = require("./reporters/console");
 const jsonReporter = require("./reporters/json");
 const mdReporter = require("./reporters/markdown");
+const { loadBaseline, compareWithBaseline } = require("./lib/compare");
 
 async function main(): Promise<void> {
+  const baseline = loadBaseline(process.argv.slice(2));
   const dataDir = config.DATA_DIR;
   const sizes = config.getActiveSizes();
   let variants = config.CSV_VARIANTS;
@@ -53,6 +55,7 @@ async function main(): Promise<void> {
     }
   }
 
+  const comparison = compareWithBaseline(report, baseline);
   printReport(report);
   const ts = new Date().toISOString().replace(/[:.]/g, "-").slice(0, 19);
   const jsonPath = jsonReporter.writeReport(report, ts);
@@ -60,6 +63,7 @@ async function main(): Promise<void> {
   console.log("\nReports written:");
   console.log("  ", jsonPath);
   console.log("  ", mdPath);
+  if (comparison && comparison.regressions > 0) process.exitCode = 1;
 }
 
 main().catch((err: unknown) => {
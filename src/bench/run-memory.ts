@@ -0,0 +1,77 @@
+"use strict";
+
+const fs = require("fs");
+const path = require("path");
+const config = require("./config");
+const { runMemoryProfile } = require("./runners/memory-runner");
+const { printReport } = require("./reporters/console");
+const jsonReporter = require("./reporters/json");
+const mdReporter = require("./reporters/markdown");
+
+const APIS = ["csv", "columnar"];
+const MODES = ["buffered", "mmap"];
+
+async function main(): Promise<void> {
+  const dataDir = config.DATA_DIR;
+  const sizes = config.getActiveSizes();
+  let variants = config.CSV_VARIANTS;
+  const sizeFilter = process.env.SIZE;
+  const variantFilter = process.env.VARIANT;
+  if (sizeFilter) {
+    if (!(sizeFilter in sizes)) throw new Error(`Unknown SIZE=${sizeFilter}`);
+    for (const k of Object.keys(sizes)) {
+      if (k !== sizeFilter) delete sizes[k];
+    }
+  }
+  if (variantFilter) {
+    if (!variants.includes(variantFilter)) throw new Error(`Unknown VARIANT=${variantFilter}`);
+    variants = [variantFilter];
+  }
+
+  const report: {
+    timestamp: string;
+    type: string;
+    csv: null;
+    xlsx: null;
+    memory: { size: string; variant: string; bytes: number; results: unknown[] }[];
+  } = {
+    timestamp: new Date().toISOString(),
+    type: "memory",
+    csv: null,
+    xlsx: null,
+    memory: [],
+  };
+
+  for (const sizeName of Object.keys(sizes)) {
+    for (const variant of variants) {
+      const filePath = path.join(dataDir, `csv_${sizeName}_${variant}.csv`);
+      process.stdout.write(`Memory ${sizeName} / ${variant}... `);
+      if (!fs.existsSync(filePath)) {
+        console.log(`FAIL: Dataset not found: ${filePath}. Run npm run bench:generate first.`);
+        continue;
+      }
+      const bytes = fs.statSync(filePath).size;
+      const results: unknown[] = [];
+      for (const api of APIS) {
+        for (const mode of MODES) {
+          results.push(await runMemoryProfile({ api, mode, filePath, fileSize: bytes, numCols: variant === "wide" ? 100 : 10 }));
+        }
+      }
+      report.memory.push({ size: sizeName, variant, bytes, results });
+      console.log("OK");
+    }
+  }
+
+  printReport(report);
+  const ts = new Date().toISOString().replace(/[:.]/g, "-").slice(0, 19);
+  const jsonPath = jsonReporter.writeReport(report, ts);
+  const mdPath = mdReporter.writeReport(report, ts);
+  console.log("\nReports written:");
+  console.log("  ", jsonPath);
+  console.log("  ", mdPath);
+}
+
+main().catch((err: unknown) => {
+  console.error(err);
+  process.exit(1);
+});
@@ -2,11 +2,22 @@
 
 const fs = require("fs");
 const path = require("path");
-const { csv, csvColumns } = require("../../index.js");
+const {
+  createParser,
+  getNextBatch,
+  destroyParser,
+  getParserMetrics,
+  createColumnarParser,
+  getNextColumnarBatch,
+  destroyColumnarParser,
+  getColumnarParserMetrics,
+} = require("../../index.js");
 const Papa = require("papaparse");
 const { parse } = require("csv-parse");
 const { parseStream } = require("@fast-csv/parse");
 const { runBenchmark } = require("../lib/run-bench");
+const { hwSummary, arenaSummary } = require("../lib/metrics");
+const { columnarSchema } = require("../lib/schema");
 const config = require("../config");
 
 const BATCH_SIZE = config.DEFAULT_BATCH_SIZE;
@@ -14,13 +25,14 @@ const BATCH_SIZE = config.DEFAULT_BATCH_SIZE;
 async function runPapaParse(filePath: string, fileSize: number): Promise<Record<string, unknown>> {
   return runBenchmark(
     "papaparse (stream)",
-    async () => {
+    async (markFirstBatch: () => void) => {
       return new Promise((resolve, reject) => {
         let rowCount = 0;
         const stream = fs.createReadStream(filePath, { encoding: "utf8" });
         Papa.parse(stream, {
           header: true,
           step: (results: { data: unknown[] }) => {
+            markFirstBatch();
             rowCount += results.data.length;
           },
           complete: () => resolve({ rowCount, bytesProcessed: fileSize }),
@@ -35,7 +47,7 @@ async function runPapaParse(filePath: string, fileSize: number): Promise<Record<
 async function runCsvParse(filePath: string, fileSize: number): Promise<Record<string, unknown>> {
   return runBenchmark(
     "csv-parse (stream)",
-    async () => {
+    async (markFirstBatch: () => void) => {
       return new Promise((resolve, reject) => {
         let rowCount = 0;
         const parser = parse({ delimiter: ",", relax_quotes: true });
@@ -43,6 +55,7 @@ async function runCsvParse(filePath: string, fileSize: number): Promise<Record<s
         fs.createReadStream(filePath)
           .pipe(parser)
           .on("data", () => {
+            markFirstBatch();
             if (first) { first = false; return; }
             rowCount++;
           })
@@ -57,13 +70,14 @@ async function runCsvParse(filePath: string, fileSize: number): Promise<Record<s
 async function runFastCsv(filePath: string, fileSize: number): Promise<Record<string, unknown>> {
   return runBenchmark(
     "fast-csv (stream)",
-    async () => {
+    async (markFirstBatch: () => void) => {
       return new Promise((resolve, reject) => {
         let rowCount = 0;
         const stream = fs.createReadStream(filePath);
         let first = true;
         parseStream(stream, { headers: false })
           .on("data", () => {
+            markFirstBatch();
             if (first) { first = false; return; }
             rowCount++;
           })
@@ -78,34 +92,50 @@ async function runFastCsv(filePath: string, fileSize: number): Promise<Record<st
 async function runUltratabCsv(filePath: string, fileSize: number): Promise<Record<string, unknown>> {
   return runBenchmark(
     "ultratab (string batches)",
-    async () => {
-      let rowCount = 0;
-      for await (const batch of csv(filePath, { headers: false, batchSize: BATCH_SIZE })) {
-        rowCount += batch.length;
+    async (markFirstBatch: () => void) => {
+      // Low-level API so the run can report the parser's hardware counters (null when the
+      // kernel does not expose them).
+      const parser = createParser(filePath, { headers: false, batchSize: BATCH_SIZE, perfCounters: true });
+      try {
+        let rowCount = 0;
+        let batch: string[][] | undefined;
+        while ((batch = await getNextBatch(parser)) !== undefined) {
+          markFirstBatch();
+          rowCount += batch.length;
+        }
+        const metrics = getParserMetrics(parser);
+        return { rowCount, bytesProcessed: fileSize, hw: hwSummary(metrics, fileSize), arena: arenaSummary(metrics) };
+      } finally {
+        destroyParser(parser);
       }
-      return { rowCount, bytesProcessed: fileSize };
     },
     { streaming: true }
   );
 }
 
 async function runUltratabColumnar(filePath: string, fileSize: number, numCols = 10): Promise<Record<string, unknown>> {
-  const schema: Record<string, "string" | "float64"> = {};
-  for (let i = 0; i < numCols; i++) {
-    schema[`col${i}`] = i % 3 === 0 ? "string" : "float64";
-  }
+  const schema = columnarSchema(numCols);
   return runBenchmark(
     "ultratab (columnar typed)",
-    async () => {
-      let rowCount = 0;
-      for await (const batch of csvColumns(filePath, {
+    async (markFirstBatch: () => void) => {
+      const parser = createColumnarParser(filePath, {
         headers: true,
         batchSize: BATCH_SIZE,
         schema,
-      })) {
-        rowCount += batch.rows;
+        perfCounters: true,
+      });
+      try {
+        let rowCount = 0;
+        let batch: { rows: number } | undefined;
+        while ((batch = await getNextColumnarBatch(parser)) !== undefined) {
+          markFirstBatch();
+          rowCount += batch.rows;
+        }
+        const metrics = getColumnarParserMetrics(parser);
+        return { rowCount, bytesProcessed: fileSize, hw: hwSummary(metrics, fileSize), arena: arenaSummary(metrics) };
+      } finally {
+        destroyColumnarParser(parser);
       }
-      return { rowCount, bytesProcessed: fileSize };
     },
     { streaming: true }
   );
@@ -0,0 +1,157 @@
+"use strict";
+
+const { fork } = require("child_process");
+const {
+  metrics,
+  createParser,
+  getNextBatch,
+  destroyParser,
+  getParserMetrics,
+  createColumnarParser,
+  getNextColumnarBatch,
+  destroyColumnarParser,
+  getColumnarParserMetrics,
+} = require("../../index.js");
+const { startMemorySampler, timelineByProgress } = require("../lib/memory");
+const { columnarSchema } = require("../lib/schema");
+const config = require("../config");
+
+type MemoryApi = "csv" | "columnar";
+type ReadMode = "buffered" | "mmap";
+
+interface MemoryProfileOptions {
+  api: MemoryApi;
+  mode: ReadMode;
+  filePath: string;
+  fileSize: number;
+  numCols: number;
+}
+
+interface BatchMeta {
+  byteEnd: number;
+}
+
+function arenaInUse(): number {
+  const snapshot = metrics() as { arena?: { bytes_in_use?: number } };
+  return snapshot.arena?.bytes_in_use ?? 0;
+}
+
+/**
+ * One parse of the whole file in this process, sampling memory on a timer. Progress comes
+ * from each batch's meta.byteEnd, which works for mmap too (bytes_read jumps to the file
+ * size on the first read there).
+ */
+async function profileInProcess(opts: MemoryProfileOptions): Promise<Record<string, unknown>> {
+  let consumed = 0;
+  const sampler = startMemorySampler(
+    config.MEMORY_SAMPLE_INTERVAL_MS,
+    () => (opts.fileSize > 0 ? consumed / opts.fileSize : 1),
+    arenaInUse
+  );
+  const parserOptions = {
+    headers: true,
+    batchSize: config.DEFAULT_BATCH_SIZE,
+    useMmap: opts.mode === "mmap",
+    batchInfo: true,
+  };
+  const start = process.hrtime.bigint();
+  let rowCount = 0;
+  let parserMetrics: Record<string, number> | null = null;
+  if (opts.api === "csv") {
+    const parser = createParser(opts.filePath, parserOptions);
+    try {
+      let batch: (string[][] & { meta?: BatchMeta }) | undefined;
+      while ((batch = await getNextBatch(parser)) !== undefined) {
+        rowCount += batch.length;
+        if (batch.meta) consumed = batch.meta.byteEnd;
+      }
+      parserMetrics = getParserMetrics(parser);
+    } finally {
+      destroyParser(parser);
+    }
+  } else {
+    const parser = createColumnarParser(opts.filePath, { ...parserOptions, schema: columnarSchema(opts.numCols) });
+    try {
+      let batch: { rows: number; meta?: BatchMeta } | undefined;
+      while ((batch = await getNextColumnarBatch(parser)) !== undefined) {
+        rowCount += batch.rows;
+        if (batch.meta) consumed = batch.meta.byteEnd;
+      }
+      parserMetrics = getColumnarParserMetrics(parser);
+    } finally {
+      destroyColumnarParser(parser);
+    }
+  }
+  const elapsedMs = Number(process.hrtime.bigint() - start) / 1e6;
+  consumed = opts.fileSize;
+  const samples = sampler.stop();
+
+  const first = samples[0];
+  const peak = (fn: (s: typeof first) => number | null): number | null => {
+    if (fn(first) === null) return null;
+    return Math.max(...samples.map((s) => fn(s) ?? 0));
+  };
+  const last = samples[samples.length - 1];
+  const points = config.MEMORY_TIMELINE_POINTS;
+  return {
+    name: `ultratab ${opts.api} (${opts.mode})`,
+    api: opts.api,
+    mode: opts.mode,
+    elapsedMs,
+    rowCount,
+    bytesProcessed: opts.fileSize,
+    baseline: { rss: first.rss, rssAnon: first.rssAnon, rssFile: first.rssFile },
+    peak: {
+      rss: peak((s) => s.rss),
+      rssAnon: peak((s) => s.rssAnon),
+      rssFile: peak((s) => s.rssFile),
+      heapUsed: peak((s) => s.heapUsed),
+      arenaInUse: peak((s) => s.arenaInUse),
+    },
+    pageFaults: {
+      minor: last.minorFaults - first.minorFaults,
+      major: last.majorFaults - first.majorFaults,
+    },
+    arena: {
+      peakArenaUsage: parserMetrics?.peak_arena_usage ?? null,
+      arenaBlocks: parserMetrics?.arena_blocks ?? null,
+      arenaBytesAllocated: parserMetrics?.arena_bytes_allocated ?? null,
+    },
+    samples: samples.length,
+    timeline: {
+      points,
+      rss: timelineByProgress(samples, points, (s: typeof first) => s.rss),
+      rssAnon: first.rssAnon === null ? null : timelineByProgress(samples, points, (s: typeof first) => s.rssAnon ?? 0),
+      rssFile: first.rssFile === null ? null : timelineByProgress(samples, points, (s: typeof first) => s.rssFile ?? 0),
+      arenaInUse: timelineByProgress(samples, points, (s: typeof first) => s.arenaInUse),
+    },
+  };
+}
+
+/** Runs one profile in a fresh child process so earlier runs do not inflate its RSS. */
+function runMemoryProfile(opts: MemoryProfileOptions): Promise<Record<string, unknown>> {
+  const name = `ultratab ${opts.api} (${opts.mode})`;
+  return new Promise((resolve) => {
+    const child = fork(__filename, [JSON.stringify(opts)], { stdio: ["ignore", "inherit", "inherit", "ipc"] });
+    let result: Record<string, unknown> | null = null;
+    child.on("message", (msg: Record<string, unknown>) => {
+      result = msg;
+    });
+    child.on("error", (err: Error) => resolve({ name, api: opts.api, mode: opts.mode, error: err.message }));
+    child.on("exit", (code: number | null) => {
+      resolve(result ?? { name, api: opts.api, mode: opts.mode, error: `profile process exited with code ${code}` });
+    });
+  });
+}
+
+if (require.main === module) {
+  const opts = JSON.parse(process.argv[2]) as MemoryProfileOptions;
+  profileInProcess(opts)
+    .catch((err: Error) => ({ name: `ultratab ${opts.api} (${opts.mode})`, api: opts.api, mode: opts.mode, error: err.message }))
+    .then((result: Record<string, unknown>) => process.send!(result, () => process.exit(0)));
+}
+
+module.exports = {
+  profileInProcess,
+  runMemoryProfile,
+};
@@ -0,0 +1,105 @@
+"use strict";
+
+const fs = require("fs");
+const path = require("path");
+const {
+  createParser,
+  getNextBatch,
+  destroyParser,
+  getParserMetrics,
+  createColumnarParser,
+  getNextColumnarBatch,
+  destroyColumnarParser,
+  getColumnarParserMetrics,
+} = require("../../index.js");
+const { runBenchmark } = require("../lib/run-bench");
+const { hwSummary, arenaSummary } = require("../lib/metrics");
+const config = require("../config");
+
+const BATCH_SIZE = config.DEFAULT_BATCH_SIZE;
+
+/** Parser options shared by every run on a variant; buffer_boundary uses the smallest read buffer. */
+function variantOptions(variant: string): Record<string, unknown> {
+  const opts: Record<string, unknown> = { headers: true, batchSize: BATCH_SIZE, perfCounters: true };
+  if (variant === "buffer_boundary") opts.readBufferSize = config.BOUNDARY_READ_BUFFER_SIZE;
+  return opts;
+}
+
+async function runUltratabRows(name: string, filePath: string, fileSize: number, options: Record<string, unknown>): Promise<Record<string, unknown>> {
+  return runBenchmark(
+    name,
+    async (markFirstBatch: () => void) => {
+      const parser = createParser(filePath, options);
+      try {
+        let rowCount = 0;
+        let batch: string[][] | undefined;
+        while ((batch = await getNextBatch(parser)) !== undefined) {
+          markFirstBatch();
+          rowCount += batch.length;
+        }
+        const metrics = getParserMetrics(parser);
+        return { rowCount, bytesProcessed: fileSize, hw: hwSummary(metrics, fileSize), arena: arenaSummary(metrics) };
+      } finally {
+        destroyParser(parser);
+      }
+    },
+    { streaming: true }
+  );
+}
+
+/** Columnar with no schema: every column is a string column, so the cost is all tokenize and copy. */
+async function runUltratabColumnarStrings(filePath: string, fileSize: number, options: Record<string, unknown>): Promise<Record<string, unknown>> {
+  return runBenchmark(
+    "ultratab (columnar strings)",
+    async (markFirstBatch: () => void) => {
+      const parser = createColumnarParser(filePath, options);
+      try {
+        let rowCount = 0;
+        let batch: { rows: number } | undefined;
+        while ((batch = await getNextColumnarBatch(parser)) !== undefined) {
+          markFirstBatch();
+          rowCount += batch.rows;
+        }
+        const metrics = getColumnarParserMetrics(parser);
+        return { rowCount, bytesProcessed: fileSize, hw: hwSummary(metrics, fileSize), arena: arenaSummary(metrics) };
+      } finally {
+        destroyColumnarParser(parser);
+      }
+    },
+    { streaming: true }
+  );
+}
+
+/** Both tokenizers plus the columnar path on one pathological dataset. */
+async function runPathologicalForDataset(sizeName: string, variant: string, dataDir: string): Promise<{
+  size: string;
+  variant: string;
+  filePath: string;
+  bytes: number;
+  results: Record<string, unknown>[];
+}> {
+  const filePath = path.join(dataDir, `csv_${sizeName}_${variant}.csv`);
+  if (!fs.existsSync(filePath)) {
+    throw new Error(`Dataset not found: ${filePath}. Run node bench/dataset/generate-pathological.js first.`);
+  }
+  const bytes = fs.statSync(filePath).size;
+  const options = variantOptions(variant);
+  const runners = [
+    () => runUltratabRows("ultratab (simd)", filePath, bytes, { ...options, engine: "simd" }),
+    () => runUltratabRows("ultratab (dfa)", filePath, bytes, { ...options, engine: "dfa" }),
+    () => runUltratabColumnarStrings(filePath, bytes, options),
+  ];
+  const results: Record<string, unknown>[] = [];
+  for (const run of runners) {
+    try {
+      results.push(await run());
+    } catch (err) {
+      results.push({ name: (err as Error).name || "unknown", error: (err as Error).message, streaming: null });
+    }
+  }
+  return { size: sizeName, variant, filePath, bytes, results };
+}
+
+module.exports = {
+  runPathologicalForDataset,
+};
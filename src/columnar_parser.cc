@@ -1,26 +1,48 @@
 #include "columnar_parser.h"
+#include "datetime_parser.h"
+#include "simd_scanner.h"
 #include <algorithm>
 #include <cctype>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string_view>
 
 namespace ultratab {
 
 namespace {
 
-void trimStringImpl(std::string& s) {
-  auto start = s.find_first_not_of(" \t\r\n");
-  if (start == std::string::npos) {
-    s.clear();
-    return;
-  }
-  auto end = s.find_last_not_of(" \t\r\n");
-  s = s.substr(start, end == std::string::npos ? std::string::npos : end - start + 1);
-}
+inline bool isTrimSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
 
 }  // namespace
 
-void trimString(std::string& s) { trimStringImpl(s); }
+void trimSlice(const char*& start, const char*& end, const CpuFeatures& features) {
+  if (start == end || (!isTrimSpace(*start) && !isTrimSpace(end[-1]))) return;
+  std::size_t len = static_cast<std::size_t>(end - start);
+  std::size_t lead = skipSpace(start, len, features);
+  start += lead;
+  end = start + skipSpaceBack(start, len - lead, features);
+}
+
+void trimSlice(const char*& start, const char*& end) {
+  trimSlice(start, end, trimFeatures(TokenizerEngine::Auto));
+}
+
+const CpuFeatures& trimFeatures(TokenizerEngine engine) {
+  static const CpuFeatures detected = detectCpuFeatures();
+  static const CpuFeatures scalar;
+  return engine == TokenizerEngine::Dfa ? scalar : detected;
+}
+
+void trimString(std::string& s) {
+  const char* start = s.data();
+  const char* end = start + s.size();
+  trimSlice(start, end);
+  std::size_t lead = static_cast<std::size_t>(start - s.data());
+  s.erase(static_cast<std::size_t>(end - s.data()));
+  s.erase(0, lead);
+}
 
 bool isNullValue(const std::string& s,
                  const std::vector<std::string>& null_values) {
@@ -30,6 +52,94 @@ bool isNullValue(const std::string& s,
   return false;
 }
 
+NullMatcher::NullMatcher(const std::vector<std::string>& null_values) {
+  for (const std::string& token : null_values) {
+    if (token.empty()) {
+      empty_is_null_ = true;
+      continue;
+    }
+    std::size_t bucket = token.size() < kLongBucket ? token.size() : kLongBucket;
+    std::vector<std::string>& tokens = buckets_[bucket];
+    if (std::find(tokens.begin(), tokens.end(), token) != tokens.end()) continue;
+    tokens.push_back(token);
+    length_mask_ |= std::uint64_t{1} << bucket;
+  }
+}
+
+bool normalizeNumber(const char* start, const char* end, const NumberFormat& format,
+                     char* out, std::size_t& len) {
+  const char* p = start;
+  const char* e = end;
+  char sign = 0;
+  if (p < e && (*p == '-' || *p == '+')) sign = *p++;
+  const std::string& currency = format.currency;
+  std::size_t clen = currency.size();
+  if (clen != 0 && static_cast<std::size_t>(e - p) >= clen) {
+    if (std::memcmp(p, currency.data(), clen) == 0) {
+      p += clen;
+      while (p < e && *p == ' ') ++p;
+    } else if (std::memcmp(e - clen, currency.data(), clen) == 0) {
+      e -= clen;
+      while (e > p && e[-1] == ' ') --e;
+    }
+    // "$-5" as well as "-$5".
+    if (sign == 0 && p < e && (*p == '-' || *p == '+')) sign = *p++;
+  }
+  if (format.percent && e > p && e[-1] == '%') {
+    --e;
+    while (e > p && e[-1] == ' ') --e;
+  }
+
+  std::size_t n = 0;
+  if (sign != 0) out[n++] = sign;
+  const std::string& grouping = format.grouping;
+  int lead_digits = 0;    // integer digits before the first grouping separator
+  int group_digits = -1;  // digits since the last one; -1 until one is seen
+  while (p < e) {
+    char c = *p;
+    if (c >= '0' && c <= '9') {
+      if (n == kMaxNumberText) return false;
+      out[n++] = c;
+      if (group_digits < 0) ++lead_digits;
+      else ++group_digits;
+      ++p;
+      continue;
+    }
+    if (!grouping.empty() && c == grouping[0] &&
+        static_cast<std::size_t>(e - p) >= grouping.size() &&
+        std::memcmp(p, grouping.data(), grouping.size()) == 0) {
+      bool ok = group_digits < 0 ? (lead_digits >= 1 && lead_digits <= 3) : group_digits == 3;
+      if (!ok) return false;
+      group_digits = 0;
+      p += grouping.size();
+      continue;
+    }
+    break;
+  }
+  // The integer part ends here: its last group must be whole.
+  if (group_digits >= 0 && group_digits != 3) return false;
+  if (p < e && *p == format.decimal) {
+    if (n == kMaxNumberText) return false;
+    out[n++] = '.';
+    ++p;
+    while (p < e && *p >= '0' && *p <= '9') {
+      if (n == kMaxNumberText) return false;
+      out[n++] = *p++;
+    }
+  }
+  if (p < e && (*p == 'e' || *p == 'E')) {
+    // The exponent goes through as written; the parser validates it.
+    std::size_t rest = static_cast<std::size_t>(e - p);
+    if (rest > kMaxNumberText - n) return false;
+    std::memcpy(out + n, p, rest);
+    n += rest;
+    p = e;
+  }
+  if (p != e) return false;
+  len = n;
+  return true;
+}
+
 bool parseBool(const char* start, const char* end, bool& out) {
   std::size_t len = static_cast<std::size_t>(end - start);
   if (len == 0) return false;
@@ -108,24 +218,380 @@ bool parseInt64(const char* start, const char* end, std::int64_t& out) {
 
 bool parseFloat64(const char* start, const char* end, double& out) {
   if (start >= end) return false;
+  // strtod reads up to a terminator, and a slice need not end in one (arena fields can be
+  // adjacent), so parse a terminated copy.
+  std::size_t len = static_cast<std::size_t>(end - start);
+  char small[64];
+  std::string large;
+  const char* text = small;
+  if (len < sizeof(small)) {
+    std::memcpy(small, start, len);
+    small[len] = '\0';
+  } else {
+    large.assign(start, len);
+    text = large.c_str();
+  }
   char* endptr = nullptr;
-  double val = std::strtod(start, &endptr);
-  if (endptr != end) return false;
+  double val = std::strtod(text, &endptr);
+  if (endptr != text + len) return false;
   if (std::isnan(val) || std::isinf(val)) return false;
   out = val;
   return true;
 }
 
+template <typename T>
+bool parseIntInRange(const char* start, const char* end, T& out) {
+  std::int64_t v;
+  if (!parseInt64(start, end, v)) return false;
+  if (v < static_cast<std::int64_t>(std::numeric_limits<T>::min()) ||
+      v > static_cast<std::int64_t>(std::numeric_limits<T>::max()))
+    return false;
+  out = static_cast<T>(v);
+  return true;
+}
+
+template bool parseIntInRange<std::int8_t>(const char*, const char*, std::int8_t&);
+template bool parseIntInRange<std::int16_t>(const char*, const char*, std::int16_t&);
+template bool parseIntInRange<std::uint8_t>(const char*, const char*, std::uint8_t&);
+template bool parseIntInRange<std::uint16_t>(const char*, const char*, std::uint16_t&);
+template bool parseIntInRange<std::uint32_t>(const char*, const char*, std::uint32_t&);
+
+bool parseFloat32(const char* start, const char* end, float& out) {
+  double v;
+  if (!parseFloat64(start, end, v)) return false;
+  if (std::fabs(v) > static_cast<double>(std::numeric_limits<float>::max())) return false;
+  out = static_cast<float>(v);
+  return true;
+}
+
+namespace {
+
+// Checks decimal text against \a type and calls push(digit) for each digit of the scaled
+// integer: the integer digits without leading zeros, then the fraction padded to scale.
+template <typename Push>
+bool scanDecimal(const char* start, const char* end, DecimalType type, bool& neg, Push push) {
+  const char* p = start;
+  neg = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    neg = *p == '-';
+    ++p;
+  }
+  const char* int_begin = p;
+  while (p < end && *p == '0') ++p;
+  const char* sig = p;
+  while (p < end && std::isdigit(static_cast<unsigned char>(*p))) ++p;
+  const char* int_end = p;
+  const char* frac = p;
+  std::size_t frac_len = 0;
+  if (p < end && *p == '.') {
+    frac = ++p;
+    while (p < end && std::isdigit(static_cast<unsigned char>(*p))) ++p;
+    frac_len = static_cast<std::size_t>(p - frac);
+  }
+  if (p != end || (int_end == int_begin && frac_len == 0)) return false;
+  if (static_cast<std::size_t>(int_end - sig) + type.scale > type.precision) return false;
+  for (std::size_t i = type.scale; i < frac_len; ++i) {
+    if (frac[i] != '0') return false;
+  }
+  for (const char* q = sig; q < int_end; ++q) push(static_cast<unsigned>(*q - '0'));
+  for (std::size_t i = 0; i < type.scale; ++i)
+    push(i < frac_len ? static_cast<unsigned>(frac[i] - '0') : 0u);
+  return true;
+}
+
+}  // namespace
+
+bool parseDecimal64(const char* start, const char* end, DecimalType type, std::int64_t& out) {
+  if (type.precision > kMaxDecimal64Precision) return false;
+  // At most 18 digits, so the accumulator cannot overflow.
+  std::uint64_t acc = 0;
+  bool neg;
+  if (!scanDecimal(start, end, type, neg, [&](unsigned d) { acc = acc * 10 + d; }))
+    return false;
+  out = neg ? -static_cast<std::int64_t>(acc) : static_cast<std::int64_t>(acc);
+  return true;
+}
+
+bool parseDecimal128(const char* start, const char* end, DecimalType type, std::uint64_t& lo,
+                     std::int64_t& hi) {
+  if (type.precision > kMaxDecimalPrecision) return false;
+  // (h, l) = (h, l) * 10 + d in 32-bit limbs; 38 digits stay below 2^127.
+  std::uint64_t h = 0, l = 0;
+  bool neg;
+  auto push = [&](unsigned d) {
+    std::uint64_t low = (l & 0xffffffffu) * 10 + d;
+    std::uint64_t high = (l >> 32) * 10 + (low >> 32);
+    l = (high << 32) | (low & 0xffffffffu);
+    h = h * 10 + (high >> 32);
+  };
+  if (!scanDecimal(start, end, type, neg, push)) return false;
+  if (neg) {
+    l = ~l + 1;
+    h = ~h + (l == 0 ? 1 : 0);
+  }
+  lo = l;
+  hi = static_cast<std::int64_t>(h);
+  return true;
+}
+
+namespace {
+
+// Decimal digits with an optional sign, point and exponent; keeps strtod's hex, inf and
+// leading-space forms out of inferred float columns.
+bool isPlainNumber(const char* start, const char* end) {
+  if (start >= end) return false;
+  for (const char* p = start; p < end; ++p) {
+    char c = *p;
+    if (!std::isdigit(static_cast<unsigned char>(c)) && c != '+' && c != '-' && c != '.' &&
+        c != 'e' && c != 'E')
+      return false;
+  }
+  return true;
+}
+
+const std::int64_t kMicrosPerDay = 86400LL * 1000000;
+
+std::int64_t floorDiv(std::int64_t a, std::int64_t b) {
+  std::int64_t q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// A Date32 or Timestamp cell in the column's unit: days, ms or us. Uses \a format when
+// given, else ISO-8601. With \a exact, a value the unit cannot hold without truncation
+// (a time of day in a Date32 column, sub-millisecond digits in TimestampMs) fails.
+bool parseTimeCell(ColumnType type, const TimeFormat* format, const char* start,
+                   const char* end, bool exact, std::int64_t& out) {
+  if (type == ColumnType::Date32 && !format) {
+    std::int32_t days;
+    if (!parseIsoDate(start, end, days)) return false;
+    out = days;
+    return true;
+  }
+  std::int64_t us;
+  if (!(format ? format->parse(start, end, us) : parseIsoTimestamp(start, end, us)))
+    return false;
+  std::int64_t unit = type == ColumnType::Date32 ? kMicrosPerDay
+                      : type == ColumnType::TimestampMs ? 1000 : 1;
+  if (exact && us % unit != 0) return false;
+  out = floorDiv(us, unit);
+  return true;
+}
+
+bool valueFits(ColumnType type, const TimeFormat* time_format, const char* start,
+               const char* end) {
+  switch (type) {
+    case ColumnType::String: return true;
+    case ColumnType::Int32: { std::int32_t v; return parseInt32(start, end, v); }
+    case ColumnType::Int64: { std::int64_t v; return parseInt64(start, end, v); }
+    case ColumnType::Float64: {
+      double v;
+      return isPlainNumber(start, end) && parseFloat64(start, end, v);
+    }
+    case ColumnType::Bool: { bool v; return parseBool(start, end, v); }
+    case ColumnType::Date32:
+    case ColumnType::TimestampMs:
+    case ColumnType::TimestampUs: {
+      std::int64_t v;
+      return parseTimeCell(type, time_format, start, end, true, v);
+    }
+    case ColumnType::Decimal:
+      return false;  // never inferred; needs a precision and scale
+    case ColumnType::Int8:
+    case ColumnType::Int16:
+    case ColumnType::UInt8:
+    case ColumnType::UInt16:
+    case ColumnType::UInt32:
+    case ColumnType::Float32:
+      return false;  // never inferred; explicit schemas only
+  }
+  return false;
+}
+
+bool isNumericType(ColumnType type) {
+  return type == ColumnType::Int32 || type == ColumnType::Int64 || type == ColumnType::Float64;
+}
+
+// Integer text a double cannot hold exactly: an int64 beyond +/-2^53.
+bool isInexactInDouble(const char* start, const char* end) {
+  constexpr std::int64_t kMaxExact = std::int64_t{1} << 53;
+  std::int64_t v;
+  return parseInt64(start, end, v) && (v > kMaxExact || v < -kMaxExact);
+}
+
+bool isTimeType(ColumnType type) {
+  return type == ColumnType::Date32 || type == ColumnType::TimestampMs ||
+         type == ColumnType::TimestampUs;
+}
+
+}  // namespace
+
+std::size_t packBits(const std::uint8_t* bytes, std::size_t n, bool invert,
+                     std::uint8_t* out) {
+  // Eight 0/1 bytes, loaded little-endian, gather into one byte with a single multiply;
+  // the byte-sum multiply counts them at the same time.
+  const std::uint64_t kGather = 0x0102040810204080ULL;
+  const std::uint64_t kSum = 0x0101010101010101ULL;
+  const std::uint8_t flip = invert ? 0xFF : 0x00;
+  std::size_t ones = 0;
+  std::size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    std::uint64_t word = 0;
+    for (unsigned k = 0; k < 8; ++k) {
+      std::uint64_t x;
+      std::memcpy(&x, bytes + i + k * 8, 8);
+      ones += static_cast<std::size_t>((x * kSum) >> 56);
+      word |= static_cast<std::uint64_t>(static_cast<std::uint8_t>((x * kGather) >> 56) ^ flip)
+              << (k * 8);
+    }
+    for (unsigned k = 0; k < 8; ++k) out[i / 8 + k] = static_cast<std::uint8_t>(word >> (k * 8));
+  }
+  for (; i < n; i += 8) {
+    std::uint8_t bits = 0;
+    std::size_t len = n - i < 8 ? n - i : 8;
+    for (std::size_t k = 0; k < len; ++k) {
+      ones += bytes[i + k];
+      bits |= static_cast<std::uint8_t>(((bytes[i + k] != 0) ^ invert) << k);
+    }
+    out[i / 8] = bits;
+  }
+  return ones;
+}
+
+ColumnType inferValueType(const TimeFormat* time_format, const char* start, const char* end) {
+  if (valueFits(ColumnType::Int32, nullptr, start, end)) return ColumnType::Int32;
+  if (valueFits(ColumnType::Int64, nullptr, start, end)) return ColumnType::Int64;
+  if (valueFits(ColumnType::Float64, nullptr, start, end)) return ColumnType::Float64;
+  if (valueFits(ColumnType::Bool, nullptr, start, end)) return ColumnType::Bool;
+  if (valueFits(ColumnType::Date32, time_format, start, end)) return ColumnType::Date32;
+  if (valueFits(ColumnType::TimestampMs, time_format, start, end))
+    return ColumnType::TimestampMs;
+  if (valueFits(ColumnType::TimestampUs, time_format, start, end))
+    return ColumnType::TimestampUs;
+  return ColumnType::String;
+}
+
+ColumnType widenColumnType(ColumnType current, const TimeFormat* time_format,
+                           const char* start, const char* end) {
+  if (valueFits(current, time_format, start, end)) {
+    if (current == ColumnType::Float64 && isInexactInDouble(start, end))
+      return ColumnType::String;
+    return current;
+  }
+  ColumnType value = inferValueType(time_format, start, end);
+  bool numeric = isNumericType(current) && isNumericType(value);
+  bool time = isTimeType(current) && isTimeType(value);
+  if (!numeric && !time) return ColumnType::String;
+  // An Int64 column may already hold values past 2^53 that a double would round.
+  if (current == ColumnType::Int64 && value == ColumnType::Float64) return ColumnType::String;
+  // Within each family the enumerators are declared narrowest first.
+  return std::max(current, value);
+}
+
+namespace {
+
+// Cell col_idx of row r (empty past the row's end), trimmed by narrowing the view rather
+// than copying.
+std::string_view cellAt(const CellViews& batch, std::size_t r, std::size_t col_idx,
+                        bool trim, const CpuFeatures& features) {
+  std::size_t i = batch.row_start[r] + col_idx;
+  if (i >= batch.row_start[r + 1]) return std::string_view();
+  const char* start = batch.cells[i].data();
+  const char* end = start + batch.cells[i].size();
+  if (trim) trimSlice(start, end, features);
+  return std::string_view(start, static_cast<std::size_t>(end - start));
+}
+
+// \a cell in plain number text when the column has a NumberFormat, written to buf
+// (kMaxNumberText bytes). Text the format rejects becomes empty so it fails to parse.
+std::string_view numberText(const NumberFormat* format, std::string_view cell, char* buf) {
+  if (format == nullptr) return cell;
+  std::size_t len = 0;
+  if (!normalizeNumber(cell.data(), cell.data() + cell.size(), *format, buf, len)) len = 0;
+  return std::string_view(buf, len);
+}
+
+// One explicit narrow column: parse(start, end, T&) per cell into data; nulls and failures
+// set the null mask.
+template <typename T, typename Parse>
+void convertNarrowColumn(const CellViews& batch, std::size_t col_idx, const ColumnarOptions& opts,
+                         const NullMatcher& nulls, const NumberFormat* number_format,
+                         Parse parse, std::unique_ptr<std::vector<T>>& data,
+                         std::vector<std::uint8_t>& null_mask) {
+  data = std::make_unique<std::vector<T>>(batch.rows(), T());
+  const CpuFeatures& features = trimFeatures(opts.engine);
+  char buf[kMaxNumberText];
+  for (std::size_t r = 0; r < batch.rows(); ++r) {
+    std::string_view cell = cellAt(batch, r, col_idx, opts.trim, features);
+    bool null = nulls.match(cell.data(), cell.size());
+    if (!null) cell = numberText(number_format, cell, buf);
+    if (null || !parse(cell.data(), cell.data() + cell.size(), (*data)[r])) null_mask[r] = 1;
+  }
+}
+
+// Count the column's nulls, then repack the byte mask and Bool values for opts.
+void finishColumn(ColumnarColumn& col, std::size_t rows, const ColumnarOptions& opts) {
+  if (!col.null_mask) return;
+  std::vector<std::uint8_t>& mask = *col.null_mask;
+  if (opts.bit_packed) {
+    std::vector<std::uint8_t> validity((rows + 7) / 8);
+    col.null_count = packBits(mask.data(), rows, true, validity.data());
+    mask.swap(validity);
+    if (col.bool_data) {
+      std::vector<std::uint8_t> bits((rows + 7) / 8);
+      packBits(col.bool_data->data(), rows, false, bits.data());
+      col.bool_data->swap(bits);
+    }
+  } else {
+    col.null_count = static_cast<std::size_t>(std::count(mask.begin(), mask.end(), 1));
+  }
+  if (opts.omit_empty_null_mask && col.null_count == 0) col.null_mask.reset();
+}
+
+// Type to rebuild a column at after \a cell failed to convert as \a type, judged with the
+// same time format the conversion used. A value the converter rejects but the inference
+// rules accept goes to String, so the rebuild always makes progress.
+ColumnType widenOnConflict(ColumnType type, const TimeFormat* time_format,
+                           std::string_view cell) {
+  ColumnType wider =
+      widenColumnType(type, time_format, cell.data(), cell.data() + cell.size());
+  return wider == type ? ColumnType::String : wider;
+}
+
+}  // namespace
+
 void rowsToColumnar(const Batch& batch, const std::vector<std::string>& headers,
                     const ColumnarOptions& opts, ColumnarBatch& out) {
-  out.rows = batch.size();
+  rowsToColumnar(batch, headers, opts, NullMatcher(opts.null_values), out);
+}
+
+void rowsToColumnar(const Batch& batch, const std::vector<std::string>& headers,
+                    const ColumnarOptions& opts, const NullMatcher& nulls,
+                    ColumnarBatch& out) {
+  CellViews cells;
+  std::size_t total = 0;
+  for (const Row& row : batch) total += row.size();
+  cells.cells.reserve(total);
+  cells.row_start.reserve(batch.size() + 1);
+  for (const Row& row : batch) {
+    for (const std::string& cell : row) cells.cells.emplace_back(cell);
+    cells.row_start.push_back(cells.cells.size());
+  }
+  rowsToColumnar(cells, headers, opts, nulls, out);
+}
+
+void rowsToColumnar(const CellViews& batch, const std::vector<std::string>& headers,
+                    const ColumnarOptions& opts, const NullMatcher& nulls,
+                    ColumnarBatch& out) {
+  out.rows = batch.rows();
   out.columns.clear();
 
-  if (batch.empty()) {
+  if (out.rows == 0) {
     out.headers.clear();
     return;
   }
 
+  const CpuFeatures& features = trimFeatures(opts.engine);
+
   std::unordered_set<std::string> select_set;
   if (!opts.select.empty()) {
     for (const auto& s : opts.select) select_set.insert(s);
@@ -141,102 +607,230 @@ void rowsToColumnar(const Batch& batch, const std::vector<std::string>& headers,
     auto it = opts.schema.find(hdr);
     ColumnType col_type = (it != opts.schema.end()) ? it->second : ColumnType::String;
 
-    ColumnarColumn col;
-    col.type = col_type;
-    bool need_null_mask = (col_type != ColumnType::String);
-    if (need_null_mask) {
-      col.null_mask = std::make_unique<std::vector<std::uint8_t>>(batch.size(), 0);
+    // With an inferred schema a value that does not parse widens the column, and the
+    // column is rebuilt at the wider type.
+    ColumnType widened = col_type;
+    std::unique_ptr<TimeFormat> time_format;
+    auto fmt = opts.time_formats.find(hdr);
+    if (fmt != opts.time_formats.end()) {
+      time_format.reset(new TimeFormat(fmt->second));
+      if (!time_format->valid()) time_format.reset();
     }
-
-    switch (col_type) {
-      case ColumnType::String: {
-        col.strings.reserve(batch.size());
-        for (std::size_t r = 0; r < batch.size(); ++r) {
-          std::string cell = (col_idx < batch[r].size()) ? batch[r][col_idx] : "";
-          if (opts.trim) trimString(cell);
-          if (isNullValue(cell, opts.null_values)) cell = "";
-          col.strings.push_back(std::move(cell));
-        }
-        break;
+    auto nf = opts.number_formats.find(hdr);
+    const NumberFormat* number_format = nf != opts.number_formats.end() ? &nf->second : nullptr;
+    char num_buf[kMaxNumberText];
+    ColumnarColumn col;
+    for (;;) {
+      col = ColumnarColumn();
+      col.type = col_type;
+      bool need_null_mask = (col_type != ColumnType::String);
+      if (need_null_mask) {
+        col.null_mask = std::make_unique<std::vector<std::uint8_t>>(batch.rows(), 0);
       }
-      case ColumnType::Int32: {
-        col.int32_data = std::make_unique<std::vector<std::int32_t>>(batch.size(), 0);
-        for (std::size_t r = 0; r < batch.size(); ++r) {
-          std::string cell = (col_idx < batch[r].size()) ? batch[r][col_idx] : "";
-          if (opts.trim) trimString(cell);
-          if (isNullValue(cell, opts.null_values)) {
-            (*col.null_mask)[r] = 1;
-            continue;
+
+      switch (col_type) {
+        case ColumnType::String: {
+          col.strings.reserve(batch.rows());
+          for (std::size_t r = 0; r < batch.rows(); ++r) {
+            std::string_view cell = cellAt(batch, r, col_idx, opts.trim, features);
+            if (nulls.match(cell.data(), cell.size())) cell = std::string_view();
+            col.strings.emplace_back(cell);
           }
-          std::int32_t v;
-          if (parseInt32(cell.data(), cell.data() + cell.size(), v)) {
-            (*col.int32_data)[r] = v;
-          } else {
-            if (opts.typed_fallback == TypedFallback::Null) {
+          break;
+        }
+        case ColumnType::Int32: {
+          col.int32_data = std::make_unique<std::vector<std::int32_t>>(batch.rows(), 0);
+          for (std::size_t r = 0; r < batch.rows(); ++r) {
+            std::string_view cell = cellAt(batch, r, col_idx, opts.trim, features);
+            if (nulls.match(cell.data(), cell.size())) {
               (*col.null_mask)[r] = 1;
+              continue;
+            }
+            cell = numberText(number_format, cell, num_buf);
+            std::int32_t v;
+            if (parseInt32(cell.data(), cell.data() + cell.size(), v)) {
+              (*col.int32_data)[r] = v;
+            } else if (opts.infer_schema) {
+              widened = widenOnConflict(col_type, time_format.get(), cell);
+              break;
             } else {
-              (*col.null_mask)[r] = 1;  // Still mark as null for typed column; fallback "string" would require different storage
-              // For typed columns, fallback to null when parse fails (simplest).
+              if (opts.typed_fallback == TypedFallback::Null) {
+                (*col.null_mask)[r] = 1;
+              } else {
+                (*col.null_mask)[r] = 1;  // Still mark as null for typed column; fallback "string" would require different storage
+                // For typed columns, fallback to null when parse fails (simplest).
+              }
             }
           }
+          break;
         }
-        break;
-      }
-      case ColumnType::Int64: {
-        col.int64_data = std::make_unique<std::vector<std::int64_t>>(batch.size(), 0);
-        for (std::size_t r = 0; r < batch.size(); ++r) {
-          std::string cell = (col_idx < batch[r].size()) ? batch[r][col_idx] : "";
-          if (opts.trim) trimString(cell);
-          if (isNullValue(cell, opts.null_values)) {
-            (*col.null_mask)[r] = 1;
-            continue;
-          }
-          std::int64_t v;
-          if (parseInt64(cell.data(), cell.data() + cell.size(), v)) {
-            (*col.int64_data)[r] = v;
-          } else {
-            (*col.null_mask)[r] = 1;
+        case ColumnType::Int64: {
+          col.int64_data = std::make_unique<std::vector<std::int64_t>>(batch.rows(), 0);
+          for (std::size_t r = 0; r < batch.rows(); ++r) {
+            std::string_view cell = cellAt(batch, r, col_idx, opts.trim, features);
+            if (nulls.match(cell.data(), cell.size())) {
+              (*col.null_mask)[r] = 1;
+              continue;
+            }
+            cell = numberText(number_format, cell, num_buf);
+            std::int64_t v;
+            if (parseInt64(cell.data(), cell.data() + cell.size(), v)) {
+              (*col.int64_data)[r] = v;
+            } else if (opts.infer_schema) {
+              widened = widenOnConflict(col_type, time_format.get(), cell);
+              break;
+            } else {
+              (*col.null_mask)[r] = 1;
+            }
           }
+          break;
         }
-        break;
-      }
-      case ColumnType::Float64: {
-        col.float64_data = std::make_unique<std::vector<double>>(batch.size(), 0.0);
-        for (std::size_t r = 0; r < batch.size(); ++r) {
-          std::string cell = (col_idx < batch[r].size()) ? batch[r][col_idx] : "";
-          if (opts.trim) trimString(cell);
-          if (isNullValue(cell, opts.null_values)) {
-            (*col.null_mask)[r] = 1;
-            continue;
+        case ColumnType::Float64: {
+          col.float64_data = std::make_unique<std::vector<double>>(batch.rows(), 0.0);
+          for (std::size_t r = 0; r < batch.rows(); ++r) {
+            std::string_view cell = cellAt(batch, r, col_idx, opts.trim, features);
+            if (nulls.match(cell.data(), cell.size())) {
+              (*col.null_mask)[r] = 1;
+              continue;
+            }
+            cell = numberText(number_format, cell, num_buf);
+            double v;
+            // Inferred columns accept only what inference did: strtod alone also takes
+            // hex, inf and nan, and rounds integers past 2^53, which would hide a
+            // conflict in a later batch.
+            bool plain = !opts.infer_schema ||
+                         (isPlainNumber(cell.data(), cell.data() + cell.size()) &&
+                          !isInexactInDouble(cell.data(), cell.data() + cell.size()));
+            if (plain && parseFloat64(cell.data(), cell.data() + cell.size(), v)) {
+              (*col.float64_data)[r] = v;
+            } else if (opts.infer_schema) {
+              widened = widenOnConflict(col_type, time_format.get(), cell);
+              break;
+            } else {
+              (*col.null_mask)[r] = 1;
+            }
           }
-          double v;
-          if (parseFloat64(cell.data(), cell.data() + cell.size(), v)) {
-            (*col.float64_data)[r] = v;
-          } else {
-            (*col.null_mask)[r] = 1;
+          break;
+        }
+        case ColumnType::Bool: {
+          col.bool_data = std::make_unique<std::vector<std::uint8_t>>(batch.rows(), 0);
+          for (std::size_t r = 0; r < batch.rows(); ++r) {
+            std::string_view cell = cellAt(batch, r, col_idx, opts.trim, features);
+            if (nulls.match(cell.data(), cell.size())) {
+              (*col.null_mask)[r] = 1;
+              continue;
+            }
+            bool v;
+            if (parseBool(cell.data(), cell.data() + cell.size(), v)) {
+              (*col.bool_data)[r] = v ? 1 : 0;
+            } else if (opts.infer_schema) {
+              widened = widenOnConflict(col_type, time_format.get(), cell);
+              break;
+            } else {
+              (*col.null_mask)[r] = 1;
+            }
           }
+          break;
         }
-        break;
-      }
-      case ColumnType::Bool: {
-        col.bool_data = std::make_unique<std::vector<std::uint8_t>>(batch.size(), 0);
-        for (std::size_t r = 0; r < batch.size(); ++r) {
-          std::string cell = (col_idx < batch[r].size()) ? batch[r][col_idx] : "";
-          if (opts.trim) trimString(cell);
-          if (isNullValue(cell, opts.null_values)) {
-            (*col.null_mask)[r] = 1;
-            continue;
+        case ColumnType::Int8:
+          convertNarrowColumn(batch, col_idx, opts, nulls, number_format,
+                              parseIntInRange<std::int8_t>,
+                              col.int8_data, *col.null_mask);
+          break;
+        case ColumnType::Int16:
+          convertNarrowColumn(batch, col_idx, opts, nulls, number_format,
+                              parseIntInRange<std::int16_t>,
+                              col.int16_data, *col.null_mask);
+          break;
+        case ColumnType::UInt8:
+          convertNarrowColumn(batch, col_idx, opts, nulls, number_format,
+                              parseIntInRange<std::uint8_t>,
+                              col.uint8_data, *col.null_mask);
+          break;
+        case ColumnType::UInt16:
+          convertNarrowColumn(batch, col_idx, opts, nulls, number_format,
+                              parseIntInRange<std::uint16_t>,
+                              col.uint16_data, *col.null_mask);
+          break;
+        case ColumnType::UInt32:
+          convertNarrowColumn(batch, col_idx, opts, nulls, number_format,
+                              parseIntInRange<std::uint32_t>,
+                              col.uint32_data, *col.null_mask);
+          break;
+        case ColumnType::Float32:
+          convertNarrowColumn(batch, col_idx, opts, nulls, number_format,
+                              parseFloat32, col.float32_data,
+                              *col.null_mask);
+          break;
+        case ColumnType::Decimal: {
+          auto dt = opts.decimal_types.find(hdr);
+          col.decimal = dt != opts.decimal_types.end() ? dt->second : DecimalType();
+          bool wide = col.decimal.precision > kMaxDecimal64Precision;
+          col.int64_data =
+              std::make_unique<std::vector<std::int64_t>>(batch.rows() * (wide ? 2 : 1), 0);
+          std::int64_t* data = col.int64_data->data();
+          for (std::size_t r = 0; r < batch.rows(); ++r) {
+            std::string_view cell = cellAt(batch, r, col_idx, opts.trim, features);
+            if (nulls.match(cell.data(), cell.size())) {
+              (*col.null_mask)[r] = 1;
+              continue;
+            }
+            cell = numberText(number_format, cell, num_buf);
+            const char* cell_end = cell.data() + cell.size();
+            std::int64_t v = 0, hi = 0;
+            std::uint64_t lo = 0;
+            bool ok = wide ? parseDecimal128(cell.data(), cell_end, col.decimal, lo, hi)
+                           : parseDecimal64(cell.data(), cell_end, col.decimal, v);
+            if (!ok) {
+              (*col.null_mask)[r] = 1;
+            } else if (wide) {
+              data[2 * r] = static_cast<std::int64_t>(lo);
+              data[2 * r + 1] = hi;
+            } else {
+              data[r] = v;
+            }
           }
-          bool v;
-          if (parseBool(cell.data(), cell.data() + cell.size(), v)) {
-            (*col.bool_data)[r] = v ? 1 : 0;
-          } else {
-            (*col.null_mask)[r] = 1;
+          break;
+        }
+        case ColumnType::Date32:
+        case ColumnType::TimestampMs:
+        case ColumnType::TimestampUs: {
+          // Date32 -> int32_data, TimestampMs -> float64_data, TimestampUs -> int64_data.
+          if (col_type == ColumnType::Date32)
+            col.int32_data = std::make_unique<std::vector<std::int32_t>>(batch.rows(), 0);
+          else if (col_type == ColumnType::TimestampMs)
+            col.float64_data = std::make_unique<std::vector<double>>(batch.rows(), 0.0);
+          else
+            col.int64_data = std::make_unique<std::vector<std::int64_t>>(batch.rows(), 0);
+          for (std::size_t r = 0; r < batch.rows(); ++r) {
+            std::string_view cell = cellAt(batch, r, col_idx, opts.trim, features);
+            if (nulls.match(cell.data(), cell.size())) {
+              (*col.null_mask)[r] = 1;
+              continue;
+            }
+            std::int64_t v;
+            if (parseTimeCell(col_type, time_format.get(), cell.data(),
+                              cell.data() + cell.size(), opts.infer_schema, v)) {
+              if (col_type == ColumnType::Date32)
+                (*col.int32_data)[r] = static_cast<std::int32_t>(v);
+              else if (col_type == ColumnType::TimestampMs)
+                (*col.float64_data)[r] = static_cast<double>(v);
+              else
+                (*col.int64_data)[r] = v;
+            } else if (opts.infer_schema) {
+              widened = widenOnConflict(col_type, time_format.get(), cell);
+              break;
+            } else {
+              (*col.null_mask)[r] = 1;
+            }
           }
+          break;
         }
-        break;
       }
+      if (widened == col_type) break;
+      col_type = widened;
     }
+    finishColumn(col, batch.rows(), opts);
 
     out.columns[hdr] = std::move(col);
   }
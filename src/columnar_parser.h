@@ -2,17 +2,54 @@
 #define ULTRATAB_COLUMNAR_PARSER_H
 
 #include "csv_parser.h"
+#include "simd_scanner.h"
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 namespace ultratab {
 
-enum class ColumnType { String, Int32, Int64, Float64, Bool };
+class TimeFormat;
+
+/// Date32 is days since the epoch; TimestampMs and TimestampUs are milliseconds and
+/// microseconds since the epoch, UTC. Decimal is a fixed-point value scaled by
+/// 10^scale (see DecimalType). Int8 through Float32 are narrow storage for explicit
+/// schemas; a value outside the type's range is a parse failure.
+enum class ColumnType {
+  String, Int32, Int64, Float64, Bool, Date32, TimestampMs, TimestampUs, Decimal,
+  Int8, Int16, UInt8, UInt16, UInt32, Float32
+};
+
+/// decimal(precision, scale). Up to kMaxDecimal64Precision digits the column is one int64
+/// per row; above that (up to 38) it is 128-bit, two int64 per row, low word first.
+struct DecimalType {
+  unsigned precision = 18;
+  unsigned scale = 0;
+};
+
+constexpr unsigned kMaxDecimal64Precision = 18;
+constexpr unsigned kMaxDecimalPrecision = 38;
+
+/// Per-column layout of number text, applied before the numeric column types parse it:
+/// a leading or trailing currency symbol and a trailing '%' are stripped (the value is
+/// kept as written, so "12.5%" is 12.5), grouping separators are dropped from the
+/// integer part, which must then be in groups of three, and \a decimal reads as '.'.
+struct NumberFormat {
+  char decimal = '.';
+  /// Empty for none; may be multi-byte, such as a UTF-8 no-break space.
+  std::string grouping;
+  std::string currency;
+  bool percent = false;
+};
+
+/// Longest number text normalizeNumber writes.
+constexpr std::size_t kMaxNumberText = 128;
 
 enum class TypedFallback { String, Null };
 
@@ -23,19 +60,50 @@ struct ColumnarOptions {
   std::size_t batch_size = 10000;
   std::vector<std::string> select;   // empty = all columns
   std::unordered_map<std::string, ColumnType> schema;
+  /// Per-column TimeFormat pattern for Date32/Timestamp columns; others parse ISO-8601.
+  std::unordered_map<std::string, std::string> time_formats;
+  /// Precision and scale of each Decimal column in schema.
+  std::unordered_map<std::string, DecimalType> decimal_types;
+  /// Per-column NumberFormat for the integer, float and Decimal types.
+  std::unordered_map<std::string, NumberFormat> number_formats;
   std::vector<std::string> null_values{"", "null", "NULL"};
   bool trim = false;
   TypedFallback typed_fallback = TypedFallback::Null;
+  TokenizerEngine engine = TokenizerEngine::Auto;
+  /// schema: "infer". The schema is filled from the first infer_rows data rows, and a
+  /// later value that does not fit its column widens the column instead of becoming null.
+  bool infer_schema = false;
+  std::size_t infer_rows = 1000;
+  /// Arrow layout: null_mask becomes a validity bitmap and Bool columns are bit-packed.
+  bool bit_packed = false;
+  /// Drop null_mask from columns with no nulls in the batch (null_count is still set).
+  bool omit_empty_null_mask = false;
 };
 
 struct ColumnarColumn {
   ColumnType type = ColumnType::String;
   std::vector<std::string> strings;
+  /// Int32 and Date32.
   std::unique_ptr<std::vector<std::int32_t>> int32_data;
+  /// Int64, TimestampUs and Decimal (two entries per row above 18 digits).
   std::unique_ptr<std::vector<std::int64_t>> int64_data;
+  /// Float64 and TimestampMs (whole milliseconds, exact up to 2^53).
   std::unique_ptr<std::vector<double>> float64_data;
+  /// One byte per row, or with bit_packed one bit per row, LSB first.
   std::unique_ptr<std::vector<std::uint8_t>> bool_data;
+  std::unique_ptr<std::vector<std::int8_t>> int8_data;
+  std::unique_ptr<std::vector<std::int16_t>> int16_data;
+  std::unique_ptr<std::vector<std::uint8_t>> uint8_data;
+  std::unique_ptr<std::vector<std::uint16_t>> uint16_data;
+  std::unique_ptr<std::vector<std::uint32_t>> uint32_data;
+  std::unique_ptr<std::vector<float>> float32_data;
+  /// One byte per row, 1 = null. With bit_packed, an Arrow validity bitmap instead:
+  /// (rows + 7) / 8 bytes, bit r % 8 of byte r / 8 set when row r is valid.
   std::unique_ptr<std::vector<std::uint8_t>> null_mask;
+  /// Null rows in this column; 0 for String columns.
+  std::size_t null_count = 0;
+  /// Decimal columns only.
+  DecimalType decimal;
 };
 
 struct ColumnarBatch {
@@ -44,16 +112,79 @@ struct ColumnarBatch {
   std::size_t rows = 0;
 };
 
+/// A batch's cells as views into storage the caller keeps alive (a slice arena, or the
+/// strings of a Batch): row r is cells[row_start[r], row_start[r + 1]).
+struct CellViews {
+  std::vector<std::string_view> cells;
+  std::vector<std::size_t> row_start{0};
+
+  std::size_t rows() const { return row_start.size() - 1; }
+};
+
 /// Convert row-based batch to columnar. Headers must match row column count.
 void rowsToColumnar(const Batch& batch, const std::vector<std::string>& headers,
                     const ColumnarOptions& opts, ColumnarBatch& out);
 
+/// Pack n bytes of 0/1 into an LSB-first bitmap of (n + 7) / 8 bytes, 64 rows per step;
+/// with invert each bit is set for a 0 byte (null mask to validity). Returns the number
+/// of 1 bytes.
+std::size_t packBits(const std::uint8_t* bytes, std::size_t n, bool invert, std::uint8_t* out);
+
 /// Check if string is null per null_values.
 bool isNullValue(const std::string& s, const std::vector<std::string>& null_values);
 
+/// null_values compiled once for matching (ptr, len) cells. Tokens are bucketed by
+/// length and a 64-bit mask records which lengths occur, so most cells are rejected by
+/// one bit test; whether the empty cell is null is decided up front and needs no compare.
+class NullMatcher {
+ public:
+  explicit NullMatcher(const std::vector<std::string>& null_values);
+
+  bool match(const char* data, std::size_t len) const {
+    if (len == 0) return empty_is_null_;
+    std::size_t bucket = len < kLongBucket ? len : kLongBucket;
+    if (((length_mask_ >> bucket) & 1) == 0) return false;
+    for (const std::string& token : buckets_[bucket]) {
+      if (token.size() == len && std::memcmp(token.data(), data, len) == 0) return true;
+    }
+    return false;
+  }
+
+ private:
+  /// Tokens of this many bytes or more share the last bucket.
+  static constexpr std::size_t kLongBucket = 63;
+  std::uint64_t length_mask_ = 0;
+  bool empty_is_null_ = false;
+  std::vector<std::string> buckets_[kLongBucket + 1];
+};
+
+/// rowsToColumnar with opts.null_values already compiled, for callers that convert many
+/// batches under the same options.
+void rowsToColumnar(const Batch& batch, const std::vector<std::string>& headers,
+                    const ColumnarOptions& opts, const NullMatcher& nulls,
+                    ColumnarBatch& out);
+
+/// rowsToColumnar over views, so cells reach the conversion without being copied; only
+/// String columns copy their values out.
+void rowsToColumnar(const CellViews& batch, const std::vector<std::string>& headers,
+                    const ColumnarOptions& opts, const NullMatcher& nulls,
+                    ColumnarBatch& out);
+
 /// Trim leading/trailing whitespace in place.
 void trimString(std::string& s);
 
+/// Narrow [start, end) past leading and trailing whitespace without copying. A cell that
+/// neither starts nor ends with whitespace costs two compares; long padding is skipped
+/// 16 bytes at a time when \a features has SSE2.
+void trimSlice(const char*& start, const char*& end, const CpuFeatures& features);
+
+/// trimSlice with the detected CPU features.
+void trimSlice(const char*& start, const char*& end);
+
+/// Features trimSlice runs with under \a engine: none for Dfa, which uses no SIMD, else
+/// the detected ones.
+const CpuFeatures& trimFeatures(TokenizerEngine engine);
+
 /// Fast parseInt32. Returns true on success. No locale.
 bool parseInt32(const char* start, const char* end, std::int32_t& out);
 
@@ -63,9 +194,45 @@ bool parseInt64(const char* start, const char* end, std::int64_t& out);
 /// Fast parseDouble. Returns true on success. Handles sign, decimal, exponent.
 bool parseFloat64(const char* start, const char* end, double& out);
 
+/// parseInt64 limited to [T's min, T's max], for the narrow integer column types.
+template <typename T>
+bool parseIntInRange(const char* start, const char* end, T& out);
+
+/// parseFloat64, failing for values beyond float's finite range.
+bool parseFloat32(const char* start, const char* end, float& out);
+
+/// Decimal text ("-12345.67") to an integer scaled by 10^scale, for precision up to 18.
+/// Fails on more than precision digits or nonzero digits past scale; no exponent, no locale.
+bool parseDecimal64(const char* start, const char* end, DecimalType type, std::int64_t& out);
+
+/// parseDecimal64 for precision up to 38: a two's-complement 128-bit result in two words.
+bool parseDecimal128(const char* start, const char* end, DecimalType type, std::uint64_t& lo,
+                     std::int64_t& hi);
+
+/// Rewrite [start, end) from \a format's layout to plain "-1234.56" text in out, which
+/// holds kMaxNumberText bytes; \a len receives the length. Fails on text the format does
+/// not describe, such as a '.' in a decimal-comma column without '.' grouping.
+bool normalizeNumber(const char* start, const char* end, const NumberFormat& format,
+                     char* out, std::size_t& len);
+
 /// Fast parseBool. Accepts "true","false","1","0" (case-insensitive).
 bool parseBool(const char* start, const char* end, bool& out);
 
+/// Narrowest type that holds the value: Int32, Int64, Float64, Bool ("true"/"false";
+/// "1"/"0" infer as Int32), Date32 (ISO date), TimestampMs (ISO-8601 / RFC-3339 with at
+/// most millisecond digits), TimestampUs, else String. Only plain decimal text infers as
+/// a number. With \a time_format (the column's timeFormats pattern; null for none) times
+/// are read through it instead of as ISO-8601, as the column will be converted.
+ColumnType inferValueType(const TimeFormat* time_format, const char* start, const char* end);
+
+/// Type of a column inferred as \a current once it also holds the value. Numbers widen
+/// Int32 -> Int64 or Int32 -> Float64 and times Date32 -> TimestampMs -> TimestampUs;
+/// anything else that does not fit widens to String. An Int64 column meeting a float, or
+/// a Float64 column meeting an integer beyond 2^53, also widens to String, so no integer
+/// is rounded.
+ColumnType widenColumnType(ColumnType current, const TimeFormat* time_format,
+                           const char* start, const char* end);
+
 }  // namespace ultratab
 
 #endif  // ULTRATAB_COLUMNAR_PARSER_H
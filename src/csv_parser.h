@@ -8,12 +8,19 @@
 
 namespace ultratab {
 
+/// Tokenizer engine for SliceCsvParser.
+/// Auto: SIMD scanners when compiled in and supported by the CPU, else Dfa.
+/// Simd: quote-free bitmask kernel + scanner-assisted state machine.
+/// Dfa: table-driven branchless state machine; no SIMD dependency.
+enum class TokenizerEngine { Auto, Simd, Dfa };
+
 /// Options for CSV parsing (RFC-style).
 struct CsvOptions {
   char delimiter = ',';
   char quote = '"';
   bool has_header = false;
   std::size_t batch_size = 10000;
+  TokenizerEngine engine = TokenizerEngine::Auto;
 };
 
 /// Single row: vector of field strings.
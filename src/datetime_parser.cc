@@ -0,0 +1,280 @@
+#include "datetime_parser.h"
+
+namespace ultratab {
+
+namespace {
+
+const std::int64_t kMicrosPerSecond = 1000000;
+const std::int64_t kSecondsPerDay = 86400;
+
+const char* const kMonthNames[12] = {"january", "february", "march",     "april",
+                                     "may",     "june",     "july",      "august",
+                                     "september", "october", "november", "december"};
+
+inline unsigned digitAt(const char* p) {
+  return static_cast<unsigned>(static_cast<unsigned char>(*p)) - '0';
+}
+
+inline char lower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c; }
+
+bool isLeapYear(std::int64_t y) { return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0; }
+
+unsigned daysInMonth(std::int64_t y, unsigned m) {
+  static const unsigned kDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  return m == 2 && isLeapYear(y) ? 29 : kDays[m - 1];
+}
+
+bool validDate(std::int64_t y, unsigned m, unsigned d) {
+  return m >= 1 && m <= 12 && d >= 1 && d <= daysInMonth(y, m);
+}
+
+bool validTime(unsigned h, unsigned mi, unsigned s) { return h <= 23 && mi <= 59 && s <= 60; }
+
+// "YYYY-MM-DD" at p (10 bytes, caller checks length). Every digit and both dashes are
+// tested with one combined compare, so valid input takes a single branch.
+bool parseDateFields(const char* p, std::int64_t& y, unsigned& m, unsigned& d) {
+  unsigned d0 = digitAt(p), d1 = digitAt(p + 1), d2 = digitAt(p + 2), d3 = digitAt(p + 3);
+  unsigned m0 = digitAt(p + 5), m1 = digitAt(p + 6);
+  unsigned a0 = digitAt(p + 8), a1 = digitAt(p + 9);
+  unsigned bad = (d0 > 9) | (d1 > 9) | (d2 > 9) | (d3 > 9) | (m0 > 9) | (m1 > 9) |
+                 (a0 > 9) | (a1 > 9) | (p[4] != '-') | (p[7] != '-');
+  if (bad) return false;
+  y = d0 * 1000 + d1 * 100 + d2 * 10 + d3;
+  m = m0 * 10 + m1;
+  d = a0 * 10 + a1;
+  return validDate(y, m, d);
+}
+
+// Two digits at p; the caller checks there are two bytes.
+bool twoDigits(const char* p, unsigned& out) {
+  unsigned hi = digitAt(p), lo = digitAt(p + 1);
+  if ((hi > 9) | (lo > 9)) return false;
+  out = hi * 10 + lo;
+  return true;
+}
+
+// Between min and max digits from p; advances p.
+bool readDigits(const char*& p, const char* end, int min, int max, unsigned& out) {
+  unsigned v = 0;
+  int n = 0;
+  while (n < max && p < end && digitAt(p) <= 9) {
+    v = v * 10 + digitAt(p);
+    ++p;
+    ++n;
+  }
+  out = v;
+  return n >= min;
+}
+
+// Fraction digits after the separator, truncated to microseconds; advances p.
+bool readFraction(const char*& p, const char* end, std::int64_t& micros) {
+  std::int64_t v = 0;
+  int n = 0;
+  while (p < end && digitAt(p) <= 9) {
+    if (n < 6) v = v * 10 + digitAt(p);
+    ++p;
+    ++n;
+  }
+  if (n == 0 || n > 9) return false;
+  for (int i = n; i < 6; ++i) v *= 10;
+  micros = v;
+  return true;
+}
+
+// 'Z' or +HH[:MM] / +HHMM / +HH; advances p. Offset in seconds east of UTC.
+bool readOffset(const char*& p, const char* end, std::int64_t& seconds) {
+  if (p < end && (*p == 'Z' || *p == 'z')) {
+    ++p;
+    seconds = 0;
+    return true;
+  }
+  if (p >= end || (*p != '+' && *p != '-')) return false;
+  bool neg = *p == '-';
+  ++p;
+  unsigned h = 0, m = 0;
+  if (end - p < 2 || !twoDigits(p, h)) return false;
+  p += 2;
+  if (p < end && *p == ':') {
+    ++p;
+    if (end - p < 2 || !twoDigits(p, m)) return false;
+    p += 2;
+  } else if (end - p >= 2 && digitAt(p) <= 9) {
+    if (!twoDigits(p, m)) return false;
+    p += 2;
+  }
+  if (h > 23 || m > 59) return false;
+  seconds = (static_cast<std::int64_t>(h) * 3600 + m * 60) * (neg ? -1 : 1);
+  return true;
+}
+
+std::int64_t toMicros(std::int64_t days, unsigned h, unsigned mi, unsigned s,
+                      std::int64_t frac_micros, std::int64_t offset_seconds) {
+  std::int64_t secs = days * kSecondsPerDay + h * 3600 + mi * 60 + s - offset_seconds;
+  return secs * kMicrosPerSecond + frac_micros;
+}
+
+}  // namespace
+
+std::int64_t daysFromCivil(std::int64_t year, unsigned month, unsigned day) {
+  // Howard Hinnant's days_from_civil: years start in March, so leap days end a year.
+  std::int64_t y = year - (month <= 2 ? 1 : 0);
+  std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+  std::int64_t yoe = y - era * 400;
+  std::int64_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  std::int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+bool parseIsoDate(const char* start, const char* end, std::int32_t& days) {
+  if (end - start != 10) return false;
+  std::int64_t y;
+  unsigned m, d;
+  if (!parseDateFields(start, y, m, d)) return false;
+  days = static_cast<std::int32_t>(daysFromCivil(y, m, d));
+  return true;
+}
+
+bool parseIsoTimestamp(const char* start, const char* end, std::int64_t& micros) {
+  if (end - start < 10) return false;
+  std::int64_t y;
+  unsigned mo, d;
+  if (!parseDateFields(start, y, mo, d)) return false;
+  std::int64_t days = daysFromCivil(y, mo, d);
+  const char* p = start + 10;
+  if (p == end) {
+    micros = days * kSecondsPerDay * kMicrosPerSecond;
+    return true;
+  }
+  if (*p != 'T' && *p != 't' && *p != ' ') return false;
+  ++p;
+  unsigned h = 0, mi = 0, s = 0;
+  if (end - p < 5 || !twoDigits(p, h) || p[2] != ':' || !twoDigits(p + 3, mi)) return false;
+  p += 5;
+  std::int64_t frac = 0;
+  if (p < end && *p == ':') {
+    ++p;
+    if (end - p < 2 || !twoDigits(p, s)) return false;
+    p += 2;
+    if (p < end && (*p == '.' || *p == ',')) {
+      ++p;
+      if (!readFraction(p, end, frac)) return false;
+    }
+  }
+  std::int64_t offset = 0;
+  if (p < end && !readOffset(p, end, offset)) return false;
+  if (p != end || !validTime(h, mi, s)) return false;
+  micros = toMicros(days, h, mi, s, frac, offset);
+  return true;
+}
+
+TimeFormat::TimeFormat(const std::string& pattern) {
+  for (std::size_t i = 0; i < pattern.size(); ++i) {
+    char c = pattern[i];
+    if (c != '%') {
+      tokens_.push_back({0, c});
+      continue;
+    }
+    if (++i == pattern.size()) {
+      valid_ = false;
+      break;
+    }
+    char spec = pattern[i];
+    switch (spec) {
+      case 'Y': case 'y': case 'm': case 'd': case 'H': case 'I': case 'M':
+      case 'S': case 'f': case 'b': case 'p': case 'z':
+        tokens_.push_back({spec, 0});
+        break;
+      case '%':
+        tokens_.push_back({0, '%'});
+        break;
+      default:
+        valid_ = false;
+        break;
+    }
+  }
+}
+
+bool TimeFormat::parse(const char* start, const char* end, std::int64_t& micros) const {
+  if (!valid_) return false;
+  const char* p = start;
+  std::int64_t year = 1970;
+  unsigned month = 1, day = 1, hour = 0, minute = 0, second = 0, v = 0;
+  std::int64_t frac = 0, offset = 0;
+  int pm = -1;
+  bool hour12 = false;
+  for (const Token& t : tokens_) {
+    switch (t.directive) {
+      case 0:
+        if (p >= end || *p != t.literal) return false;
+        ++p;
+        break;
+      case 'Y':
+        if (!readDigits(p, end, 4, 4, v)) return false;
+        year = v;
+        break;
+      case 'y':
+        if (!readDigits(p, end, 2, 2, v)) return false;
+        year = v >= 69 ? 1900 + v : 2000 + v;
+        break;
+      case 'm':
+        if (!readDigits(p, end, 1, 2, month)) return false;
+        break;
+      case 'd':
+        if (!readDigits(p, end, 1, 2, day)) return false;
+        break;
+      case 'H':
+        if (!readDigits(p, end, 1, 2, hour)) return false;
+        break;
+      case 'I':
+        if (!readDigits(p, end, 1, 2, hour) || hour < 1 || hour > 12) return false;
+        hour12 = true;
+        break;
+      case 'M':
+        if (!readDigits(p, end, 1, 2, minute)) return false;
+        break;
+      case 'S':
+        if (!readDigits(p, end, 1, 2, second)) return false;
+        break;
+      case 'f':
+        if (!readFraction(p, end, frac)) return false;
+        break;
+      case 'b': {
+        if (end - p < 3) return false;
+        month = 0;
+        for (unsigned i = 0; i < 12 && month == 0; ++i) {
+          const char* name = kMonthNames[i];
+          if (lower(p[0]) == name[0] && lower(p[1]) == name[1] && lower(p[2]) == name[2])
+            month = i + 1;
+        }
+        if (month == 0) return false;
+        p += 3;
+        // The full name is accepted too.
+        const char* rest = kMonthNames[month - 1] + 3;
+        const char* q = p;
+        while (*rest && q < end && lower(*q) == *rest) {
+          ++q;
+          ++rest;
+        }
+        if (*rest == 0) p = q;
+        break;
+      }
+      case 'p':
+        if (end - p < 2 || lower(p[1]) != 'm') return false;
+        if (lower(p[0]) == 'a') pm = 0;
+        else if (lower(p[0]) == 'p') pm = 1;
+        else return false;
+        p += 2;
+        break;
+      case 'z':
+        if (!readOffset(p, end, offset)) return false;
+        break;
+    }
+  }
+  if (p != end) return false;
+  if (hour12) hour = hour % 12 + (pm == 1 ? 12 : 0);
+  if (!validDate(year, month, day) || !validTime(hour, minute, second)) return false;
+  micros = toMicros(daysFromCivil(year, month, day), hour, minute, second, frac, offset);
+  return true;
+}
+
+}  // namespace ultratab
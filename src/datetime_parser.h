@@ -0,0 +1,50 @@
+#ifndef ULTRATAB_DATETIME_PARSER_H
+#define ULTRATAB_DATETIME_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ultratab {
+
+/// Days from 1970-01-01 to a proleptic Gregorian date (month 1-12, day 1-31).
+std::int64_t daysFromCivil(std::int64_t year, unsigned month, unsigned day);
+
+/// ISO-8601 calendar date "YYYY-MM-DD" to days since the epoch. No locale.
+bool parseIsoDate(const char* start, const char* end, std::int32_t& days);
+
+/// ISO-8601 / RFC-3339 timestamp to microseconds since the epoch: a date, optionally
+/// followed by 'T' or ' ' and HH:MM[:SS[.fraction]], then an optional 'Z' or
+/// +HH[:MM] / +HHMM offset. Without an offset the time is taken as UTC; fraction digits
+/// past microseconds are truncated.
+bool parseIsoTimestamp(const char* start, const char* end, std::int64_t& micros);
+
+/// strptime-like pattern, compiled once per column. Directives: %Y (4 digits), %y
+/// (2 digits, 69-99 -> 19xx), %m %d %H %I %M %S (1-2 digits), %f (fraction, 1-9
+/// digits), %b (month name, first three letters, any case), %p (AM/PM, with %I),
+/// %z (Z or +HH[:MM] / +HHMM) and %%. Other characters must match exactly. Fields the
+/// pattern leaves out default to 1970-01-01 00:00:00 UTC.
+class TimeFormat {
+ public:
+  explicit TimeFormat(const std::string& pattern);
+
+  /// False when the pattern has an unknown directive; parse() then always fails.
+  bool valid() const { return valid_; }
+
+  /// Parse the whole of [start, end) to microseconds since the epoch.
+  bool parse(const char* start, const char* end, std::int64_t& micros) const;
+
+ private:
+  /// A directive letter, or 0 for the literal character.
+  struct Token {
+    char directive;
+    char literal;
+  };
+  std::vector<Token> tokens_;
+  bool valid_ = true;
+};
+
+}  // namespace ultratab
+
+#endif  // ULTRATAB_DATETIME_PARSER_H
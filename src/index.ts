@@ -5,12 +5,19 @@ module.exports = {
   csv: lib.csv,
   csvColumns: lib.csvColumns,
   xlsx: lib.xlsx,
+  metrics: lib.metrics,
   getParserMetrics: lib.getParserMetrics,
   getColumnarParserMetrics: lib.getColumnarParserMetrics,
+  getXlsxParserMetrics: lib.getXlsxParserMetrics,
+  getParserTrace: lib.getParserTrace,
+  getColumnarParserTrace: lib.getColumnarParserTrace,
   createParser: lib.createParser,
   getNextBatch: lib.getNextBatch,
   destroyParser: lib.destroyParser,
   createColumnarParser: lib.createColumnarParser,
   getNextColumnarBatch: lib.getNextColumnarBatch,
   destroyColumnarParser: lib.destroyColumnarParser,
+  createXlsxParser: lib.createXlsxParser,
+  getNextXlsxBatch: lib.getNextXlsxBatch,
+  destroyXlsxParser: lib.destroyXlsxParser,
 };
@@ -0,0 +1,97 @@
+#include "latency_histogram.h"
+#include "simd_scanner.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace ultratab {
+
+namespace {
+
+/// Busy-wait used to measure the TSC rate against steady_clock.
+const std::chrono::microseconds kCalibrationSpan(2000);
+
+inline unsigned clz64(std::uint64_t x) {
+#if defined(_MSC_VER)
+  unsigned long idx;
+  return _BitScanReverse64(&idx, x) ? 63 - idx : 64;
+#else
+  return x ? static_cast<unsigned>(__builtin_clzll(x)) : 64u;
+#endif
+}
+
+}  // namespace
+
+const CycleClock::Calibration& CycleClock::calibration() {
+  static const Calibration cal = [] {
+    Calibration c;
+#ifdef ULTRATAB_HAVE_RDTSC
+    if (!detectCpuFeatures().invariant_tsc) return c;
+    auto t0 = std::chrono::steady_clock::now();
+    std::uint64_t c0 = ULTRATAB_RDTSC();
+    auto t1 = t0;
+    while (t1 - t0 < kCalibrationSpan) t1 = std::chrono::steady_clock::now();
+    std::uint64_t c1 = ULTRATAB_RDTSC();
+    if (c1 <= c0) return c;
+    double ns = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    c.use_tsc = true;
+    c.ns_per_tick = ns / static_cast<double>(c1 - c0);
+#endif
+    return c;
+  }();
+  return cal;
+}
+
+std::size_t LatencyHistogram::bucketIndex(std::uint64_t v) {
+  const std::uint64_t sub_count = std::uint64_t{1} << kSubBucketBits;
+  if (v < sub_count) return static_cast<std::size_t>(v);
+  unsigned msb = 63 - clz64(v);
+  unsigned shift = msb - kSubBucketBits;
+  std::size_t sub = static_cast<std::size_t>((v >> shift) - sub_count);
+  return (static_cast<std::size_t>(shift + 1) << kSubBucketBits) + sub;
+}
+
+std::uint64_t LatencyHistogram::bucketUpperBound(std::size_t index) {
+  const std::size_t sub_count = std::size_t{1} << kSubBucketBits;
+  if (index < sub_count) return index;
+  unsigned shift = static_cast<unsigned>((index >> kSubBucketBits) - 1);
+  std::uint64_t lower = static_cast<std::uint64_t>(sub_count + (index & (sub_count - 1))) << shift;
+  return lower + ((std::uint64_t{1} << shift) - 1);
+}
+
+void LatencyHistogram::record(std::uint64_t ns) {
+  buckets_[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  std::uint64_t prev = max_.load(std::memory_order_relaxed);
+  while (ns > prev && !max_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+  }
+}
+
+std::uint64_t LatencyHistogram::percentile(double q) const {
+  std::uint64_t total = count();
+  if (total == 0) return 0;
+  if (q < 0) q = 0;
+  if (q > 1) q = 1;
+  std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(total) + 0.5);
+  if (rank == 0) rank = 1;
+  std::uint64_t seen = 0;
+  std::uint64_t hi = max();
+  for (std::size_t i = 0; i < kBucketCount; ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      std::uint64_t bound = bucketUpperBound(i);
+      return bound < hi ? bound : hi;
+    }
+  }
+  return hi;
+}
+
+void LatencyHistogram::reset() {
+  for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+  count_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace ultratab
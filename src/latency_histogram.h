@@ -0,0 +1,81 @@
+#ifndef ULTRATAB_LATENCY_HISTOGRAM_H
+#define ULTRATAB_LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ULTRATAB_HAVE_RDTSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define ULTRATAB_RDTSC() __rdtsc()
+#else
+// Builtin rather than <x86intrin.h>, which pulls in the SIMD headers on every platform.
+#define ULTRATAB_RDTSC() __builtin_ia32_rdtsc()
+#endif
+#endif
+
+namespace ultratab {
+
+/// Cheap timestamps for per-batch timing: the TSC on x86 CPUs with an invariant TSC
+/// (calibrated against steady_clock once per process), steady_clock nanoseconds elsewhere.
+class CycleClock {
+ public:
+  static std::uint64_t now() {
+#ifdef ULTRATAB_HAVE_RDTSC
+    if (calibration().use_tsc) return ULTRATAB_RDTSC();
+#endif
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
+  /// Convert a difference of now() values to nanoseconds.
+  static std::uint64_t toNs(std::uint64_t ticks) {
+    const Calibration& c = calibration();
+    return c.use_tsc ? static_cast<std::uint64_t>(static_cast<double>(ticks) * c.ns_per_tick)
+                     : ticks;
+  }
+
+  /// Nanoseconds elapsed since \a start (a now() value).
+  static std::uint64_t elapsedNs(std::uint64_t start) { return toNs(now() - start); }
+
+ private:
+  struct Calibration {
+    bool use_tsc = false;
+    double ns_per_tick = 1.0;
+  };
+  static const Calibration& calibration();
+};
+
+/// Lock-free log-bucketed latency histogram (HDR-style): 8 linear sub-buckets per power
+/// of two, so any recorded value is reported within 12.5%. record() is two relaxed
+/// increments plus a compare-exchange only when a new maximum is seen.
+class LatencyHistogram {
+ public:
+  static constexpr unsigned kSubBucketBits = 3;
+  static constexpr std::size_t kBucketCount = (64 - kSubBucketBits + 1) << kSubBucketBits;
+
+  void record(std::uint64_t ns);
+
+  std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  std::uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+  /// Upper bound of the bucket holding quantile \a q (0..1), capped at max(); 0 when empty.
+  std::uint64_t percentile(double q) const;
+
+  void reset();
+
+ private:
+  static std::size_t bucketIndex(std::uint64_t v);
+  static std::uint64_t bucketUpperBound(std::size_t index);
+
+  std::atomic<std::uint64_t> buckets_[kBucketCount]{};
+  std::atomic<std::uint64_t> count_{0};
+  std::atomic<std::uint64_t> max_{0};
+};
+
+}  // namespace ultratab
+
+#endif  // ULTRATAB_LATENCY_HISTOGRAM_H
@@ -39,18 +39,85 @@ interface CsvOptions {
   maxQueueBatches?: number;
   useMmap?: boolean;
   readBufferSize?: number;
+  engine?: "auto" | "simd" | "dfa";
+  pooled?: boolean;
+  trace?: boolean | number;
+  perfCounters?: boolean;
+  batchInfo?: boolean;
+  rowOffsets?: boolean;
 }
 
+type ColumnTypeName =
+  | "string"
+  | "int32"
+  | "int64"
+  | "float64"
+  | "bool"
+  | "int8"
+  | "int16"
+  | "uint8"
+  | "uint16"
+  | "uint32"
+  | "float32"
+  | "date32"
+  | "timestamp"
+  | "timestamp[ms]"
+  | "timestamp[us]"
+  | `decimal(${number},${number})`
+  | `decimal(${number})`;
+
+type ColumnData =
+  | string[]
+  | Int32Array
+  | BigInt64Array
+  | Float64Array
+  | Uint8Array
+  | Int8Array
+  | Int16Array
+  | Uint16Array
+  | Uint32Array
+  | Float32Array;
+
 interface CsvColumnsOptions {
   delimiter?: string;
   quote?: string;
   headers?: boolean;
   batchSize?: number;
+  maxQueueBatches?: number;
+  useMmap?: boolean;
+  readBufferSize?: number;
   select?: string[];
-  schema?: Record<string, "string" | "int32" | "int64" | "float64" | "bool">;
+  schema?: Record<string, ColumnTypeName> | "infer";
+  inferRows?: number;
+  timeFormats?: Record<string, string>;
+  numberFormats?: Record<string, NumberFormat>;
   nullValues?: string[];
   trim?: boolean;
   typedFallback?: "string" | "null";
+  bitPacked?: boolean;
+  omitEmptyNullMask?: boolean;
+  engine?: "auto" | "simd" | "dfa";
+  trace?: boolean | number;
+  perfCounters?: boolean;
+  batchInfo?: boolean;
+  rowOffsets?: boolean;
+}
+
+interface NumberFormat {
+  decimal?: string;
+  grouping?: string;
+  currency?: string;
+  percent?: boolean;
+}
+
+interface BatchInfo {
+  index: number;
+  firstRow: number;
+  byteStart: number;
+  byteEnd: number;
+  tokenizeNs: number;
+  buildNs: number;
+  rowOffsets?: Float64Array;
 }
 
 interface XlsxOptions {
@@ -58,13 +125,17 @@ interface XlsxOptions {
   headers?: boolean;
   batchSize?: number;
   select?: string[];
-  schema?: Record<string, "string" | "int32" | "int64" | "float64" | "bool">;
+  schema?: Record<string, ColumnTypeName>;
+  timeFormats?: Record<string, string>;
+  numberFormats?: Record<string, NumberFormat>;
   nullValues?: string[];
   trim?: boolean;
   typedFallback?: "string" | "null";
+  bitPacked?: boolean;
+  omitEmptyNullMask?: boolean;
 }
 
-function csv(filePath: string, options?: CsvOptions): AsyncIterable<string[][]> {
+function csv(filePath: string, options?: CsvOptions): AsyncIterable<string[][] & { meta?: BatchInfo }> {
   if (typeof filePath !== "string") {
     throw new TypeError("csv(): path must be a string");
   }
@@ -88,7 +159,7 @@ function csv(filePath: string, options?: CsvOptions): AsyncIterable<string[][]>
           if (destroyed) {
             return { value: undefined, done: true };
           }
-          const value = await addon.getNextBatch(parser) as string[][] | undefined;
+          const value = await addon.getNextBatch(parser) as (string[][] & { meta?: BatchInfo }) | undefined;
           if (value === undefined) {
             destroy();
             return { value: undefined, done: true };
@@ -106,9 +177,11 @@ function csv(filePath: string, options?: CsvOptions): AsyncIterable<string[][]>
 
 function csvColumns(filePath: string, options?: CsvColumnsOptions): AsyncIterable<{
   headers: string[];
-  columns: Record<string, string[] | Int32Array | BigInt64Array | Float64Array | Uint8Array>;
+  columns: Record<string, ColumnData>;
   nullMask?: Record<string, Uint8Array>;
+  nullCount?: Record<string, number>;
   rows: number;
+  meta?: BatchInfo;
 }> {
   if (typeof filePath !== "string") {
     throw new TypeError("csvColumns(): path must be a string");
@@ -133,7 +206,7 @@ function csvColumns(filePath: string, options?: CsvColumnsOptions): AsyncIterabl
           if (destroyed) {
             return { value: undefined, done: true };
           }
-          const value = await addon.getNextColumnarBatch(parser) as { headers: string[]; columns: Record<string, string[] | Int32Array | BigInt64Array | Float64Array | Uint8Array>; nullMask?: Record<string, Uint8Array>; rows: number } | undefined;
+          const value = await addon.getNextColumnarBatch(parser) as { headers: string[]; columns: Record<string, ColumnData>; nullMask?: Record<string, Uint8Array>; nullCount?: Record<string, number>; rows: number; meta?: BatchInfo } | undefined;
           if (value === undefined) {
             destroy();
             return { value: undefined, done: true };
@@ -151,9 +224,10 @@ function csvColumns(filePath: string, options?: CsvColumnsOptions): AsyncIterabl
 
 function xlsx(filePath: string, options?: XlsxOptions): AsyncIterable<{
   headers: string[];
-  rows: string[][] | Record<string, string[] | Int32Array | BigInt64Array | Float64Array | Uint8Array>;
+  rows: string[][] | Record<string, ColumnData>;
   rowsCount: number;
   nullMask?: Record<string, Uint8Array>;
+  nullCount?: Record<string, number>;
 }> {
   if (typeof filePath !== "string") {
     throw new TypeError("xlsx(): path must be a string");
@@ -178,7 +252,7 @@ function xlsx(filePath: string, options?: XlsxOptions): AsyncIterable<{
           if (destroyed) {
             return { value: undefined, done: true };
           }
-          const value = await addon.getNextXlsxBatch(parser) as { headers: string[]; rows: string[][] | Record<string, string[] | Int32Array | BigInt64Array | Float64Array | Uint8Array>; rowsCount: number; nullMask?: Record<string, Uint8Array> } | undefined;
+          const value = await addon.getNextXlsxBatch(parser) as { headers: string[]; rows: string[][] | Record<string, ColumnData>; rowsCount: number; nullMask?: Record<string, Uint8Array>; nullCount?: Record<string, number> } | undefined;
           if (value === undefined) {
             destroy();
             return { value: undefined, done: true };
@@ -204,16 +278,47 @@ function getColumnarParserMetrics(parser: unknown): Record<string, number> | nul
   return (addon.getColumnarParserMetrics as ((p: unknown) => Record<string, number> | null))?.(parser) ?? null;
 }
 
+interface MetricsOptions {
+  format?: "object" | "openmetrics";
+}
+
+function metrics(options?: MetricsOptions): Record<string, unknown> | string {
+  if (options?.format === "openmetrics") return addon.getOpenMetrics() as string;
+  return addon.getMetricsSnapshot() as Record<string, unknown>;
+}
+
+function getParserTrace(parser: unknown): string | null {
+  if (!parser) return null;
+  return (addon.getParserTrace as ((p: unknown) => string | null))?.(parser) ?? null;
+}
+
+function getColumnarParserTrace(parser: unknown): string | null {
+  if (!parser) return null;
+  return (addon.getColumnarParserTrace as ((p: unknown) => string | null))?.(parser) ?? null;
+}
+
+function getXlsxParserMetrics(parser: unknown): Record<string, number> | null {
+  if (!parser) return null;
+  return (addon.getXlsxParserMetrics as ((p: unknown) => Record<string, number> | null))?.(parser) ?? null;
+}
+
 module.exports = {
   csv,
   csvColumns,
   xlsx,
+  metrics,
   getParserMetrics,
   getColumnarParserMetrics,
+  getXlsxParserMetrics,
+  getParserTrace,
+  getColumnarParserTrace,
   createParser: (p: string, opts?: CsvOptions) => addon.createParser(p, opts),
   getNextBatch: (parser: unknown) => addon.getNextBatch(parser),
   destroyParser: (parser: unknown) => addon.destroyParser(parser),
   createColumnarParser: (p: string, opts?: CsvColumnsOptions) => addon.createColumnarParser(p, opts),
   getNextColumnarBatch: (parser: unknown) => addon.getNextColumnarBatch(parser),
   destroyColumnarParser: (parser: unknown) => addon.destroyColumnarParser(parser),
+  createXlsxParser: (p: string, opts?: XlsxOptions) => addon.createXlsxParser(p, opts),
+  getNextXlsxBatch: (parser: unknown) => addon.getNextXlsxBatch(parser),
+  destroyXlsxParser: (parser: unknown) => addon.destroyXlsxParser(parser),
 };
@@ -0,0 +1,131 @@
+#include "metrics_registry.h"
+#include "arena_pool.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace ultratab {
+
+namespace {
+
+void addCounters(ParserKindTotals& t, const PipelineMetrics& m) {
+  t.bytes_read += m.bytes_read.load();
+  t.rows_parsed += m.rows_parsed.load();
+  t.batches_emitted += m.batches_emitted.load();
+  t.parse_time_ns += m.parse_time_ns.load();
+  t.queue_wait_ns += m.queue_wait_ns.load();
+}
+
+void appendFamily(std::string& out, const char* name, const char* type, const char* help) {
+  out += "# TYPE ";
+  out += name;
+  out += ' ';
+  out += type;
+  out += "\n# HELP ";
+  out += name;
+  out += ' ';
+  out += help;
+  out += '\n';
+}
+
+void appendSample(std::string& out, const char* name, const char* label, const char* value_label,
+                  double value) {
+  char buf[160];
+  if (label) {
+    std::snprintf(buf, sizeof(buf), "%s{%s=\"%s\"} %.15g\n", name, label, value_label, value);
+  } else {
+    std::snprintf(buf, sizeof(buf), "%s %.15g\n", name, value);
+  }
+  out += buf;
+}
+
+/// One family with a sample per parser kind; \a field picks the value.
+template <typename Field>
+void appendPerKind(std::string& out, const MetricsSnapshot& s, const char* family,
+                   const char* type, const char* help, Field field) {
+  appendFamily(out, family, type, help);
+  std::string sample = family;
+  if (type[0] == 'c') sample += "_total";
+  for (std::size_t k = 0; k < kParserKindCount; ++k) {
+    appendSample(out, sample.c_str(), "kind", parserKindName(static_cast<ParserKind>(k)),
+                 field(s.kinds[k]));
+  }
+}
+
+}  // namespace
+
+MetricsRegistry& MetricsRegistry::instance() {
+  static MetricsRegistry* registry = new MetricsRegistry();
+  return *registry;
+}
+
+void MetricsRegistry::add(ParserKind kind, const PipelineMetrics* metrics,
+                          QueueDepthFn queue_depth) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  live_.push_back(Entry{kind, metrics, std::move(queue_depth)});
+  retired_[static_cast<std::size_t>(kind)].created++;
+}
+
+void MetricsRegistry::remove(const PipelineMetrics* metrics) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = std::find_if(live_.begin(), live_.end(),
+                         [metrics](const Entry& e) { return e.metrics == metrics; });
+  if (it == live_.end()) return;
+  addCounters(retired_[static_cast<std::size_t>(it->kind)], *it->metrics);
+  live_.erase(it);
+}
+
+MetricsSnapshot MetricsRegistry::snapshot() const {
+  MetricsSnapshot s;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t k = 0; k < kParserKindCount; ++k) s.kinds[k] = retired_[k];
+    for (const Entry& e : live_) {
+      ParserKindTotals& t = s.kinds[static_cast<std::size_t>(e.kind)];
+      t.active++;
+      addCounters(t, *e.metrics);
+      if (e.queue_depth) t.queue_depth += e.queue_depth();
+    }
+  }
+  const ArenaBlockPool& pool = ArenaBlockPool::instance();
+  s.arena_bytes_in_use = pool.inUseBytes();
+  s.arena_pool_bytes = pool.pooledBytes();
+  s.arena_pool_blocks = pool.pooledBlocks();
+  s.arena_pool_hits = pool.hits();
+  s.arena_pool_misses = pool.misses();
+  return s;
+}
+
+std::string MetricsRegistry::toOpenMetrics() const {
+  MetricsSnapshot s = snapshot();
+  std::string out;
+  out.reserve(4096);
+  appendPerKind(out, s, "ultratab_parsers_created", "counter", "Parsers created since process start.",
+                [](const ParserKindTotals& t) { return static_cast<double>(t.created); });
+  appendPerKind(out, s, "ultratab_parsers_active", "gauge", "Parsers currently open.",
+                [](const ParserKindTotals& t) { return static_cast<double>(t.active); });
+  appendPerKind(out, s, "ultratab_read_bytes", "counter", "Source bytes read.",
+                [](const ParserKindTotals& t) { return static_cast<double>(t.bytes_read); });
+  appendPerKind(out, s, "ultratab_rows_parsed", "counter", "Rows emitted in batches.",
+                [](const ParserKindTotals& t) { return static_cast<double>(t.rows_parsed); });
+  appendPerKind(out, s, "ultratab_batches_emitted", "counter", "Batches handed to the queue.",
+                [](const ParserKindTotals& t) { return static_cast<double>(t.batches_emitted); });
+  appendPerKind(out, s, "ultratab_parse_seconds", "counter", "Worker time spent tokenizing and building batches.",
+                [](const ParserKindTotals& t) { return static_cast<double>(t.parse_time_ns) / 1e9; });
+  appendPerKind(out, s, "ultratab_queue_wait_seconds", "counter", "Worker time blocked on a full queue (backpressure).",
+                [](const ParserKindTotals& t) { return static_cast<double>(t.queue_wait_ns) / 1e9; });
+  appendPerKind(out, s, "ultratab_queue_depth", "gauge", "Batches waiting to be consumed.",
+                [](const ParserKindTotals& t) { return static_cast<double>(t.queue_depth); });
+
+  appendFamily(out, "ultratab_arena_bytes", "gauge", "Arena block bytes held by parsers (in_use) or idle in the shared pool (pooled).");
+  appendSample(out, "ultratab_arena_bytes", "state", "in_use", static_cast<double>(s.arena_bytes_in_use));
+  appendSample(out, "ultratab_arena_bytes", "state", "pooled", static_cast<double>(s.arena_pool_bytes));
+  appendFamily(out, "ultratab_arena_pool_blocks", "gauge", "Idle arena blocks in the shared pool.");
+  appendSample(out, "ultratab_arena_pool_blocks", nullptr, nullptr, static_cast<double>(s.arena_pool_blocks));
+  appendFamily(out, "ultratab_arena_pool_requests", "counter", "Arena block requests served from (hit) or missing (miss) the shared pool.");
+  appendSample(out, "ultratab_arena_pool_requests_total", "result", "hit", static_cast<double>(s.arena_pool_hits));
+  appendSample(out, "ultratab_arena_pool_requests_total", "result", "miss", static_cast<double>(s.arena_pool_misses));
+  out += "# EOF\n";
+  return out;
+}
+
+}  // namespace ultratab
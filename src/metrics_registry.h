@@ -0,0 +1,108 @@
+#ifndef ULTRATAB_METRICS_REGISTRY_H
+#define ULTRATAB_METRICS_REGISTRY_H
+
+#include "pipeline_metrics.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ultratab {
+
+/// Parser families aggregated separately by the registry.
+enum class ParserKind : std::uint8_t { Csv, Columnar, Xlsx };
+constexpr std::size_t kParserKindCount = 3;
+
+/// Label value for a kind ("csv", "columnar", "xlsx").
+inline const char* parserKindName(ParserKind kind) {
+  switch (kind) {
+    case ParserKind::Csv: return "csv";
+    case ParserKind::Columnar: return "columnar";
+    case ParserKind::Xlsx: return "xlsx";
+  }
+  return "";
+}
+
+/// Fleet-level totals for one parser kind: counters include parsers already destroyed,
+/// gauges (active, queue_depth) cover live parsers only.
+struct ParserKindTotals {
+  std::uint64_t created = 0;
+  std::uint64_t active = 0;
+  std::uint64_t bytes_read = 0;
+  std::uint64_t rows_parsed = 0;
+  std::uint64_t batches_emitted = 0;
+  std::uint64_t parse_time_ns = 0;
+  std::uint64_t queue_wait_ns = 0;
+  std::uint64_t queue_depth = 0;
+};
+
+/// Point-in-time view of every parser in the process plus the shared arena pool.
+struct MetricsSnapshot {
+  ParserKindTotals kinds[kParserKindCount];
+  /// Arena block bytes held by live parsers, and idle in the process-wide pool.
+  std::uint64_t arena_bytes_in_use = 0;
+  std::uint64_t arena_pool_bytes = 0;
+  std::uint64_t arena_pool_blocks = 0;
+  std::uint64_t arena_pool_hits = 0;
+  std::uint64_t arena_pool_misses = 0;
+};
+
+/// Process-wide registry of parser metrics. Parsers register on construction and
+/// unregister on destruction, when their final counters are folded into retired totals,
+/// so snapshots keep counting work done by parsers that no longer exist.
+class MetricsRegistry {
+ public:
+  using QueueDepthFn = std::function<std::size_t()>;
+
+  /// The process-wide registry. Never destroyed, so parsers may unregister during exit.
+  static MetricsRegistry& instance();
+
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  void add(ParserKind kind, const PipelineMetrics* metrics, QueueDepthFn queue_depth);
+  void remove(const PipelineMetrics* metrics);
+
+  MetricsSnapshot snapshot() const;
+
+  /// snapshot() in the OpenMetrics text format (Prometheus compatible), ending in "# EOF".
+  std::string toOpenMetrics() const;
+
+ private:
+  MetricsRegistry() = default;
+
+  struct Entry {
+    ParserKind kind;
+    const PipelineMetrics* metrics;
+    QueueDepthFn queue_depth;
+  };
+
+  mutable std::mutex mutex_;
+  std::vector<Entry> live_;
+  ParserKindTotals retired_[kParserKindCount];
+};
+
+/// Registers a parser's metrics for its lifetime. Declare it after the metrics and queue
+/// members so it unregisters (reading the final counters) before they are destroyed.
+class MetricsRegistration {
+ public:
+  MetricsRegistration(ParserKind kind, const PipelineMetrics* metrics,
+                      MetricsRegistry::QueueDepthFn queue_depth)
+      : metrics_(metrics) {
+    MetricsRegistry::instance().add(kind, metrics, std::move(queue_depth));
+  }
+  ~MetricsRegistration() { MetricsRegistry::instance().remove(metrics_); }
+
+  MetricsRegistration(const MetricsRegistration&) = delete;
+  MetricsRegistration& operator=(const MetricsRegistration&) = delete;
+
+ private:
+  const PipelineMetrics* metrics_;
+};
+
+}  // namespace ultratab
+
+#endif  // ULTRATAB_METRICS_REGISTRY_H
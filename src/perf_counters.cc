@@ -0,0 +1,122 @@
+#include "perf_counters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace ultratab {
+
+#if defined(__linux__)
+
+namespace {
+
+struct EventSpec {
+  std::uint32_t type;
+  std::uint64_t config;
+};
+
+// Indexed by HwEvent.
+const EventSpec kEvents[kHwEventCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+};
+
+int openEvent(const EventSpec& spec, int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = spec.type;
+  attr.config = spec.config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // This thread only, any CPU.
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+}  // namespace
+
+PerfCounters::PerfCounters() {
+  for (std::size_t i = 0; i < kHwEventCount; ++i) {
+    fds_[i] = -1;
+    slot_[i] = -1;
+  }
+  // Cycles lead the group; without it the others are not worth reporting.
+  fds_[0] = openEvent(kEvents[0], -1);
+  if (fds_[0] < 0) return;
+  leader_fd_ = fds_[0];
+  slot_[0] = opened_++;
+  event_mask_ = 1;
+  for (std::size_t i = 1; i < kHwEventCount; ++i) {
+    fds_[i] = openEvent(kEvents[i], leader_fd_);
+    if (fds_[i] < 0) continue;
+    slot_[i] = opened_++;
+    event_mask_ |= 1u << i;
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (std::size_t i = 0; i < kHwEventCount; ++i) {
+    if (fds_[i] >= 0) close(fds_[i]);
+  }
+}
+
+bool PerfCounters::read(HwSample& out) const {
+  if (leader_fd_ < 0) return false;
+  // nr, time_enabled, time_running, values[nr]
+  std::uint64_t buf[3 + kHwEventCount];
+  ssize_t want = static_cast<ssize_t>((3 + opened_) * sizeof(std::uint64_t));
+  if (::read(leader_fd_, buf, sizeof(buf)) < want) return false;
+  std::uint64_t enabled = buf[1];
+  std::uint64_t running = buf[2];
+  double scale = (running > 0 && running < enabled)
+                     ? static_cast<double>(enabled) / static_cast<double>(running)
+                     : 1.0;
+  for (std::size_t i = 0; i < kHwEventCount; ++i) {
+    if (slot_[i] < 0) {
+      out.values[i] = 0;
+      continue;
+    }
+    std::uint64_t v = buf[3 + slot_[i]];
+    out.values[i] = scale == 1.0 ? v : static_cast<std::uint64_t>(static_cast<double>(v) * scale);
+  }
+  return true;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+  for (std::size_t i = 0; i < kHwEventCount; ++i) {
+    fds_[i] = -1;
+    slot_[i] = -1;
+  }
+}
+
+PerfCounters::~PerfCounters() {}
+
+bool PerfCounters::read(HwSample&) const { return false; }
+
+#endif
+
+void HwStageScope::close() {
+  if (!counters_) return;
+  HwSample end;
+  if (counters_->read(end)) {
+    std::size_t s = static_cast<std::size_t>(stage_);
+    for (std::size_t i = 0; i < kHwEventCount; ++i) {
+      if (end.values[i] > start_.values[i]) {
+        metrics_->hw_counts[s][i].fetch_add(end.values[i] - start_.values[i],
+                                            std::memory_order_relaxed);
+      }
+    }
+  }
+  counters_ = nullptr;
+}
+
+}  // namespace ultratab
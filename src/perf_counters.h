@@ -0,0 +1,87 @@
+#ifndef ULTRATAB_PERF_COUNTERS_H
+#define ULTRATAB_PERF_COUNTERS_H
+
+#include "pipeline_metrics.h"
+#include <cstdint>
+
+namespace ultratab {
+
+/// Metric key suffix for a stage ("read", "tokenize", "build").
+inline const char* hwStageName(HwStage stage) {
+  switch (stage) {
+    case HwStage::Read: return "read";
+    case HwStage::Tokenize: return "tokenize";
+    case HwStage::Build: return "build";
+  }
+  return "";
+}
+
+/// Metric key suffix for an event ("cycles", "instructions", "branch_misses", "llc_misses").
+inline const char* hwEventName(HwEvent event) {
+  switch (event) {
+    case HwEvent::Cycles: return "cycles";
+    case HwEvent::Instructions: return "instructions";
+    case HwEvent::BranchMisses: return "branch_misses";
+    case HwEvent::LlcMisses: return "llc_misses";
+  }
+  return "";
+}
+
+/// Cumulative user-space counts since the group was opened, indexed by HwEvent.
+struct HwSample {
+  std::uint64_t values[kHwEventCount] = {};
+};
+
+/// Hardware counters for the calling thread, opened as one perf_event_open group so all
+/// events are scheduled together. Linux only; elsewhere, or when the kernel refuses
+/// (perf_event_paranoid, containers, VMs without a PMU), available() is false and the
+/// parser runs without counters. Events the CPU lacks are skipped individually.
+class PerfCounters {
+ public:
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  bool available() const { return leader_fd_ >= 0; }
+  /// Bit i set when HwEvent i is being counted.
+  std::uint32_t eventMask() const { return event_mask_; }
+
+  /// Current counts, scaled up if the kernel multiplexed the group. False on failure.
+  bool read(HwSample& out) const;
+
+ private:
+  int leader_fd_ = -1;
+  int fds_[kHwEventCount];
+  // Position of each event in the group read format, -1 when not opened.
+  int slot_[kHwEventCount];
+  int opened_ = 0;
+  std::uint32_t event_mask_ = 0;
+};
+
+/// Adds the counter deltas between construction and close() (or destruction) to the
+/// stage's totals in \a metrics. No-op when \a counters is null.
+class HwStageScope {
+ public:
+  HwStageScope(const PerfCounters* counters, PipelineMetrics* metrics, HwStage stage)
+      : counters_(counters), metrics_(metrics), stage_(stage) {
+    if (counters_ && !counters_->read(start_)) counters_ = nullptr;
+  }
+  ~HwStageScope() { close(); }
+
+  void close();
+
+  HwStageScope(const HwStageScope&) = delete;
+  HwStageScope& operator=(const HwStageScope&) = delete;
+
+ private:
+  const PerfCounters* counters_;
+  PipelineMetrics* metrics_;
+  HwStage stage_;
+  HwSample start_;
+};
+
+}  // namespace ultratab
+
+#endif  // ULTRATAB_PERF_COUNTERS_H
@@ -1,8 +1,10 @@
 #ifndef ULTRATAB_PIPELINE_METRICS_H
 #define ULTRATAB_PIPELINE_METRICS_H
 
+#include "latency_histogram.h"
 #include <cstdint>
 #include <atomic>
+#include <cstddef>
 #include <cstdlib>
 
 namespace ultratab {
@@ -17,6 +19,16 @@ inline bool profileEnabled() {
 #endif
 }
 
+/// Pipeline stage that heap allocations are attributed to (ULTRATAB_ALLOC_STATS builds).
+enum class AllocStage : std::uint8_t { Read, Tokenize, Build, Emit };
+constexpr std::size_t kAllocStageCount = 4;
+
+/// Worker stages and hardware events sampled by the perfCounters option (Linux).
+enum class HwStage : std::uint8_t { Read, Tokenize, Build };
+constexpr std::size_t kHwStageCount = 3;
+enum class HwEvent : std::uint8_t { Cycles, Instructions, BranchMisses, LlcMisses };
+constexpr std::size_t kHwEventCount = 4;
+
 /// Internal metrics for the producer-consumer pipeline (optional debug exposure).
 /// With profiling: read_time_ns, parse_time_ns, build_time_ns, emit_time_ns and allocation counts are populated.
 struct PipelineMetrics {
@@ -32,16 +44,44 @@ struct PipelineMetrics {
   std::atomic<uint64_t> build_time_ns{0};
   /// Profiling: time spent waiting to push to queue (emit).
   std::atomic<uint64_t> emit_time_ns{0};
-  /// Profiling: arena resize count (slice parser).
+  /// Profiling: arena resize count (blocks added by the slice parser arena).
   std::atomic<uint64_t> arena_resizes{0};
   /// Profiling: batch allocations (slice batch taken).
   std::atomic<uint64_t> batch_allocations{0};
+  /// Profiling: tokenizer windows that contained no quote and took the quote-free kernel.
+  std::atomic<uint64_t> quote_free_windows{0};
 
   /// Arena allocator debug stats (internal).
   std::atomic<uint64_t> arena_bytes_allocated{0};
   std::atomic<uint64_t> arena_blocks{0};
   std::atomic<uint64_t> arena_resets{0};
   std::atomic<uint64_t> peak_arena_usage{0};
+  /// Dedicated blocks allocated for requests larger than the maximum block size.
+  std::atomic<uint64_t> arena_large_blocks{0};
+  /// Block bytes freed by reset() (dedicated blocks and spares above the high-water mark).
+  std::atomic<uint64_t> arena_bytes_trimmed{0};
+  /// Arena blocks served from / missing the process-wide block pool.
+  std::atomic<uint64_t> arena_pool_hits{0};
+  std::atomic<uint64_t> arena_pool_misses{0};
+
+  /// Heap allocations (operator new calls) and bytes per AllocStage; only counted in
+  /// builds with ULTRATAB_ALLOC_STATS.
+  std::atomic<uint64_t> stage_allocs[kAllocStageCount]{};
+  std::atomic<uint64_t> stage_alloc_bytes[kAllocStageCount]{};
+
+  /// Hardware counters: bit i of hw_event_mask is set when HwEvent i could be opened on
+  /// the worker thread (0 when perfCounters is off or unsupported); hw_counts sums the
+  /// user-space counts per HwStage and HwEvent.
+  std::atomic<uint32_t> hw_event_mask{0};
+  std::atomic<uint64_t> hw_counts[kHwStageCount][kHwEventCount]{};
+
+  /// Latency distributions, recorded whether or not profiling is on: read per chunk,
+  /// tokenize/build/queue-wait per batch on the worker, convert per batch on the JS thread.
+  LatencyHistogram read_latency;
+  LatencyHistogram tokenize_latency;
+  LatencyHistogram build_latency;
+  LatencyHistogram queue_wait_latency;
+  LatencyHistogram convert_latency;
 
   void reset() {
     bytes_read.store(0);
@@ -54,10 +94,28 @@ struct PipelineMetrics {
     emit_time_ns.store(0);
     arena_resizes.store(0);
     batch_allocations.store(0);
+    quote_free_windows.store(0);
     arena_bytes_allocated.store(0);
     arena_blocks.store(0);
     arena_resets.store(0);
     peak_arena_usage.store(0);
+    arena_large_blocks.store(0);
+    arena_bytes_trimmed.store(0);
+    arena_pool_hits.store(0);
+    arena_pool_misses.store(0);
+    for (std::size_t i = 0; i < kAllocStageCount; ++i) {
+      stage_allocs[i].store(0);
+      stage_alloc_bytes[i].store(0);
+    }
+    hw_event_mask.store(0);
+    for (std::size_t s = 0; s < kHwStageCount; ++s) {
+      for (std::size_t e = 0; e < kHwEventCount; ++e) hw_counts[s][e].store(0);
+    }
+    read_latency.reset();
+    tokenize_latency.reset();
+    build_latency.reset();
+    queue_wait_latency.reset();
+    convert_latency.reset();
   }
 };
 
@@ -0,0 +1,45 @@
+#ifndef ULTRATAB_RECYCLE_POOL_H
+#define ULTRATAB_RECYCLE_POOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ultratab {
+
+/// Free list of objects handed back by the consumer so the producer can refill them
+/// (e.g. batches whose vectors and strings keep their capacity). Holds at most
+/// \a capacity objects; further releases are dropped. Mutex-protected, never allocates
+/// after construction.
+template <typename T>
+class RecyclePool {
+ public:
+  explicit RecyclePool(std::size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {
+    items_.reserve(capacity_);
+  }
+
+  /// Move a pooled object into out. Returns false (out untouched) when the pool is empty.
+  bool acquire(T& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (items_.empty()) return false;
+    out = std::move(items_.back());
+    items_.pop_back();
+    return true;
+  }
+
+  /// Return an object for reuse.
+  void release(T item) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (items_.size() < capacity_) items_.push_back(std::move(item));
+  }
+
+ private:
+  const std::size_t capacity_;
+  std::vector<T> items_;
+  std::mutex mutex_;
+};
+
+}  // namespace ultratab
+
+#endif  // ULTRATAB_RECYCLE_POOL_H
@@ -1,4 +1,5 @@
 #include "simd_scanner.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
@@ -13,6 +14,11 @@ static inline unsigned ctz32(unsigned x) {
   unsigned long idx;
   return _BitScanForward(&idx, x) ? idx : 32;
 }
+static inline unsigned clz32(unsigned x) {
+  unsigned long idx;
+  return _BitScanReverse(&idx, x) ? 31 - idx : 32;
+}
+static inline unsigned popcount32(unsigned x) { return __popcnt(x); }
 #else
 #include <cpuid.h>
 #define ULTRATAB_CPUID(info, leaf, subleaf) \
@@ -20,6 +26,12 @@ static inline unsigned ctz32(unsigned x) {
 static inline unsigned ctz32(unsigned x) {
   return x ? static_cast<unsigned>(__builtin_ctz(x)) : 32u;
 }
+static inline unsigned clz32(unsigned x) {
+  return x ? static_cast<unsigned>(__builtin_clz(x)) : 32u;
+}
+static inline unsigned popcount32(unsigned x) {
+  return static_cast<unsigned>(__builtin_popcount(x));
+}
 #endif
 
 #else
@@ -42,6 +54,12 @@ CpuFeatures detectCpuFeaturesImpl() {
 
   ULTRATAB_CPUID(info, 7, 0);
   f.avx2 = (static_cast<unsigned>(info[1]) & (1u << 5)) != 0;
+
+  ULTRATAB_CPUID(info, 0x80000000u, 0);
+  if (static_cast<unsigned>(info[0]) >= 0x80000007u) {
+    ULTRATAB_CPUID(info, 0x80000007u, 0);
+    f.invariant_tsc = (static_cast<unsigned>(info[3]) & (1u << 8)) != 0;
+  }
 #endif
   return f;
 }
@@ -85,6 +103,59 @@ static std::size_t scanForCharScalar(const char* data, std::size_t len, char ch)
   return len;
 }
 
+static std::size_t indexSeparatorsScalar(const char* data, std::size_t start,
+                                         std::size_t len, char delimiter,
+                                         std::uint32_t* out, std::size_t max_out,
+                                         std::size_t* out_scanned) {
+  std::size_t n = 0;
+  std::size_t i = start;
+  for (; i < len; ++i) {
+    char c = data[i];
+    if (c == delimiter || c == '\r' || c == '\n') {
+      if (n == max_out) break;
+      out[n++] = static_cast<std::uint32_t>(i);
+    }
+  }
+  *out_scanned = i;
+  return n;
+}
+
+static inline bool isTrimSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static std::size_t skipSpaceScalar(const char* data, std::size_t len) {
+  std::size_t i = 0;
+  while (i < len && isTrimSpace(data[i])) ++i;
+  return i;
+}
+
+static std::size_t skipSpaceBackScalar(const char* data, std::size_t len) {
+  while (len > 0 && isTrimSpace(data[len - 1])) --len;
+  return len;
+}
+
+// Copy data[i..limit) to out[*o..], collapsing doubled quotes, up to the first quote
+// that is not doubled (its partner may lie past \a limit, up to \a len).
+static std::size_t unescapeQuotedScalar(const char* data, std::size_t i, std::size_t limit,
+                                        std::size_t len, char quote, char* out,
+                                        std::size_t* o) {
+  std::size_t w = *o;
+  while (i < limit) {
+    char c = data[i];
+    if (c == quote) {
+      if (i + 1 >= len || data[i + 1] != quote) break;
+      out[w++] = quote;
+      i += 2;
+      continue;
+    }
+    out[w++] = c;
+    ++i;
+  }
+  *o = w;
+  return i;
+}
+
 // --- SSE2 path (16 bytes at a time) ---
 
 #if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || _M_IX86_FP >= 2))
@@ -160,6 +231,94 @@ static std::size_t scanForCharSSE2(const char* data, std::size_t len, char ch) {
          scanForCharScalar(p, static_cast<std::size_t>(end - p), ch);
 }
 
+static std::size_t indexSeparatorsSSE2(const char* data, std::size_t len,
+                                       char delimiter, std::uint32_t* out,
+                                       std::size_t max_out, std::size_t* out_scanned) {
+  __m128i delim_v = _mm_set1_epi8(static_cast<char>(delimiter));
+  __m128i cr_v = _mm_set1_epi8('\r');
+  __m128i lf_v = _mm_set1_epi8('\n');
+
+  std::size_t n = 0;
+  std::size_t i = 0;
+  while (i + 16 <= len) {
+    if (n + 16 > max_out) {
+      *out_scanned = i;
+      return n;
+    }
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    __m128i any = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, delim_v), _mm_cmpeq_epi8(chunk, cr_v)),
+        _mm_cmpeq_epi8(chunk, lf_v));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(any));
+    while (mask != 0) {
+      out[n++] = static_cast<std::uint32_t>(i + ctz32(mask));
+      mask &= mask - 1;
+    }
+    i += 16;
+  }
+  return n + indexSeparatorsScalar(data, i, len, delimiter, out + n, max_out - n,
+                                   out_scanned);
+}
+
+static std::size_t unescapeQuotedSSE2(const char* data, std::size_t len, char quote,
+                                      char* out, std::size_t* out_len) {
+  __m128i quote_v = _mm_set1_epi8(static_cast<char>(quote));
+  std::size_t i = 0;
+  std::size_t o = 0;
+  while (i + 16 <= len) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote_v));
+    if (mask == 0) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), chunk);
+      o += 16;
+      i += 16;
+      continue;
+    }
+    // No byte shuffle in SSE2: copy the quote-free prefix, then step over the quotes.
+    unsigned idx = ctz32(static_cast<unsigned>(mask));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), chunk);
+    o += idx;
+    i += idx;
+    std::size_t next = unescapeQuotedScalar(data, i, i + 1, len, quote, out, &o);
+    if (next == i) {
+      *out_len = o;
+      return i;
+    }
+    i = next;
+  }
+  i = unescapeQuotedScalar(data, i, len, len, quote, out, &o);
+  *out_len = o;
+  return i;
+}
+
+// Bit i set when chunk byte i is not one of " \t\r\n".
+static inline unsigned nonSpaceMaskSSE2(__m128i chunk) {
+  __m128i sp = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+  __m128i nl = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')),
+                            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+  return ~static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(sp, nl))) & 0xFFFFu;
+}
+
+static std::size_t skipSpaceSSE2(const char* data, std::size_t len) {
+  std::size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    unsigned mask = nonSpaceMaskSSE2(chunk);
+    if (mask != 0) return i + ctz32(mask);
+  }
+  return i + skipSpaceScalar(data + i, len - i);
+}
+
+static std::size_t skipSpaceBackSSE2(const char* data, std::size_t len) {
+  for (; len >= 16; len -= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + len - 16));
+    unsigned mask = nonSpaceMaskSSE2(chunk);
+    if (mask != 0) return len - 16 + (32 - clz32(mask));
+  }
+  return skipSpaceBackScalar(data, len);
+}
+
 #endif  // SSE2
 
 // --- AVX2 path (32 bytes at a time) ---
@@ -238,8 +397,149 @@ static std::size_t scanForCharAVX2(const char* data, std::size_t len, char ch) {
          scanForCharScalar(p, static_cast<std::size_t>(end - p), ch);
 }
 
+static std::size_t indexSeparatorsAVX2(const char* data, std::size_t len,
+                                       char delimiter, std::uint32_t* out,
+                                       std::size_t max_out, std::size_t* out_scanned) {
+  __m256i delim_v = _mm256_set1_epi8(static_cast<char>(delimiter));
+  __m256i cr_v = _mm256_set1_epi8('\r');
+  __m256i lf_v = _mm256_set1_epi8('\n');
+
+  std::size_t n = 0;
+  std::size_t i = 0;
+  while (i + 32 <= len) {
+    if (n + 32 > max_out) {
+      *out_scanned = i;
+      return n;
+    }
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    __m256i any = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, delim_v), _mm256_cmpeq_epi8(chunk, cr_v)),
+        _mm256_cmpeq_epi8(chunk, lf_v));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(any));
+    while (mask != 0) {
+      out[n++] = static_cast<std::uint32_t>(i + ctz32(mask));
+      mask &= mask - 1;
+    }
+    i += 32;
+  }
+  return n + indexSeparatorsScalar(data, i, len, delimiter, out + n, max_out - n,
+                                   out_scanned);
+}
+
+namespace {
+
+// For each 8-bit drop mask: byte indices of the kept bytes of an 8-byte lane, in order.
+struct CompactTable {
+  std::uint8_t idx[256][8];
+  CompactTable() {
+    for (unsigned m = 0; m < 256; ++m) {
+      unsigned k = 0;
+      for (unsigned b = 0; b < 8; ++b) {
+        if (!(m & (1u << b))) idx[m][k++] = static_cast<std::uint8_t>(b);
+      }
+      while (k < 8) idx[m][k++] = 0x80;
+    }
+  }
+};
+
+const CompactTable& compactTable() {
+  static const CompactTable table;
+  return table;
+}
+
+}  // namespace
+
+static std::size_t unescapeQuotedAVX2(const char* data, std::size_t len, char quote,
+                                      char* out, std::size_t* out_len) {
+  const std::uint32_t kEven = 0x55555555u;
+  const std::uint32_t kOdd = ~kEven;
+  const CompactTable& compact = compactTable();
+  __m256i quote_v = _mm256_set1_epi8(static_cast<char>(quote));
+  std::size_t i = 0;
+  std::size_t o = 0;
+  while (i + 32 <= len) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    std::uint32_t q =
+        static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote_v)));
+    if (q == 0) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), chunk);
+      o += 32;
+      i += 32;
+      continue;
+    }
+
+    // A quote run reaching the end of the block has unknown length: leave it for the
+    // next block (or pair it up here when the whole block is quotes).
+    std::size_t commit = 32;
+    if (q & 0x80000000u) {
+      if (q == 0xffffffffu) {
+        std::size_t next = unescapeQuotedScalar(data, i, i + 32, len, quote, out, &o);
+        if (next < i + 32 && data[next] == quote) {
+          *out_len = o;
+          return next;
+        }
+        i = next;
+        continue;
+      }
+      commit = 32 - static_cast<std::size_t>(clz32(~q));
+      q &= (1u << commit) - 1;
+    }
+
+    // Within each run of quotes the bytes at odd offsets from the run start are the
+    // second half of a doubled quote and are dropped. A run of odd length ends in the
+    // closing quote. Run parity comes from the carry trick used for escape runs.
+    std::uint32_t starts = q & ~(q << 1);
+    std::uint32_t even_runs = q & ~(q + (starts & kEven));
+    std::uint32_t odd_runs = q & ~even_runs;
+    std::uint32_t drop = (even_runs & kOdd) | (odd_runs & kEven);
+    std::uint32_t closing = (q & ~drop) & ~(q >> 1);
+    std::size_t n = commit;
+    if (closing != 0) {
+      n = ctz32(closing);
+      drop &= (1u << n) - 1;
+    }
+
+    if (drop == 0) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), chunk);
+      o += n;
+    } else {
+      __m128i halves[2] = {_mm256_castsi256_si128(chunk),
+                           _mm256_extracti128_si256(chunk, 1)};
+      for (std::size_t lane = 0; lane * 8 < n; ++lane) {
+        unsigned m = (drop >> (lane * 8)) & 0xffu;
+        __m128i ctrl = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(compact.idx[m]));
+        if (lane & 1) ctrl = _mm_add_epi8(ctrl, _mm_set1_epi8(8));
+        __m128i packed = _mm_shuffle_epi8(halves[lane >> 1], ctrl);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + o), packed);
+        std::size_t lane_len = std::min<std::size_t>(8, n - lane * 8);
+        unsigned lane_mask = lane_len == 8 ? 0xffu : ((1u << lane_len) - 1);
+        o += lane_len - popcount32(m & lane_mask);
+      }
+    }
+    i += n;
+    if (closing != 0) {
+      *out_len = o;
+      return i;
+    }
+  }
+  i = unescapeQuotedScalar(data, i, len, len, quote, out, &o);
+  *out_len = o;
+  return i;
+}
+
 #endif  // AVX2
 
+bool hasVectorScanner(const CpuFeatures& features) {
+#if defined(__AVX2__)
+  if (features.avx2) return true;
+#endif
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || _M_IX86_FP >= 2))
+  if (features.sse2) return true;
+#endif
+  (void)features;
+  return false;
+}
+
 std::size_t scanForSeparator(const char* data, std::size_t len, char delimiter,
                              const CpuFeatures& features) {
 #if defined(__AVX2__)
@@ -273,4 +573,48 @@ std::size_t scanForChar(const char* data, std::size_t len, char ch,
   return scanForCharScalar(data, len, ch);
 }
 
+std::size_t indexSeparators(const char* data, std::size_t len, char delimiter,
+                            std::uint32_t* out, std::size_t max_out,
+                            std::size_t* out_scanned, const CpuFeatures& features) {
+#if defined(__AVX2__)
+  if (features.avx2 && max_out >= 32)
+    return indexSeparatorsAVX2(data, len, delimiter, out, max_out, out_scanned);
+#endif
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || _M_IX86_FP >= 2))
+  if (features.sse2 && max_out >= 16)
+    return indexSeparatorsSSE2(data, len, delimiter, out, max_out, out_scanned);
+#endif
+  return indexSeparatorsScalar(data, 0, len, delimiter, out, max_out, out_scanned);
+}
+
+std::size_t skipSpace(const char* data, std::size_t len, const CpuFeatures& features) {
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || _M_IX86_FP >= 2))
+  if (features.sse2) return skipSpaceSSE2(data, len);
+#endif
+  (void)features;
+  return skipSpaceScalar(data, len);
+}
+
+std::size_t skipSpaceBack(const char* data, std::size_t len, const CpuFeatures& features) {
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || _M_IX86_FP >= 2))
+  if (features.sse2) return skipSpaceBackSSE2(data, len);
+#endif
+  (void)features;
+  return skipSpaceBackScalar(data, len);
+}
+
+std::size_t unescapeQuoted(const char* data, std::size_t len, char quote, char* out,
+                           std::size_t* out_len, const CpuFeatures& features) {
+#if defined(__AVX2__)
+  if (features.avx2) return unescapeQuotedAVX2(data, len, quote, out, out_len);
+#endif
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || _M_IX86_FP >= 2))
+  if (features.sse2) return unescapeQuotedSSE2(data, len, quote, out, out_len);
+#endif
+  std::size_t o = 0;
+  std::size_t i = unescapeQuotedScalar(data, 0, len, len, quote, out, &o);
+  *out_len = o;
+  return i;
+}
+
 }  // namespace ultratab
@@ -2,6 +2,7 @@
 #define ULTRATAB_SIMD_SCANNER_H
 
 #include <cstddef>
+#include <cstdint>
 
 namespace ultratab {
 
@@ -9,11 +10,16 @@ namespace ultratab {
 struct CpuFeatures {
   bool sse2 = false;
   bool avx2 = false;
+  /// Time-stamp counter runs at a constant rate across P-states and C-states.
+  bool invariant_tsc = false;
 };
 
 /// Detect CPU features at runtime. Thread-safe.
 CpuFeatures detectCpuFeatures();
 
+/// True if a vector (SSE2/AVX2) scanner is compiled in and usable with \a features.
+bool hasVectorScanner(const CpuFeatures& features);
+
 /// Fast scanner: find next delimiter or newline in data.
 /// Used to accelerate scanning when NOT inside quotes; state machine validates.
 /// Returns offset from start, or len if not found.
@@ -28,6 +34,27 @@ std::size_t scanForNewline(const char* data, std::size_t len,
 std::size_t scanForChar(const char* data, std::size_t len, char ch,
                         const CpuFeatures& features);
 
+/// Bitmask splitter for quote-free data: write the offsets of every delimiter, CR and
+/// LF byte in data[0..len) to \a out (at most \a max_out entries, offsets < 2^32).
+/// Returns the number of offsets written; *out_scanned receives how many input bytes
+/// were fully examined (== len unless \a out filled up first).
+std::size_t indexSeparators(const char* data, std::size_t len, char delimiter,
+                            std::uint32_t* out, std::size_t max_out,
+                            std::size_t* out_scanned, const CpuFeatures& features);
+
+/// Offset of the first byte in data[0..len) that is not a space, tab, CR or LF, or len.
+std::size_t skipSpace(const char* data, std::size_t len, const CpuFeatures& features);
+
+/// Length of data[0..len) without its trailing spaces, tabs, CRs and LFs.
+std::size_t skipSpaceBack(const char* data, std::size_t len, const CpuFeatures& features);
+
+/// Unescape the body of a quoted field: copy data[0..len) to \a out, collapsing each
+/// doubled quote to one, up to the first quote that is not doubled. Returns that quote's
+/// offset (the closing quote, or a quote ending the span whose partner is not known yet),
+/// or len. *out_len receives the bytes written; \a out must have room for len bytes.
+std::size_t unescapeQuoted(const char* data, std::size_t len, char quote, char* out,
+                           std::size_t* out_len, const CpuFeatures& features);
+
 }  // namespace ultratab
 
 #endif  // ULTRATAB_SIMD_SCANNER_H
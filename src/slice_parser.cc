@@ -21,12 +21,114 @@ const char CR = '\r';
 const char LF = '\n';
 inline bool isNewline(char c) { return c == CR || c == LF; }
 
+// Separator offsets collected per indexSeparators() call in the quote-free kernel.
+const std::size_t kSeparatorIndexCapacity = 4096;
+
+// Bytes of a quoted field unescaped per arena reservation.
+const std::size_t kUnescapeSpan = 4096;
+
+// DFA engine. A table entry packs the next state (low 3 bits) with action bits.
+const std::uint8_t kDfaFieldStart = 0;
+const std::uint8_t kDfaInField = 1;
+const std::uint8_t kDfaInQuoted = 2;
+const std::uint8_t kDfaAfterQuote = 3;
+const std::uint8_t kDfaAfterCR = 4;  // row ended on CR; a following LF is swallowed
+const std::size_t kDfaStateCount = 5;
+const std::uint8_t kDfaStateMask = 0x07;
+const std::uint8_t kDfaEmit = 0x08;      // append the byte to the current field
+const std::uint8_t kDfaEnd = 0x10;       // the byte ends the current field
+const std::uint8_t kDfaEndRow = 0x20;    // ... and the row
+// Bytes run through the table per pass; bounds the field-byte and event buffers and
+// keeps the offsets packed into an event below 2^15.
+const std::size_t kDfaPass = 8192;
+// Passes shorter than this run as a single stream.
+const std::size_t kDfaMinSplit = 256;
+const std::size_t kNoStop = static_cast<std::size_t>(-1);
+
+// One table step. Every byte is stored to out[] and an event slot is written
+// unconditionally; only the cursors advance by the action bits. An event packs the
+// field-byte cursor (high 16 bits), the input offset and the end-of-row bit.
+inline void dfaStep(const std::uint8_t* table, unsigned& state, const unsigned char* in,
+                    std::size_t i, char* out, std::uint32_t& o, std::uint32_t* events,
+                    std::size_t& e) {
+  unsigned t = table[(state << 8) | in[i]];
+  state = t & kDfaStateMask;
+  out[o] = static_cast<char>(in[i]);
+  o += (t >> 3) & 1u;
+  events[e] = (o << 16) | static_cast<std::uint32_t>(i << 1) | ((t >> 5) & 1u);
+  e += (t >> 4) & 1u;
+}
+
+void runDfa(const std::uint8_t* table, const unsigned char* in, std::size_t begin,
+            std::size_t end, unsigned& state, char* out, std::uint32_t& o,
+            std::uint32_t* events, std::size_t& e) {
+  for (std::size_t i = begin; i < end; ++i) dfaStep(table, state, in, i, out, o, events, e);
+}
+
+// Streams A = in[0, split) and B = in[split, n) with independent state chains, so the
+// table loads of one stream overlap those of the other.
+void runDfa2(const std::uint8_t* table, const unsigned char* in, std::size_t split,
+             std::size_t n, unsigned& state_a, unsigned& state_b, char* out,
+             std::uint32_t& o_a, std::uint32_t& o_b, std::uint32_t* events,
+             std::size_t& e_a, std::size_t& e_b) {
+  std::size_t common = std::min(split, n - split);
+  for (std::size_t i = 0; i < common; ++i) {
+    dfaStep(table, state_a, in, i, out, o_a, events, e_a);
+    dfaStep(table, state_b, in, split + i, out, o_b, events, e_b);
+  }
+  runDfa(table, in, common, split, state_a, out, o_a, events, e_a);
+  runDfa(table, in, split + common, n, state_b, out, o_b, events, e_b);
+}
+
 }  // namespace
 
 SliceCsvParser::SliceCsvParser(const CsvOptions& options)
     : opts_(options), arena_(kArenaBlockSize), batch_size_(options.batch_size) {
   cpu_features_ = detectCpuFeatures();
   current_batch_.reserve(batch_size_);
+  separator_index_.resize(kSeparatorIndexCapacity);
+  use_dfa_ = options.engine == TokenizerEngine::Dfa ||
+             (options.engine == TokenizerEngine::Auto && !hasVectorScanner(cpu_features_));
+  if (use_dfa_) buildDfaTable();
+}
+
+void SliceCsvParser::buildDfaTable() {
+  dfa_table_.assign(kDfaStateCount * 256, 0);
+  for (int b = 0; b < 256; ++b) {
+    char c = static_cast<char>(b);
+    bool delim = c == opts_.delimiter;
+    bool quote = !delim && c == opts_.quote;
+    bool newline = !delim && !quote && isNewline(c);
+    std::uint8_t row_end = static_cast<std::uint8_t>(
+        kDfaEnd | kDfaEndRow | (c == CR ? kDfaAfterCR : kDfaFieldStart));
+    std::uint8_t field_end = kDfaEnd | kDfaFieldStart;
+
+    std::uint8_t start;
+    if (delim) start = field_end;
+    else if (quote) start = kDfaInQuoted;
+    else if (newline) start = row_end;
+    else start = kDfaEmit | kDfaInField;
+    dfa_table_[kDfaFieldStart * 256 + b] = start;
+    dfa_table_[kDfaAfterCR * 256 + b] = c == LF ? kDfaFieldStart : start;
+
+    std::uint8_t in_field;
+    if (delim) in_field = field_end;
+    else if (newline) in_field = row_end;
+    else in_field = kDfaEmit | kDfaInField;  // a quote inside an unquoted field is literal
+    dfa_table_[kDfaInField * 256 + b] = in_field;
+
+    dfa_table_[kDfaInQuoted * 256 + b] =
+        quote ? kDfaAfterQuote : static_cast<std::uint8_t>(kDfaEmit | kDfaInQuoted);
+
+    std::uint8_t after_quote;
+    if (quote) after_quote = kDfaEmit | kDfaInQuoted;  // "" inside quotes
+    else if (delim) after_quote = field_end;
+    else if (newline) after_quote = row_end;
+    else after_quote = kDfaEmit | kDfaInField;  // text after a closing quote
+    dfa_table_[kDfaAfterQuote * 256 + b] = after_quote;
+  }
+  dfa_out_.resize(kDfaPass);
+  dfa_events_.resize(kDfaPass);
 }
 
 void SliceCsvParser::setMetrics(PipelineMetrics* m) {
@@ -34,55 +136,79 @@ void SliceCsvParser::setMetrics(PipelineMetrics* m) {
   arena_.setMetrics(m);
 }
 
-void SliceCsvParser::feed(const char* seg1, std::size_t len1,
-                          const char* seg2, std::size_t len2) {
-  seg1_consumed_ = 0;
-  seg2_consumed_ = 0;
-  processTwoSegments(seg1, len1, seg2, len2, &seg1_consumed_, &seg2_consumed_);
-  if (seg1 && len1 > 0 && seg1_consumed_ < len1) {
-    remainder_.assign(seg1 + seg1_consumed_, seg1 + len1);
-    if (seg2 && len2 > 0)
-      remainder_.insert(remainder_.end(), seg2, seg2 + len2);
-  } else if (seg2 && len2 > 0 && seg2_consumed_ < len2) {
-    remainder_.assign(seg2 + seg2_consumed_, seg2 + len2);
-  } else {
-    remainder_.clear();
+std::size_t SliceCsvParser::feed(const char* data, std::size_t len) {
+  span_base_ = fed_;
+  span_data_ = data;
+  span_end_ = data + len;
+  if (lf_check_pending_ && len > 0) {
+    lf_check_pending_ = false;
+    if (data[0] == LF) ++row_start_;
   }
+  std::size_t pos = 0;
+  while (pos < len && !batch_ready_) {
+    const char* window = data + pos;
+    std::size_t window_len = std::min(len - pos, kQuoteFreeWindow);
+    bool in_quotes =
+        state_ == State::InQuoted || state_ == State::InQuotedAfterQuote;
+    if (use_dfa_) {
+      pos += tokenizeDfa(window, window_len);
+    } else if (!in_quotes &&
+        scanForChar(window, window_len, opts_.quote, cpu_features_) == window_len) {
+      if (metrics_) metrics_->quote_free_windows.fetch_add(1);
+      pos += tokenizeQuoteFree(window, window_len);
+    } else {
+      pos += tokenizeStateMachine(window, window_len);
+    }
+  }
+  fed_ += pos;
+  return pos;
 }
 
 void SliceCsvParser::flush() {
-  if (state_ == State::InQuoted || state_ == State::InQuotedAfterQuote) {
-    return;
-  }
-  if (!current_row_.empty()) {
+  if (state_ != State::FieldStart || logical_column_index_ > 0) {
+    row_end_ = fed_;
+    next_row_start_ = fed_;
+    endField();
     emitRow();
   }
-  row_ready_ = false;
+  state_ = State::FieldStart;
+  after_cr_ = false;
   if (!current_batch_.empty()) {
     batch_ready_ = true;
   }
 }
 
-void SliceCsvParser::getRemainder(const char** out_ptr, std::size_t* out_len) const {
-  if (remainder_.empty()) {
-    *out_ptr = nullptr;
-    *out_len = 0;
-  } else {
-    *out_ptr = remainder_.data();
-    *out_len = remainder_.size();
-  }
-}
-
 void SliceCsvParser::skipOneRow() { skip_next_row_ = true; }
 
 SliceBatch SliceCsvParser::takeBatch() {
-  batch_ready_ = false;
   SliceBatch out;
+  takeBatch(out);
+  return out;
+}
+
+void SliceCsvParser::takeBatch(SliceBatch& out) {
+  batch_ready_ = false;
   arena_.copyUsedTo(out.arena);
-  out.rows = std::move(current_batch_);
+  recycleRows(out.rows);
+  out.rows.swap(current_batch_);
+  if (track_offsets_) {
+    out.row_offsets.swap(row_offsets_);
+    row_offsets_.clear();
+    out.byte_end = batch_byte_end_;
+  }
   arena_.reset();
   startNewBatch();
-  return out;
+}
+
+void SliceCsvParser::recycleRows(std::vector<SliceRow>& rows) {
+  std::size_t needed = spare_rows_.size() + rows.size();
+  if (spare_rows_.capacity() < needed) spare_rows_.reserve(2 * needed);
+  for (SliceRow& row : rows) {
+    if (row.capacity() == 0) continue;
+    row.clear();
+    spare_rows_.push_back(std::move(row));
+  }
+  rows.clear();
 }
 
 void SliceCsvParser::startNewBatch() {
@@ -90,236 +216,388 @@ void SliceCsvParser::startNewBatch() {
   current_batch_.reserve(batch_size_);
 }
 
-void SliceCsvParser::emitField(const char* start, std::size_t len) {
-  std::size_t off = arena_.used();
-  if (len > 0) {
-    arena_.write(start, len);
+void SliceCsvParser::appendToField(const char* start, std::size_t len) {
+  if (!field_open_) {
+    field_open_ = true;
+    field_emitted_ = shouldEmitColumn(logical_column_index_);
+    if (field_emitted_) current_row_.push_back({arena_.used(), 0});
   }
-  current_row_.push_back({off, len});
+  if (!field_emitted_ || len == 0) return;
+  arena_.write(start, len);
+  current_row_.back().len += len;
 }
 
-void SliceCsvParser::appendQuoteToLastField() {
-  if (current_row_.empty()) return;
-  arena_.write(reinterpret_cast<const char*>(&opts_.quote), 1);
-  current_row_.back().len += 1;
+void SliceCsvParser::appendQuoteToField() { appendToField(&opts_.quote, 1); }
+
+void SliceCsvParser::endField() {
+  if (!field_open_) appendToField(nullptr, 0);
+  field_open_ = false;
+  ++logical_column_index_;
 }
 
-void SliceCsvParser::appendToLastField(const char* start, std::size_t len) {
-  if (current_row_.empty() || len == 0) return;
-  arena_.write(start, len);
-  current_row_.back().len += len;
+void SliceCsvParser::endRow(const char* nl) {
+  noteRowEnd(nl);
+  endField();
+  emitRow();
+  state_ = State::FieldStart;
+  after_cr_ = (*nl == CR);
+}
+
+void SliceCsvParser::noteRowEndSlow(const char* nl) {
+  row_end_ = span_base_ + static_cast<std::uint64_t>(nl - span_data_);
+  next_row_start_ = row_end_ + 1;
+  if (*nl != CR) return;
+  // The kernels swallow one LF after a CR; when it is not in this span yet, the next
+  // feed() checks its first byte.
+  if (nl + 1 < span_end_) {
+    if (nl[1] == LF) ++next_row_start_;
+  } else {
+    lf_check_pending_ = true;
+  }
 }
 
 void SliceCsvParser::emitRow() {
+  logical_column_index_ = 0;
+  std::uint64_t row_start = row_start_;
+  if (track_offsets_) row_start_ = next_row_start_;
   if (skip_next_row_) {
     skip_next_row_ = false;
     current_row_.clear();
-    row_ready_ = false;
-    logical_column_index_ = 0;
     return;
   }
-  row_ready_ = true;
+  if (track_offsets_) {
+    row_offsets_.push_back(row_start);
+    batch_byte_end_ = row_end_;
+  }
   current_batch_.push_back(std::move(current_row_));
   current_row_.clear();
-  logical_column_index_ = 0;
+  if (!spare_rows_.empty()) {
+    current_row_.swap(spare_rows_.back());
+    spare_rows_.pop_back();
+  }
   if (current_batch_.size() >= batch_size_) {
     batch_ready_ = true;
   }
 }
 
-void SliceCsvParser::processTwoSegments(const char* p1, std::size_t len1,
-                                        const char* p2, std::size_t len2,
-                                        std::size_t* consumed1,
-                                        std::size_t* consumed2) {
-  const char* seg1_end = p1 + len1;
-  const char* seg2_start = p2;
-  const char* seg2_end = (len2 > 0) ? (p2 + len2) : nullptr;
-
-  const char* cur;
-  const char* end;
-  bool in_seg1;
-  if (len1 > 0) {
-    cur = p1;
-    end = seg1_end;
-    in_seg1 = true;
-  } else if (p2 && len2 > 0) {
-    cur = p2;
-    end = seg2_end;
-    in_seg1 = false;
-  } else {
-    *consumed1 = 0;
-    *consumed2 = 0;
-    return;
-  }
-  const char* field_start = cur;
-  if (state_ == State::InQuoted && *cur == opts_.quote) {
-    field_start = cur + 1;
+std::size_t SliceCsvParser::tokenizeQuoteFree(const char* data, std::size_t len) {
+  std::size_t field_start = 0;
+  if (after_cr_) {
+    after_cr_ = false;
+    if (data[0] == LF) field_start = 1;
   }
-  bool field_start_in_seg1 = in_seg1;
-  (void)field_start_in_seg1;
-
-  auto advance = [&]() {
-    ++cur;
-    if (in_seg1 && cur >= seg1_end && seg2_start) {
-      cur = seg2_start;
-      end = seg2_end;
-      in_seg1 = false;
-    }
-  };
-
-  auto copyFieldToArena = [&](const char* from, const char* to) {
-    const std::size_t col = logical_column_index_++;
-    if (!shouldEmitColumn(col)) return;
-    if (from >= to) {
-      current_row_.push_back({arena_.used(), 0});
-      return;
-    }
-    std::size_t off = arena_.used();
-    std::size_t total = 0;
-    if (from < seg1_end) {
-      const char* end1 = (to <= seg1_end) ? to : seg1_end;
-      std::size_t part1 = static_cast<std::size_t>(end1 - from);
-      total += part1;
-      arena_.write(from, part1);
+  // Once no field is carried over from the previous span, the window is copied into the
+  // arena in one write ([copy_from, consumed)) and fields become slices of that block.
+  bool bulk = !field_open_;
+  std::size_t copy_from = field_start;
+  std::size_t base = arena_.used();
+
+  std::uint32_t* index = separator_index_.data();
+  std::size_t scanned = field_start;
+  while (scanned < len && !batch_ready_) {
+    std::size_t next_scanned = 0;
+    std::size_t count = indexSeparators(data + scanned, len - scanned, opts_.delimiter,
+                                        index, separator_index_.size(), &next_scanned,
+                                        cpu_features_);
+    for (std::size_t k = 0; k < count; ++k) {
+      std::size_t pos = scanned + index[k];
+      char c = data[pos];
+      if (after_cr_) {
+        after_cr_ = false;
+        if (c == LF && pos == field_start) {
+          field_start = pos + 1;
+          continue;
+        }
+      }
+      if (bulk) {
+        if (shouldEmitColumn(logical_column_index_))
+          current_row_.push_back({base + (field_start - copy_from), pos - field_start});
+        ++logical_column_index_;
+      } else {
+        appendToField(data + field_start, pos - field_start);
+        endField();
+        bulk = true;
+        copy_from = pos + 1;
+        base = arena_.used();
+      }
+      field_start = pos + 1;
+      state_ = State::FieldStart;
+      if (c != opts_.delimiter) {
+        noteRowEnd(data + pos);
+        emitRow();
+        after_cr_ = (c == CR);
+        if (batch_ready_) break;
+      }
     }
-    if (seg2_start && to > seg2_start) {
-      const char* start2 = (from >= seg2_start) ? from : seg2_start;
-      std::size_t part2 = static_cast<std::size_t>(to - start2);
-      total += part2;
-      arena_.write(start2, part2);
+    scanned += next_scanned;
+  }
+
+  std::size_t consumed = batch_ready_ ? field_start : len;
+  if (field_start < consumed) {
+    after_cr_ = false;
+    state_ = State::InField;
+    if (bulk) {
+      field_open_ = true;
+      field_emitted_ = shouldEmitColumn(logical_column_index_);
+      if (field_emitted_)
+        current_row_.push_back({base + (field_start - copy_from), len - field_start});
+    } else {
+      appendToField(data + field_start, len - field_start);
     }
-    current_row_.push_back({off, total});
-  };
+  }
+  if (bulk && consumed > copy_from) arena_.write(data + copy_from, consumed - copy_from);
+  return consumed;
+}
 
-  while (true) {
-    if (cur >= end) break;
+std::size_t SliceCsvParser::tokenizeStateMachine(const char* data, std::size_t len) {
+  const char* cur = data;
+  const char* end = data + len;
+  if (after_cr_) {
+    after_cr_ = false;
+    if (*cur == LF) ++cur;
+  }
+  // Bytes of the current field not yet copied to the arena start here.
+  const char* pending = cur;
+
+  while (cur < end) {
     char c = *cur;
 
     switch (state_) {
       case State::FieldStart:
         if (c == opts_.quote) {
           state_ = State::InQuoted;
-          advance();
-          field_start = cur;
-          field_start_in_seg1 = in_seg1;
+          ++cur;
+          pending = cur;
         } else if (c == opts_.delimiter) {
-          copyFieldToArena(cur, cur);
-          state_ = State::FieldStart;
-          advance();
+          endField();
+          ++cur;
         } else if (isNewline(c)) {
-          copyFieldToArena(cur, cur);
-          emitRow();
-          state_ = State::FieldStart;
-          advance();
-          if (cur < end && c == CR && *cur == LF) advance();
-          if (batch_ready_) {
-            *consumed1 = in_seg1 ? static_cast<std::size_t>(cur - p1) : len1;
-            *consumed2 = in_seg1 ? 0 : static_cast<std::size_t>(cur - p2);
-            return;
+          endRow(cur);
+          ++cur;
+          if (cur < end) {
+            after_cr_ = false;
+            if (c == CR && *cur == LF) ++cur;
           }
+          if (batch_ready_) return static_cast<std::size_t>(cur - data);
         } else {
           state_ = State::InField;
-          field_start = cur;
-          field_start_in_seg1 = in_seg1;
-          advance();
+          pending = cur;
+          ++cur;
         }
         break;
 
       case State::InField: {
-        const char* scan_start = cur;
         std::size_t scan_len = static_cast<std::size_t>(end - cur);
-        std::size_t sep = scanForSeparator(scan_start, scan_len, opts_.delimiter,
-                                          cpu_features_);
-        if (sep < scan_len) {
-          cur = scan_start + sep;
-          in_seg1 = (cur < seg1_end);
-          c = *cur;
-          if (c == opts_.delimiter) {
-            copyFieldToArena(field_start, cur);
-            state_ = State::FieldStart;
-            advance();
-          } else if (isNewline(c)) {
-            copyFieldToArena(field_start, cur);
-            emitRow();
-            state_ = State::FieldStart;
-            advance();
-            if (cur < end && c == CR && *cur == LF) advance();
-            if (batch_ready_) {
-              *consumed1 = in_seg1 ? static_cast<std::size_t>(cur - p1) : len1;
-              *consumed2 = in_seg1 ? 0 : static_cast<std::size_t>(cur - p2);
-              return;
-            }
-          }
-        } else {
+        std::size_t sep = scanForSeparator(cur, scan_len, opts_.delimiter, cpu_features_);
+        if (sep == scan_len) {
           cur = end;
-          in_seg1 = false;
+          break;
+        }
+        cur += sep;
+        c = *cur;
+        appendToField(pending, static_cast<std::size_t>(cur - pending));
+        if (c == opts_.delimiter) {
+          endField();
+          state_ = State::FieldStart;
+          ++cur;
+        } else {
+          endRow(cur);
+          ++cur;
+          if (cur < end) {
+            after_cr_ = false;
+            if (c == CR && *cur == LF) ++cur;
+          }
+          if (batch_ready_) return static_cast<std::size_t>(cur - data);
         }
         break;
       }
 
       case State::InQuoted: {
-        const char* scan_start = cur;
+        appendToField(cur, 0);  // opens the field
+        if (field_emitted_) {
+          // Copy straight into the arena, collapsing doubled quotes in the same pass.
+          std::size_t span = std::min(static_cast<std::size_t>(end - cur), kUnescapeSpan);
+          std::size_t offset = 0;
+          std::size_t written = 0;
+          char* dst = static_cast<char*>(arena_.allocate(span, 1, &offset));
+          std::size_t q = unescapeQuoted(cur, span, opts_.quote, dst, &written, cpu_features_);
+          arena_.release(span - written);
+          current_row_.back().len += written;
+          cur += q;
+          if (q < span) {
+            state_ = State::InQuotedAfterQuote;
+            ++cur;
+          }
+          pending = cur;
+          break;
+        }
         std::size_t scan_len = static_cast<std::size_t>(end - cur);
-        std::size_t q = scanForChar(scan_start, scan_len, opts_.quote,
-                                    cpu_features_);
-        if (q < scan_len) {
-          cur = scan_start + q;
-          in_seg1 = (cur < seg1_end);
-          state_ = State::InQuotedAfterQuote;
-          advance();
-        } else {
+        std::size_t q = scanForChar(cur, scan_len, opts_.quote, cpu_features_);
+        if (q == scan_len) {
           cur = end;
-          in_seg1 = false;
+          break;
         }
+        cur += q;
+        state_ = State::InQuotedAfterQuote;
+        ++cur;
+        pending = cur;
         break;
       }
 
       case State::InQuotedAfterQuote:
         if (c == opts_.quote) {
-          copyFieldToArena(field_start, cur);
-          appendQuoteToLastField();
-          advance();
-          field_start = cur;
-          field_start_in_seg1 = in_seg1;
+          appendQuoteToField();
           state_ = State::InQuoted;
-          after_doubled_quote_ = true;
+          ++cur;
+          pending = cur;
         } else if (c == opts_.delimiter) {
-          if (after_doubled_quote_ && field_start < cur) {
-            appendToLastField(field_start, static_cast<std::size_t>(cur - 1 - field_start));
-            after_doubled_quote_ = false;
-          } else if (field_start < cur) {
-            copyFieldToArena(field_start, cur - 1);
-          }
+          endField();
           state_ = State::FieldStart;
-          advance();
+          ++cur;
         } else if (isNewline(c)) {
-          if (after_doubled_quote_ && field_start < cur) {
-            appendToLastField(field_start, static_cast<std::size_t>(cur - 1 - field_start));
-            after_doubled_quote_ = false;
-          } else if (field_start < cur) {
-            copyFieldToArena(field_start, cur - 1);
-          }
-          emitRow();
-          state_ = State::FieldStart;
-          advance();
-          if (cur < end && c == CR && *cur == LF) advance();
-          if (batch_ready_) {
-            *consumed1 = in_seg1 ? static_cast<std::size_t>(cur - p1) : len1;
-            *consumed2 = in_seg1 ? 0 : static_cast<std::size_t>(cur - p2);
-            return;
+          endRow(cur);
+          ++cur;
+          if (cur < end) {
+            after_cr_ = false;
+            if (c == CR && *cur == LF) ++cur;
           }
+          if (batch_ready_) return static_cast<std::size_t>(cur - data);
         } else {
+          // Text after a closing quote continues the same field.
           state_ = State::InField;
-          field_start = cur;
-          field_start_in_seg1 = in_seg1;
-          advance();
+          pending = cur;
+          ++cur;
         }
         break;
     }
   }
 
-  *consumed1 = len1;
-  *consumed2 = (p2 && len2 > 0) ? len2 : 0;
+  if (state_ == State::InField || state_ == State::InQuoted) {
+    appendToField(pending, static_cast<std::size_t>(end - pending));
+  }
+  return len;
+}
+
+std::size_t SliceCsvParser::replayDfaEvents(const char* in, const char* out,
+                                            std::size_t out_begin, std::size_t out_end,
+                                            const std::uint32_t* events, std::size_t count) {
+  // Field bytes out[out_begin, out_end) are copied to the arena in one write; fields
+  // become slices of it (a field carried over from the previous pass is extended).
+  std::size_t base = arena_.used();
+  std::size_t field_start = out_begin;
+  std::size_t stop = kNoStop;
+  for (std::size_t k = 0; k < count; ++k) {
+    std::size_t field_end = events[k] >> 16;
+    if (field_open_) {
+      if (field_emitted_) current_row_.back().len += field_end - field_start;
+    } else if (shouldEmitColumn(logical_column_index_)) {
+      current_row_.push_back({base + (field_start - out_begin), field_end - field_start});
+    }
+    field_open_ = false;
+    ++logical_column_index_;
+    field_start = field_end;
+    if (events[k] & 1u) {
+      std::size_t row_end = (events[k] & 0xffffu) >> 1;
+      noteRowEnd(in + row_end);
+      emitRow();
+      if (batch_ready_) {
+        stop = row_end;
+        out_end = field_end;
+        break;
+      }
+    }
+  }
+  if (stop == kNoStop && field_start < out_end) {
+    if (field_open_) {
+      if (field_emitted_) current_row_.back().len += out_end - field_start;
+    } else {
+      field_open_ = true;
+      field_emitted_ = shouldEmitColumn(logical_column_index_);
+      if (field_emitted_)
+        current_row_.push_back({base + (field_start - out_begin), out_end - field_start});
+    }
+  }
+  if (out_end > out_begin) arena_.write(out + out_begin, out_end - out_begin);
+  return stop;
+}
+
+std::size_t SliceCsvParser::tokenizeDfa(const char* data, std::size_t len) {
+  unsigned state;
+  switch (state_) {
+    case State::InField: state = kDfaInField; break;
+    case State::InQuoted: state = kDfaInQuoted; break;
+    case State::InQuotedAfterQuote: state = kDfaAfterQuote; break;
+    default: state = after_cr_ ? kDfaAfterCR : kDfaFieldStart; break;
+  }
+  after_cr_ = false;
+
+  const std::uint8_t* table = dfa_table_.data();
+  char* out = dfa_out_.data();
+  std::uint32_t* events = dfa_events_.data();
+  std::size_t consumed = 0;
+
+  while (consumed < len && !batch_ready_) {
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(data + consumed);
+    std::size_t n = std::min(len - consumed, kDfaPass);
+
+    // Two interleaved streams: the second starts after an LF near the middle of the
+    // pass, speculatively in FieldStart. The guess only fails when that LF is quoted,
+    // in which case the second stream is re-run from the first stream's end state.
+    std::size_t split = n;
+    if (n >= kDfaMinSplit) {
+      const void* lf = std::memchr(in + n / 2, LF, n - n / 2 - 1);
+      if (lf) split = static_cast<std::size_t>(static_cast<const unsigned char*>(lf) - in) + 1;
+    }
+    // Stream B's field bytes and events are stored from index split: neither stream
+    // produces more of them than it reads, so the two never overlap.
+    unsigned state_b = kDfaFieldStart;
+    std::uint32_t o_a = 0;
+    std::uint32_t o_b = static_cast<std::uint32_t>(split);
+    std::size_t e_a = 0;
+    std::size_t e_b = split;
+    runDfa2(table, in, split, n, state, state_b, out, o_a, o_b, events, e_a, e_b);
+    if (split < n) {
+      if (state != kDfaFieldStart) {
+        state_b = state;
+        o_b = static_cast<std::uint32_t>(split);
+        e_b = split;
+        runDfa(table, in, split, n, state_b, out, o_b, events, e_b);
+      }
+      state = state_b;
+    }
+
+    const char* pass = data + consumed;
+    std::size_t stop = replayDfaEvents(pass, out, 0, o_a, events, e_a);
+    if (stop == kNoStop && split < n)
+      stop = replayDfaEvents(pass, out, split, o_b, events + split, e_b - split);
+    if (stop != kNoStop) {
+      state = in[stop] == CR ? kDfaAfterCR : kDfaFieldStart;
+      consumed += stop + 1;
+    } else {
+      consumed += n;
+    }
+  }
+
+  switch (state) {
+    case kDfaInField: state_ = State::InField; break;
+    case kDfaInQuoted: state_ = State::InQuoted; break;
+    case kDfaAfterQuote: state_ = State::InQuotedAfterQuote; break;
+    default:
+      state_ = State::FieldStart;
+      after_cr_ = state == kDfaAfterCR;
+      break;
+  }
+  return consumed;
+}
+
+void describeBatch(const SliceBatch& batch, std::size_t first, bool row_offsets,
+                   BatchInfo& out) {
+  const std::vector<std::uint64_t>& offsets = batch.row_offsets;
+  out.byte_end = batch.byte_end;
+  out.byte_start = first < offsets.size() ? offsets[first] : batch.byte_end;
+  out.row_offsets.clear();
+  if (row_offsets && first < offsets.size())
+    out.row_offsets.assign(offsets.begin() + static_cast<std::ptrdiff_t>(first), offsets.end());
 }
 
 }  // namespace ultratab
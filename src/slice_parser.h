@@ -5,6 +5,7 @@
 #include "csv_parser.h"
 #include "simd_scanner.h"
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace ultratab {
@@ -24,20 +25,53 @@ using SliceRow = std::vector<FieldSlice>;
 struct SliceBatch {
   std::vector<char> arena;
   std::vector<SliceRow> rows;
+  /// With offset tracking: the source byte offset where each row starts, and the offset
+  /// of the last row's line terminator (end of input for an unterminated last row).
+  std::vector<std::uint64_t> row_offsets;
+  std::uint64_t byte_end = 0;
   std::size_t rowsCount() const { return rows.size(); }
 };
 
+/// How much provenance the streaming parsers attach to each batch (batchInfo option).
+enum class BatchInfoMode { Off, Ranges, RowOffsets };
+
+/// Where an emitted batch came from. Byte offsets are into the source file; rows are
+/// numbered from 0 and exclude the header.
+struct BatchInfo {
+  std::uint64_t first_row = 0;
+  /// [byte_start, byte_end) spans the batch's rows without the final line terminator.
+  std::uint64_t byte_start = 0;
+  std::uint64_t byte_end = 0;
+  std::uint64_t tokenize_ns = 0;
+  std::uint64_t build_ns = 0;
+  /// Start offset of every row; filled only in BatchInfoMode::RowOffsets.
+  std::vector<std::uint64_t> row_offsets;
+};
+
+/// Fill \a out's byte range (and row offsets, when \a row_offsets) for rows
+/// [first, rowsCount()) of a batch taken with offset tracking on.
+void describeBatch(const SliceBatch& batch, std::size_t first, bool row_offsets,
+                   BatchInfo& out);
+
 /// CSV state machine that operates on byte spans and emits field slices
 /// (offset + len) into a per-batch arena. Minimal allocations: one arena per batch.
+///
+/// Input is tokenized in windows of kQuoteFreeWindow bytes. A window that contains no
+/// quote character (checked with one SIMD scan) is split on delimiter/newline bitmasks
+/// without the per-byte state machine; any other window runs the full state machine.
+/// With TokenizerEngine::Dfa every window runs a table-driven state machine instead
+/// (state x byte -> next state + action bits), which needs no SIMD and has no
+/// data-dependent branches in its inner loop.
 class SliceCsvParser {
  public:
   explicit SliceCsvParser(const CsvOptions& options);
 
-  /// Feed more data. Segment (ptr, len) valid only during this call.
-  /// Optional first segment (remainder from previous feed); use (nullptr, 0) if none.
-  void feed(const char* seg1, std::size_t len1, const char* seg2, std::size_t len2);
+  /// Tokenize data[0..len). Returns bytes consumed: len, or less when a batch became
+  /// ready (take it, then feed the rest). A field cut by the end of the span is copied
+  /// into the arena and continued by the next feed, so \a data is only borrowed.
+  std::size_t feed(const char* data, std::size_t len);
 
-  /// Call when no more data. Flushes any partial row; remainder() then holds unprocessed.
+  /// Call when no more data. Completes the last (unterminated) row, if any.
   void flush();
 
   /// True if a full batch is available; then call takeBatch().
@@ -46,8 +80,10 @@ class SliceCsvParser {
   /// Take the completed batch. Call only when hasBatch() is true.
   SliceBatch takeBatch();
 
-  /// Unprocessed tail after last feed/flush (for next feed as seg1).
-  void getRemainder(const char** out_ptr, std::size_t* out_len) const;
+  /// Take the completed batch into \a out, reusing its storage: the arena copy fills
+  /// out.arena's capacity and the row vectors \a out held are kept for later rows, so a
+  /// producer that passes the same SliceBatch every time stops allocating once warm.
+  void takeBatch(SliceBatch& out);
 
   /// Skip one row (e.g. header). Uses same state machine without storing row.
   void skipOneRow();
@@ -58,12 +94,19 @@ class SliceCsvParser {
   /// Optional: set to record arena and parse metrics when ULTRATAB_PROFILE is enabled.
   void setMetrics(PipelineMetrics* m);
 
-  /// Arena block size in bytes (1MB–16MB). Used only at construction.
+  /// Maximum arena block size in bytes (1MB–16MB); blocks start smaller and grow.
   static constexpr std::size_t kArenaBlockSize = 1024 * 1024;
 
+  /// Bytes per quote check; windows without a quote take the quote-free kernel.
+  static constexpr std::size_t kQuoteFreeWindow = 64 * 1024;
+
   /// When non-empty, only these column indices (0-based) are emitted and copied to arena.
   void setSelectedColumnIndices(std::vector<std::size_t> indices);
 
+  /// Record each row's source byte offset into SliceBatch::row_offsets. Offsets count
+  /// every byte passed to feed() since construction, so feed the file from its start.
+  void setTrackOffsets(bool track) { track_offsets_ = track; }
+
  private:
   bool shouldEmitColumn(std::size_t logical_col_idx) const;
   enum class State {
@@ -73,33 +116,69 @@ class SliceCsvParser {
     InQuotedAfterQuote,
   };
 
-  void processTwoSegments(const char* p1, std::size_t len1,
-                          const char* p2, std::size_t len2,
-                          std::size_t* consumed1, std::size_t* consumed2);
-  void emitField(const char* start, std::size_t len);
-  void appendQuoteToLastField();
-  void appendToLastField(const char* start, std::size_t len);
+  std::size_t tokenizeQuoteFree(const char* data, std::size_t len);
+  std::size_t tokenizeStateMachine(const char* data, std::size_t len);
+  std::size_t tokenizeDfa(const char* data, std::size_t len);
+  /// Apply one DFA stream's field-end events; returns the input offset of the row end
+  /// that completed a batch, or SIZE_MAX.
+  std::size_t replayDfaEvents(const char* in, const char* out, std::size_t out_begin,
+                              std::size_t out_end, const std::uint32_t* events,
+                              std::size_t count);
+  void buildDfaTable();
+  void appendToField(const char* start, std::size_t len);
+  void appendQuoteToField();
+  void endField();
+  void endRow(const char* nl);
+  /// Offset tracking: the row being completed ends at the line terminator \a nl.
+  void noteRowEnd(const char* nl) {
+    if (track_offsets_) noteRowEndSlow(nl);
+  }
+  void noteRowEndSlow(const char* nl);
   void emitRow();
   void startNewBatch();
+  void recycleRows(std::vector<SliceRow>& rows);
 
   CsvOptions opts_;
   CpuFeatures cpu_features_;
+  bool use_dfa_ = false;
   State state_ = State::FieldStart;
-  std::vector<char> remainder_;
   Arena arena_;
   std::vector<FieldSlice> current_row_;
   std::vector<SliceRow> current_batch_;
+  /// Cleared row vectors from taken batches; emitRow() starts the next row in one.
+  std::vector<SliceRow> spare_rows_;
+  std::vector<std::uint32_t> separator_index_;
+  /// DFA engine: 256 entries per state; per-block field bytes and field-end events.
+  std::vector<std::uint8_t> dfa_table_;
+  std::vector<char> dfa_out_;
+  std::vector<std::uint32_t> dfa_events_;
   std::size_t batch_size_;
   bool batch_ready_ = false;
   bool skip_next_row_ = false;
-  bool row_ready_ = false;
+  /// Row ended on CR; an LF starting the next span belongs to the same CRLF.
+  bool after_cr_ = false;
+  /// Current field already has bytes (or its slice) recorded in the arena.
+  bool field_open_ = false;
+  bool field_emitted_ = false;
+
+  /// Offset tracking. The span passed to the current feed() starts at stream offset
+  /// span_base_; row_start_ is where the row being accumulated began. A CR ending the
+  /// span leaves lf_check_pending_ so the next feed can step row_start_ over its LF.
+  bool track_offsets_ = false;
+  std::uint64_t fed_ = 0;
+  std::uint64_t span_base_ = 0;
+  const char* span_data_ = nullptr;
+  const char* span_end_ = nullptr;
+  std::uint64_t row_start_ = 0;
+  std::uint64_t row_end_ = 0;
+  std::uint64_t next_row_start_ = 0;
+  bool lf_check_pending_ = false;
+  std::vector<std::uint64_t> row_offsets_;
+  std::uint64_t batch_byte_end_ = 0;
 
-  std::size_t seg1_consumed_ = 0;
-  std::size_t seg2_consumed_ = 0;
   PipelineMetrics* metrics_ = nullptr;
   std::vector<std::size_t> selected_column_indices_;
   std::size_t logical_column_index_ = 0;
-  bool after_doubled_quote_ = false;
 };
 
 }  // namespace ultratab
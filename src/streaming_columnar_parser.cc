@@ -1,7 +1,8 @@
 #include "streaming_columnar_parser.h"
+#include "alloc_stats.h"
+#include "perf_counters.h"
 #include "pipeline_metrics.h"
 #include <cerrno>
-#include <chrono>
 #include <cstring>
 #include <vector>
 
@@ -15,13 +16,20 @@ const std::size_t kDefaultReadBufferSize = 256 * 1024;
 
 StreamingColumnarParser::StreamingColumnarParser(
     const std::string& path, const ColumnarOptions& options,
-    std::size_t max_queue_batches, bool use_mmap, std::size_t read_buffer_size)
+    std::size_t max_queue_batches, bool use_mmap, std::size_t read_buffer_size,
+    std::size_t trace_capacity, bool perf_counters, BatchInfoMode batch_info)
     : path_(path),
       options_(options),
+      nulls_(options.null_values),
       max_queue_batches_(max_queue_batches > 0 ? max_queue_batches : 2),
       read_buffer_size_(read_buffer_size > 0 ? read_buffer_size : kDefaultReadBufferSize),
       use_mmap_(use_mmap),
-      queue_(max_queue_batches_) {
+      perf_counters_(perf_counters),
+      batch_info_(batch_info),
+      queue_(std::make_shared<RingQueue<ColumnarBatchResult>>(max_queue_batches_)),
+      metrics_(std::make_shared<PipelineMetrics>()),
+      registration_(ParserKind::Columnar, metrics_.get(), [this] { return queue_->size(); }) {
+  if (trace_capacity > 0) tracer_ = std::make_shared<TraceRecorder>(trace_capacity);
   thread_ = std::thread(&StreamingColumnarParser::run, this);
 }
 
@@ -32,7 +40,7 @@ StreamingColumnarParser::~StreamingColumnarParser() {
 
 void StreamingColumnarParser::stop() {
   stop_requested_.store(true);
-  queue_.cancel();
+  queue_->cancel();
 }
 
 void StreamingColumnarParser::run() {
@@ -45,7 +53,7 @@ void StreamingColumnarParser::run() {
     ColumnarBatchResult r;
     r.kind = ColumnarResultKind::Error;
     r.error_message = reader.errorMessage();
-    queue_.push(std::move(r));
+    queue_->push(std::move(r));
     return;
   }
 
@@ -54,10 +62,15 @@ void StreamingColumnarParser::run() {
   parser_opts.quote = options_.quote;
   parser_opts.has_header = false;
   parser_opts.batch_size = options_.batch_size;
+  parser_opts.engine = options_.engine;
 
   SliceCsvParser parser(parser_opts);
-  if (profileEnabled()) parser.setMetrics(&metrics_);
+  if (profileEnabled()) parser.setMetrics(metrics_.get());
   // Header row is taken from first batch's first row when has_header is true
+  bool row_offsets = batch_info_ == BatchInfoMode::RowOffsets;
+  if (batch_info_ != BatchInfoMode::Off) parser.setTrackOffsets(true);
+  // Index of the next batch's first data row, for batch info.
+  std::uint64_t next_row = 0;
 
   std::vector<std::string> headers;
   std::vector<std::string> selected_headers;
@@ -68,45 +81,39 @@ void StreamingColumnarParser::run() {
     for (const auto& p : options_.schema) headers.push_back(p.first);
     headers_set = true;
   }
+  // Reused across batches: takeBatch() refills its arena copy and row vectors.
+  SliceBatch slice_batch;
+  // Tokenize time of the batch being filled; a batch can span several chunks.
+  std::uint64_t tokenize_ticks = 0;
+  TraceRecorder* tracer = tracer_.get();
+  std::uint64_t batch_seq = 0;
+  // Counters count the opening thread, so they are opened here rather than in the ctor.
+  std::unique_ptr<PerfCounters> counters;
+  if (perf_counters_) {
+    counters.reset(new PerfCounters());
+    metrics_->hw_event_mask.store(counters->eventMask());
+    if (!counters->available()) counters.reset();
+  }
+  const PerfCounters* hw = counters.get();
 
-  std::vector<char> remainder;
-  const char* seg1 = nullptr;
-  std::size_t len1 = 0;
-
-  while (!stop_requested_.load()) {
-    auto t_read_start = std::chrono::steady_clock::now();
-    ByteSpan chunk = reader.getNext();
-    auto t_read_end = std::chrono::steady_clock::now();
-    if (profileEnabled()) {
-      metrics_.read_time_ns.fetch_add(
-          static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
-              t_read_end - t_read_start).count()));
-    }
-    if (chunk.empty() && len1 == 0) break;
-
-    auto t_parse_start = std::chrono::steady_clock::now();
-    parser.feed(seg1, len1, chunk.data, chunk.size);
-    seg1 = nullptr;
-    len1 = 0;
-
-    const char* rem_ptr = nullptr;
-    std::size_t rem_len = 0;
-    parser.getRemainder(&rem_ptr, &rem_len);
-    if (rem_ptr && rem_len > 0) {
-      remainder.assign(rem_ptr, rem_ptr + rem_len);
-      seg1 = remainder.data();
-      len1 = remainder.size();
-    }
+  // Parse time of the batch being filled, from its first chunk byte to its build.
+  std::uint64_t t_parse_start = CycleClock::now();
 
-    while (parser.hasBatch()) {
-      SliceBatch slice_batch = parser.takeBatch();
-      if (profileEnabled()) metrics_.batch_allocations.fetch_add(1);
-      const char* arena = slice_batch.arena.data();
-      std::size_t arena_size = slice_batch.arena.size();
+  // Takes the header from slice_batch if still needed, then builds and queues the rest;
+  // shared by the read loop and the flush so both record the same metrics, trace spans
+  // and batch info. False once the run should end (queue cancelled or no header).
+  auto emitBatch = [&]() -> bool {
+    std::uint64_t tokenize_ns = CycleClock::toNs(tokenize_ticks);
+    metrics_->tokenize_latency.record(tokenize_ns);
+    tokenize_ticks = 0;
+    if (profileEnabled()) metrics_->batch_allocations.fetch_add(1);
+    // Rows of slice_batch before this one were the header; offsets still include it.
+    std::size_t first = 0;
 
-      if (!headers_set) {
-        if (slice_batch.rows.empty()) break;
-        headers = sliceRowToStrings(slice_batch.rows[0], arena, arena_size);
+    if (!headers_set) {
+      if (!slice_batch.rows.empty()) {
+        headers = sliceRowToStrings(slice_batch.rows[0], slice_batch.arena.data(),
+                                    slice_batch.arena.size());
         headers_set = true;
         if (!options_.select.empty()) {
           for (const std::string& name : options_.select) {
@@ -120,145 +127,162 @@ void StreamingColumnarParser::run() {
           }
           parser.setSelectedColumnIndices(selected_indices);
         }
-        if (slice_batch.rows.size() == 1) {
-          ColumnarBatch empty_batch;
-          empty_batch.headers = headers;
-          empty_batch.rows = 0;
-          ColumnarBatchResult result;
-          result.kind = ColumnarResultKind::Batch;
-          result.batch = std::move(empty_batch);
-          if (!queue_.push(std::move(result))) goto done;
-          metrics_.batches_emitted.fetch_add(1);
+      }
+      if (slice_batch.rows.size() <= 1) {
+        if (!headers_set || slice_batch.rows.empty()) return true;
+        ColumnarBatch empty_batch;
+        empty_batch.headers = selected_headers.empty() ? headers : selected_headers;
+        empty_batch.rows = 0;
+        ColumnarBatchResult result;
+        result.kind = ColumnarResultKind::Batch;
+        result.batch = std::move(empty_batch);
+        result.sequence = batch_seq++;
+        if (batch_info_ != BatchInfoMode::Off) {
+          result.has_info = true;
+          describeBatch(slice_batch, 1, row_offsets, result.info);
+          result.info.tokenize_ns = tokenize_ns;
         }
-        if (slice_batch.rows.size() <= 1) continue;
-        slice_batch.rows.erase(slice_batch.rows.begin());
+        if (!queue_->push(std::move(result))) return false;
+        metrics_->batches_emitted.fetch_add(1);
+        return true;
       }
+      slice_batch.rows.erase(slice_batch.rows.begin());
+      first = 1;
+    }
 
-      if (headers.empty()) {
-        ColumnarBatchResult r;
-        r.kind = ColumnarResultKind::Error;
-        r.error_message = "Could not parse header row";
-        queue_.push(std::move(r));
-        goto done;
-      }
+    if (headers.empty()) {
+      ColumnarBatchResult r;
+      r.kind = ColumnarResultKind::Error;
+      r.error_message = "Could not parse header row";
+      queue_->push(std::move(r));
+      return false;
+    }
 
-      auto t_build_start = std::chrono::steady_clock::now();
-      ColumnarBatch col_batch;
-      if (!slice_batch.rows.empty()) {
-        const std::vector<std::string>& build_headers =
-            (first_data_batch_built && !selected_headers.empty()) ? selected_headers : headers;
-        ColumnarOptions build_opts = options_;
-        if (first_data_batch_built && !selected_headers.empty()) build_opts.select = selected_headers;
-        buildColumnarBatch(slice_batch, build_headers, build_opts, col_batch);
-        first_data_batch_built = true;
-      } else {
-        col_batch.headers = selected_headers.empty() ? headers : selected_headers;
-        col_batch.rows = 0;
-      }
-      auto t_build_end = std::chrono::steady_clock::now();
-      if (profileEnabled()) {
-        metrics_.build_time_ns.fetch_add(
-            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
-                t_build_end - t_build_start).count()));
+    std::uint64_t t_build_start = CycleClock::now();
+    ColumnarBatch col_batch;
+    {
+      TraceSpan span(tracer, TraceStage::Build, TraceTrack::Worker, batch_seq);
+      AllocStageScope alloc_scope(metrics_.get(), AllocStage::Build);
+      HwStageScope hw_scope(hw, metrics_.get(), HwStage::Build);
+      const std::vector<std::string>& build_headers =
+          (first_data_batch_built && !selected_headers.empty()) ? selected_headers : headers;
+      if (options_.infer_schema && !first_data_batch_built)
+        inferSchema(slice_batch, headers, nulls_, options_);
+      ColumnarOptions build_opts = options_;
+      if (first_data_batch_built && !selected_headers.empty()) build_opts.select = selected_headers;
+      buildColumnarBatch(slice_batch, build_headers, build_opts, nulls_, col_batch);
+      first_data_batch_built = true;
+      // Columns widened by this batch stay widened for the rest of the file.
+      if (options_.infer_schema) {
+        for (const auto& p : col_batch.columns) options_.schema[p.first] = p.second.type;
       }
+    }
+    std::uint64_t build_ns = CycleClock::elapsedNs(t_build_start);
+    metrics_->build_latency.record(build_ns);
+    if (profileEnabled()) metrics_->build_time_ns.fetch_add(build_ns);
+    metrics_->rows_parsed.fetch_add(col_batch.rows);
+    metrics_->parse_time_ns.fetch_add(CycleClock::elapsedNs(t_parse_start));
 
-      metrics_.rows_parsed.fetch_add(col_batch.rows);
-      auto t_parse_end = std::chrono::steady_clock::now();
-      metrics_.parse_time_ns.fetch_add(
-          static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
-              t_parse_end - t_parse_start).count()));
-
-      auto t_push_start = std::chrono::steady_clock::now();
+    std::uint64_t t_push_start = CycleClock::now();
+    {
+      TraceSpan span(tracer, TraceStage::Push, TraceTrack::Worker, batch_seq);
+      AllocStageScope alloc_scope(metrics_.get(), AllocStage::Emit);
       ColumnarBatchResult result;
       result.kind = ColumnarResultKind::Batch;
-      result.batch = std::move(col_batch);
-      if (!queue_.push(std::move(result))) goto done;
-      auto t_push_end = std::chrono::steady_clock::now();
-      metrics_.queue_wait_ns.fetch_add(
-          static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
-              t_push_end - t_push_start).count()));
-      if (profileEnabled()) {
-        metrics_.emit_time_ns.fetch_add(
-            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
-                t_push_end - t_push_start).count()));
+      if (batch_info_ != BatchInfoMode::Off) {
+        result.has_info = true;
+        describeBatch(slice_batch, first, row_offsets, result.info);
+        result.info.first_row = next_row;
+        result.info.tokenize_ns = tokenize_ns;
+        result.info.build_ns = build_ns;
       }
-      metrics_.batches_emitted.fetch_add(1);
-      t_parse_start = std::chrono::steady_clock::now();
+      next_row += col_batch.rows;
+      result.batch = std::move(col_batch);
+      result.sequence = batch_seq;
+      if (!queue_->push(std::move(result))) return false;
     }
+    ++batch_seq;
+    std::uint64_t push_ns = CycleClock::elapsedNs(t_push_start);
+    metrics_->queue_wait_ns.fetch_add(push_ns);
+    metrics_->queue_wait_latency.record(push_ns);
+    if (profileEnabled()) metrics_->emit_time_ns.fetch_add(push_ns);
+    metrics_->batches_emitted.fetch_add(1);
+    t_parse_start = CycleClock::now();
+    return true;
+  };
 
-    if (chunk.empty()) {
-      if (seg1 && len1 > 0) parser.feed(seg1, len1, nullptr, 0);
-      parser.flush();
-      break;
+  while (!stop_requested_.load()) {
+    std::uint64_t t_read_start = CycleClock::now();
+    ByteSpan chunk;
+    {
+      TraceSpan span(tracer, TraceStage::Read, TraceTrack::Worker, batch_seq);
+      AllocStageScope alloc_scope(metrics_.get(), AllocStage::Read);
+      HwStageScope hw_scope(hw, metrics_.get(), HwStage::Read);
+      chunk = reader.getNext();
     }
-    metrics_.bytes_read.fetch_add(chunk.size);
-  }
-
-  if (seg1 && len1 > 0)
-    parser.feed(seg1, len1, nullptr, 0);
-  parser.flush();
+    std::uint64_t read_ns = CycleClock::elapsedNs(t_read_start);
+    metrics_->read_latency.record(read_ns);
+    if (profileEnabled()) metrics_->read_time_ns.fetch_add(read_ns);
+    if (chunk.empty()) break;
 
-  while (parser.hasBatch()) {
-    SliceBatch slice_batch = parser.takeBatch();
-    if (profileEnabled()) metrics_.batch_allocations.fetch_add(1);
-    if (!headers_set) {
-      if (!slice_batch.rows.empty()) {
-        headers = sliceRowToStrings(slice_batch.rows[0], slice_batch.arena.data(),
-                                    slice_batch.arena.size());
-        headers_set = true;
-        if (!options_.select.empty()) {
-          selected_indices.clear();
-          selected_headers.clear();
-          for (const std::string& name : options_.select) {
-            for (std::size_t i = 0; i < headers.size(); ++i) {
-              if (headers[i] == name) {
-                selected_indices.push_back(i);
-                selected_headers.push_back(headers[i]);
-                break;
-              }
-            }
-          }
-          parser.setSelectedColumnIndices(selected_indices);
-        }
+    t_parse_start = CycleClock::now();
+    std::size_t consumed = 0;
+    while (consumed < chunk.size) {
+      {
+        std::uint64_t t_tokenize_start = CycleClock::now();
+        TraceSpan span(tracer, TraceStage::Tokenize, TraceTrack::Worker, batch_seq);
+        AllocStageScope alloc_scope(metrics_.get(), AllocStage::Tokenize);
+        HwStageScope hw_scope(hw, metrics_.get(), HwStage::Tokenize);
+        consumed += parser.feed(chunk.data + consumed, chunk.size - consumed);
+        tokenize_ticks += CycleClock::now() - t_tokenize_start;
       }
-      if (slice_batch.rows.size() <= 1) {
-        if (headers_set && slice_batch.rows.size() == 1) {
-          ColumnarBatch empty_batch;
-          empty_batch.headers = selected_headers.empty() ? headers : selected_headers;
-          empty_batch.rows = 0;
-          ColumnarBatchResult result;
-          result.kind = ColumnarResultKind::Batch;
-          result.batch = std::move(empty_batch);
-          queue_.push(std::move(result));
+      while (parser.hasBatch()) {
+        {
+          std::uint64_t t_tokenize_start = CycleClock::now();
+          TraceSpan span(tracer, TraceStage::Tokenize, TraceTrack::Worker, batch_seq);
+          AllocStageScope alloc_scope(metrics_.get(), AllocStage::Tokenize);
+          HwStageScope hw_scope(hw, metrics_.get(), HwStage::Tokenize);
+          parser.takeBatch(slice_batch);
+          tokenize_ticks += CycleClock::now() - t_tokenize_start;
         }
-        continue;
+        if (!emitBatch()) goto done;
       }
-      slice_batch.rows.erase(slice_batch.rows.begin());
     }
-    ColumnarBatch col_batch;
-    const std::vector<std::string>& build_headers =
-        (first_data_batch_built && !selected_headers.empty()) ? selected_headers : headers;
-    ColumnarOptions build_opts = options_;
-    if (first_data_batch_built && !selected_headers.empty()) build_opts.select = selected_headers;
-    buildColumnarBatch(slice_batch, build_headers, build_opts, col_batch);
-    first_data_batch_built = true;
-    metrics_.rows_parsed.fetch_add(col_batch.rows);
-    ColumnarBatchResult result;
-    result.kind = ColumnarResultKind::Batch;
-    result.batch = std::move(col_batch);
-    if (!queue_.push(std::move(result))) goto done;
-    metrics_.batches_emitted.fetch_add(1);
+
+    metrics_->bytes_read.fetch_add(chunk.size);
+  }
+
+  t_parse_start = CycleClock::now();
+  {
+    std::uint64_t t_tokenize_start = CycleClock::now();
+    TraceSpan span(tracer, TraceStage::Tokenize, TraceTrack::Worker, batch_seq);
+    AllocStageScope alloc_scope(metrics_.get(), AllocStage::Tokenize);
+    HwStageScope hw_scope(hw, metrics_.get(), HwStage::Tokenize);
+    parser.flush();
+    tokenize_ticks += CycleClock::now() - t_tokenize_start;
+  }
+
+  while (parser.hasBatch()) {
+    {
+      std::uint64_t t_tokenize_start = CycleClock::now();
+      TraceSpan span(tracer, TraceStage::Tokenize, TraceTrack::Worker, batch_seq);
+      AllocStageScope alloc_scope(metrics_.get(), AllocStage::Tokenize);
+      HwStageScope hw_scope(hw, metrics_.get(), HwStage::Tokenize);
+      parser.takeBatch(slice_batch);
+      tokenize_ticks += CycleClock::now() - t_tokenize_start;
+    }
+    if (!emitBatch()) goto done;
   }
 
-  metrics_.bytes_read.store(reader.bytesRead());
+  metrics_->bytes_read.store(reader.bytesRead());
 
   if (!headers_set && options_.has_header) {
     ColumnarBatchResult r;
     r.kind = ColumnarResultKind::Error;
     r.error_message = "Could not parse header row";
-    queue_.push(std::move(r));
+    queue_->push(std::move(r));
   } else {
-    queue_.push(ColumnarBatchResult{ColumnarResultKind::Done, ColumnarBatch{}, ""});
+    queue_->push(ColumnarBatchResult{ColumnarResultKind::Done, ColumnarBatch{}, ""});
   }
 
 done:
@@ -4,11 +4,14 @@
 #include "batch_builder.h"
 #include "columnar_parser.h"
 #include "csv_parser.h"
+#include "metrics_registry.h"
 #include "pipeline_metrics.h"
 #include "reader.h"
 #include "ring_queue.h"
 #include "slice_parser.h"
+#include "trace_recorder.h"
 #include <atomic>
+#include <memory>
 #include <thread>
 
 namespace ultratab {
@@ -19,6 +22,11 @@ struct ColumnarBatchResult {
   ColumnarResultKind kind = ColumnarResultKind::Done;
   ColumnarBatch batch;
   std::string error_message;
+  /// Batch sequence number (0-based) for trace events.
+  std::uint64_t sequence = 0;
+  /// Provenance, when the parser was created with a BatchInfoMode other than Off.
+  bool has_info = false;
+  BatchInfo info{};
 };
 
 /// Streaming columnar CSV: Reader → SliceParser → BuildColumnar → RingQueue.
@@ -28,15 +36,30 @@ class StreamingColumnarParser {
                           const ColumnarOptions& options,
                           std::size_t max_queue_batches = 2,
                           bool use_mmap = false,
-                          std::size_t read_buffer_size = 0);
+                          std::size_t read_buffer_size = 0,
+                          std::size_t trace_capacity = 0,
+                          bool perf_counters = false,
+                          BatchInfoMode batch_info = BatchInfoMode::Off);
   ~StreamingColumnarParser();
 
   StreamingColumnarParser(const StreamingColumnarParser&) = delete;
   StreamingColumnarParser& operator=(const StreamingColumnarParser&) = delete;
 
-  RingQueue<ColumnarBatchResult>& queue() { return queue_; }
-  const RingQueue<ColumnarBatchResult>& queue() const { return queue_; }
-  const PipelineMetrics& metrics() const { return metrics_; }
+  RingQueue<ColumnarBatchResult>& queue() { return *queue_; }
+  const RingQueue<ColumnarBatchResult>& queue() const { return *queue_; }
+  const PipelineMetrics& metrics() const { return *metrics_; }
+  PipelineMetrics& metrics() { return *metrics_; }
+
+  /// Shared so a pending getNextColumnarBatch can pop and record after the parser is destroyed.
+  const std::shared_ptr<RingQueue<ColumnarBatchResult>>& sharedQueue() const { return queue_; }
+  const std::shared_ptr<PipelineMetrics>& sharedMetrics() const { return metrics_; }
+
+  /// Trace recorder when created with a trace capacity; null otherwise.
+  TraceRecorder* tracer() { return tracer_.get(); }
+  /// Shared so a pending getNextColumnarBatch can close its spans after the parser is destroyed.
+  const std::shared_ptr<TraceRecorder>& sharedTracer() const { return tracer_; }
+
+  BatchInfoMode batchInfoMode() const { return batch_info_; }
 
   void stop();
 
@@ -45,11 +68,17 @@ class StreamingColumnarParser {
 
   std::string path_;
   ColumnarOptions options_;
+  /// options_.null_values, compiled once for every batch.
+  NullMatcher nulls_;
   std::size_t max_queue_batches_;
   std::size_t read_buffer_size_;
   bool use_mmap_;
-  RingQueue<ColumnarBatchResult> queue_;
-  PipelineMetrics metrics_;
+  bool perf_counters_;
+  BatchInfoMode batch_info_;
+  std::shared_ptr<RingQueue<ColumnarBatchResult>> queue_;
+  std::shared_ptr<PipelineMetrics> metrics_;
+  MetricsRegistration registration_;
+  std::shared_ptr<TraceRecorder> tracer_;
   std::thread thread_;
   std::atomic<bool> stop_requested_{false};
 };
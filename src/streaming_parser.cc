@@ -1,7 +1,8 @@
 #include "streaming_parser.h"
+#include "alloc_stats.h"
+#include "perf_counters.h"
 #include "pipeline_metrics.h"
 #include <cerrno>
-#include <chrono>
 #include <cstring>
 #include <vector>
 
@@ -17,13 +18,24 @@ StreamingCsvParser::StreamingCsvParser(const std::string& path,
                                        const CsvOptions& options,
                                        std::size_t max_queue_batches,
                                        bool use_mmap,
-                                       std::size_t read_buffer_size)
+                                       std::size_t read_buffer_size,
+                                       bool pooled,
+                                       std::size_t trace_capacity,
+                                       bool perf_counters,
+                                       BatchInfoMode batch_info)
     : path_(path),
       options_(options),
       max_queue_batches_(max_queue_batches > 0 ? max_queue_batches : 2),
       read_buffer_size_(read_buffer_size > 0 ? read_buffer_size : kDefaultReadBufferSize),
       use_mmap_(use_mmap),
-      queue_(max_queue_batches_) {
+      perf_counters_(perf_counters),
+      batch_info_(batch_info),
+      queue_(std::make_shared<RingQueue<BatchResult>>(max_queue_batches_)),
+      metrics_(std::make_shared<PipelineMetrics>()),
+      registration_(ParserKind::Csv, metrics_.get(), [this] { return queue_->size(); }) {
+  // Batches in flight: the queue, one being built and one being converted.
+  if (pooled) batch_pool_ = std::make_shared<RecyclePool<Batch>>(max_queue_batches_ + 2);
+  if (trace_capacity > 0) tracer_ = std::make_shared<TraceRecorder>(trace_capacity);
   thread_ = std::thread(&StreamingCsvParser::run, this);
 }
 
@@ -34,7 +46,7 @@ StreamingCsvParser::~StreamingCsvParser() {
 
 void StreamingCsvParser::stop() {
   stop_requested_.store(true);
-  queue_.cancel();
+  queue_->cancel();
 }
 
 void StreamingCsvParser::run() {
@@ -47,111 +59,140 @@ void StreamingCsvParser::run() {
     BatchResult r;
     r.kind = BatchResultKind::Error;
     r.error_message = reader.errorMessage();
-    queue_.push(std::move(r));
+    queue_->push(std::move(r));
     return;
   }
 
   CsvOptions parser_opts = options_;
   SliceCsvParser parser(parser_opts);
-  if (profileEnabled()) parser.setMetrics(&metrics_);
+  if (profileEnabled()) parser.setMetrics(metrics_.get());
   if (options_.has_header) parser.skipOneRow();
-
-  std::vector<char> remainder;
-  const char* seg1 = nullptr;
-  std::size_t len1 = 0;
-
-  while (!stop_requested_.load()) {
-    auto t_read_start = std::chrono::steady_clock::now();
-    ByteSpan chunk = reader.getNext();
-    auto t_read_end = std::chrono::steady_clock::now();
-    if (profileEnabled()) {
-      metrics_.read_time_ns.fetch_add(
-          static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
-              t_read_end - t_read_start).count()));
-    }
-    if (chunk.empty() && len1 == 0) break;
-
-    auto t_parse_start = std::chrono::steady_clock::now();
-    parser.feed(seg1, len1, chunk.data, chunk.size);
-    seg1 = nullptr;
-    len1 = 0;
-
-    const char* rem_ptr = nullptr;
-    std::size_t rem_len = 0;
-    parser.getRemainder(&rem_ptr, &rem_len);
-    if (rem_ptr && rem_len > 0) {
-      remainder.assign(rem_ptr, rem_ptr + rem_len);
-      seg1 = remainder.data();
-      len1 = remainder.size();
-    }
-
-    while (parser.hasBatch()) {
-      SliceBatch slice_batch = parser.takeBatch();
-      if (profileEnabled()) metrics_.batch_allocations.fetch_add(1);
-      auto t_parse_end = std::chrono::steady_clock::now();
-      metrics_.parse_time_ns.fetch_add(
-          static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
-              t_parse_end - t_parse_start).count()));
-
-      auto t_build_start = std::chrono::steady_clock::now();
-      Batch batch;
+  if (batch_info_ != BatchInfoMode::Off) parser.setTrackOffsets(true);
+  // Index of the next batch's first data row, for batch info.
+  std::uint64_t next_row = 0;
+  // Reused across batches: takeBatch() refills its arena copy and row vectors.
+  SliceBatch slice_batch;
+
+  // Tokenize time of the batch being filled; a batch can span several chunks.
+  std::uint64_t tokenize_ticks = 0;
+  TraceRecorder* tracer = tracer_.get();
+  std::uint64_t batch_seq = 0;
+  // Counters count the opening thread, so they are opened here rather than in the ctor.
+  std::unique_ptr<PerfCounters> counters;
+  if (perf_counters_) {
+    counters.reset(new PerfCounters());
+    metrics_->hw_event_mask.store(counters->eventMask());
+    if (!counters->available()) counters.reset();
+  }
+  const PerfCounters* hw = counters.get();
+
+  // Builds and queues slice_batch; shared by the read loop and the flush so both record
+  // the same metrics, trace spans and batch info. False when the queue was cancelled.
+  auto emitBatch = [&]() -> bool {
+    if (profileEnabled()) metrics_->batch_allocations.fetch_add(1);
+    std::uint64_t tokenize_ns = CycleClock::toNs(tokenize_ticks);
+    tokenize_ticks = 0;
+    metrics_->parse_time_ns.fetch_add(tokenize_ns);
+    metrics_->tokenize_latency.record(tokenize_ns);
+
+    std::uint64_t t_build_start = CycleClock::now();
+    Batch batch;
+    {
+      TraceSpan span(tracer, TraceStage::Build, TraceTrack::Worker, batch_seq);
+      AllocStageScope alloc_scope(metrics_.get(), AllocStage::Build);
+      HwStageScope hw_scope(hw, metrics_.get(), HwStage::Build);
+      if (batch_pool_) batch_pool_->acquire(batch);
       buildRowBatch(slice_batch, batch);
-      auto t_build_end = std::chrono::steady_clock::now();
-      if (profileEnabled()) {
-        metrics_.build_time_ns.fetch_add(
-            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
-                t_build_end - t_build_start).count()));
-      }
-      metrics_.rows_parsed.fetch_add(batch.size());
-
-      auto t_push_start = std::chrono::steady_clock::now();
+    }
+    std::uint64_t build_ns = CycleClock::elapsedNs(t_build_start);
+    metrics_->build_latency.record(build_ns);
+    if (profileEnabled()) metrics_->build_time_ns.fetch_add(build_ns);
+    metrics_->rows_parsed.fetch_add(batch.size());
+
+    std::uint64_t t_push_start = CycleClock::now();
+    {
+      TraceSpan span(tracer, TraceStage::Push, TraceTrack::Worker, batch_seq);
+      AllocStageScope alloc_scope(metrics_.get(), AllocStage::Emit);
       BatchResult result;
       result.kind = BatchResultKind::Batch;
-      result.batch = std::move(batch);
-      if (!queue_.push(std::move(result))) goto done;
-      auto t_push_end = std::chrono::steady_clock::now();
-      metrics_.queue_wait_ns.fetch_add(
-          static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
-              t_push_end - t_push_start).count()));
-      if (profileEnabled()) {
-        metrics_.emit_time_ns.fetch_add(
-            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
-                t_push_end - t_push_start).count()));
+      if (batch_info_ != BatchInfoMode::Off) {
+        result.has_info = true;
+        describeBatch(slice_batch, 0, batch_info_ == BatchInfoMode::RowOffsets, result.info);
+        result.info.first_row = next_row;
+        result.info.tokenize_ns = tokenize_ns;
+        result.info.build_ns = build_ns;
       }
-      metrics_.batches_emitted.fetch_add(1);
-      t_parse_start = std::chrono::steady_clock::now();
+      next_row += batch.size();
+      result.batch = std::move(batch);
+      result.sequence = batch_seq;
+      if (!queue_->push(std::move(result))) return false;
     }
+    ++batch_seq;
+    std::uint64_t push_ns = CycleClock::elapsedNs(t_push_start);
+    metrics_->queue_wait_ns.fetch_add(push_ns);
+    metrics_->queue_wait_latency.record(push_ns);
+    if (profileEnabled()) metrics_->emit_time_ns.fetch_add(push_ns);
+    metrics_->batches_emitted.fetch_add(1);
+    return true;
+  };
 
+  while (!stop_requested_.load()) {
+    std::uint64_t t_read_start = CycleClock::now();
+    ByteSpan chunk;
+    {
+      TraceSpan span(tracer, TraceStage::Read, TraceTrack::Worker, batch_seq);
+      AllocStageScope alloc_scope(metrics_.get(), AllocStage::Read);
+      HwStageScope hw_scope(hw, metrics_.get(), HwStage::Read);
+      chunk = reader.getNext();
+    }
+    std::uint64_t read_ns = CycleClock::elapsedNs(t_read_start);
+    metrics_->read_latency.record(read_ns);
+    if (profileEnabled()) metrics_->read_time_ns.fetch_add(read_ns);
     if (chunk.empty()) break;
-    metrics_.bytes_read.fetch_add(chunk.size);
+
+    std::size_t consumed = 0;
+    while (consumed < chunk.size) {
+      std::uint64_t t_tokenize_start = CycleClock::now();
+      bool ready;
+      {
+        TraceSpan span(tracer, TraceStage::Tokenize, TraceTrack::Worker, batch_seq);
+        AllocStageScope alloc_scope(metrics_.get(), AllocStage::Tokenize);
+        HwStageScope hw_scope(hw, metrics_.get(), HwStage::Tokenize);
+        consumed += parser.feed(chunk.data + consumed, chunk.size - consumed);
+        ready = parser.hasBatch();
+        if (ready) parser.takeBatch(slice_batch);
+      }
+      tokenize_ticks += CycleClock::now() - t_tokenize_start;
+      if (!ready) break;
+      if (!emitBatch()) goto done;
+    }
+
+    metrics_->bytes_read.fetch_add(chunk.size);
   }
 
-  if (seg1 && len1 > 0)
-    parser.feed(seg1, len1, nullptr, 0);
-  parser.flush();
+  {
+    std::uint64_t t_tokenize_start = CycleClock::now();
+    TraceSpan span(tracer, TraceStage::Tokenize, TraceTrack::Worker, batch_seq);
+    AllocStageScope alloc_scope(metrics_.get(), AllocStage::Tokenize);
+    HwStageScope hw_scope(hw, metrics_.get(), HwStage::Tokenize);
+    parser.flush();
+    tokenize_ticks += CycleClock::now() - t_tokenize_start;
+  }
 
   while (parser.hasBatch()) {
-    SliceBatch slice_batch = parser.takeBatch();
-    if (profileEnabled()) metrics_.batch_allocations.fetch_add(1);
-    Batch batch;
-    auto t_build_start = std::chrono::steady_clock::now();
-    buildRowBatch(slice_batch, batch);
-    if (profileEnabled()) {
-      auto t_build_end = std::chrono::steady_clock::now();
-      metrics_.build_time_ns.fetch_add(
-          static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
-              t_build_end - t_build_start).count()));
+    std::uint64_t t_tokenize_start = CycleClock::now();
+    {
+      TraceSpan span(tracer, TraceStage::Tokenize, TraceTrack::Worker, batch_seq);
+      AllocStageScope alloc_scope(metrics_.get(), AllocStage::Tokenize);
+      HwStageScope hw_scope(hw, metrics_.get(), HwStage::Tokenize);
+      parser.takeBatch(slice_batch);
     }
-    metrics_.rows_parsed.fetch_add(batch.size());
-    BatchResult result;
-    result.kind = BatchResultKind::Batch;
-    result.batch = std::move(batch);
-    if (!queue_.push(std::move(result))) goto done;
-    metrics_.batches_emitted.fetch_add(1);
+    tokenize_ticks += CycleClock::now() - t_tokenize_start;
+    if (!emitBatch()) goto done;
   }
 
-  metrics_.bytes_read.store(reader.bytesRead());
-  queue_.push(BatchResult{BatchResultKind::Done, Batch{}, ""});
+  metrics_->bytes_read.store(reader.bytesRead());
+  queue_->push(BatchResult{BatchResultKind::Done, Batch{}, ""});
 
 done:
   return;
@@ -3,10 +3,13 @@
 
 #include "batch_builder.h"
 #include "csv_parser.h"
+#include "metrics_registry.h"
 #include "pipeline_metrics.h"
 #include "reader.h"
+#include "recycle_pool.h"
 #include "ring_queue.h"
 #include "slice_parser.h"
+#include "trace_recorder.h"
 #include <atomic>
 #include <memory>
 #include <string>
@@ -21,27 +24,54 @@ struct BatchResult {
   BatchResultKind kind = BatchResultKind::Done;
   Batch batch;
   std::string error_message;
+  /// Batch sequence number (0-based) for trace events.
+  std::uint64_t sequence = 0;
+  /// Provenance, when the parser was created with a BatchInfoMode other than Off.
+  bool has_info = false;
+  BatchInfo info{};
 };
 
 /// Streaming CSV parser: Reader → SliceParser → BatchBuilder → RingQueue.
 /// Bounded queue with backpressure; cancellation stops the worker quickly.
+/// In pooled mode the consumer hands converted batches back through batchPool() and the
+/// worker refills them in place, so a uniform file stops allocating once warm.
 class StreamingCsvParser {
  public:
   StreamingCsvParser(const std::string& path, const CsvOptions& options,
                      std::size_t max_queue_batches = 2,
                      bool use_mmap = false,
-                     std::size_t read_buffer_size = 0);
+                     std::size_t read_buffer_size = 0,
+                     bool pooled = false,
+                     std::size_t trace_capacity = 0,
+                     bool perf_counters = false,
+                     BatchInfoMode batch_info = BatchInfoMode::Off);
   ~StreamingCsvParser();
 
   StreamingCsvParser(const StreamingCsvParser&) = delete;
   StreamingCsvParser& operator=(const StreamingCsvParser&) = delete;
 
   /// Queue of batch results (pop from JS side).
-  RingQueue<BatchResult>& queue() { return queue_; }
-  const RingQueue<BatchResult>& queue() const { return queue_; }
+  RingQueue<BatchResult>& queue() { return *queue_; }
+  const RingQueue<BatchResult>& queue() const { return *queue_; }
 
   /// Internal metrics (optional debug exposure).
-  const PipelineMetrics& metrics() const { return metrics_; }
+  const PipelineMetrics& metrics() const { return *metrics_; }
+  PipelineMetrics& metrics() { return *metrics_; }
+
+  /// Shared so a pending getNextBatch can pop and record after the parser is destroyed.
+  const std::shared_ptr<RingQueue<BatchResult>>& sharedQueue() const { return queue_; }
+  const std::shared_ptr<PipelineMetrics>& sharedMetrics() const { return metrics_; }
+
+  /// Pooled mode: where the consumer releases batches once converted; null otherwise.
+  /// Shared so a pending conversion can release into it after the parser is gone.
+  const std::shared_ptr<RecyclePool<Batch>>& batchPool() const { return batch_pool_; }
+
+  /// Trace recorder when created with a trace capacity; null otherwise.
+  TraceRecorder* tracer() { return tracer_.get(); }
+  /// Shared so a pending getNextBatch can close its spans after the parser is destroyed.
+  const std::shared_ptr<TraceRecorder>& sharedTracer() const { return tracer_; }
+
+  BatchInfoMode batchInfoMode() const { return batch_info_; }
 
   /// Request parser thread to stop (for early exit).
   void stop();
@@ -54,8 +84,13 @@ class StreamingCsvParser {
   std::size_t max_queue_batches_;
   std::size_t read_buffer_size_;
   bool use_mmap_;
-  RingQueue<BatchResult> queue_;
-  PipelineMetrics metrics_;
+  bool perf_counters_;
+  BatchInfoMode batch_info_;
+  std::shared_ptr<RingQueue<BatchResult>> queue_;
+  std::shared_ptr<PipelineMetrics> metrics_;
+  std::shared_ptr<RecyclePool<Batch>> batch_pool_;
+  std::shared_ptr<TraceRecorder> tracer_;
+  MetricsRegistration registration_;
   std::thread thread_;
   std::atomic<bool> stop_requested_{false};
 };
@@ -1,4 +1,5 @@
 #include "streaming_xlsx_parser.h"
+#include "alloc_stats.h"
 #include <cerrno>
 #include <cstring>
 
@@ -36,6 +37,11 @@ bool XlsxBoundedQueue::pop(XlsxBatchResult& out) {
   return true;
 }
 
+std::size_t XlsxBoundedQueue::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
 void XlsxBoundedQueue::cancel() {
   cancelled_.store(true);
   not_full_.notify_all();
@@ -46,8 +52,10 @@ StreamingXlsxParser::StreamingXlsxParser(
     const std::string& path, const XlsxOptions& options)
     : path_(path),
       options_(options),
+      nulls_(options.null_values),
       max_queue_batches_(kMaxQueueBatches),
-      queue_(max_queue_batches_) {
+      queue_(max_queue_batches_),
+      registration_(ParserKind::Xlsx, &metrics_, [this] { return queue_.size(); }) {
   thread_ = std::thread(&StreamingXlsxParser::run, this);
 }
 
@@ -63,6 +71,7 @@ void StreamingXlsxParser::stop() {
 
 void StreamingXlsxParser::run() {
   try {
+  AllocStageScope read_scope(&metrics_, AllocStage::Read);
   mz_zip_archive zip;
   mz_zip_zero_struct(&zip);
   if (!mz_zip_reader_init_file(&zip, path_.c_str(), 0)) {
@@ -117,6 +126,7 @@ void StreamingXlsxParser::run() {
     return;
   }
 
+  metrics_.bytes_read.store(sheetSize);
   const char* xml = static_cast<const char*>(sheetBuf);
   std::vector<std::string> headers;
   Batch batch;
@@ -142,12 +152,16 @@ void StreamingXlsxParser::run() {
     }
     batch.push_back(std::move(row));
     if (batch.size() >= options_.batch_size) {
+      AllocStageScope build_scope(&metrics_, AllocStage::Build);
       XlsxBatch xb;
       xlsxBatchFromRows(
           std::vector<std::string>(headers),
           batch,
           options_,
+          nulls_,
           xb);
+      metrics_.rows_parsed.fetch_add(batch.size());
+      AllocStageScope emit_scope(&metrics_, AllocStage::Emit);
       XlsxBatchResult result;
       result.kind = XlsxResultKind::Batch;
       result.batch = std::move(xb);
@@ -155,26 +169,35 @@ void StreamingXlsxParser::run() {
         mz_free(sheetBuf);
         return false;
       }
+      metrics_.batches_emitted.fetch_add(1);
       batch.clear();
       batch.reserve(options_.batch_size);
     }
     return true;
   };
 
-  xlsxParseSheetXml(xml, sheetSize, shared_strings, on_row);
+  {
+    AllocStageScope tokenize_scope(&metrics_, AllocStage::Tokenize);
+    xlsxParseSheetXml(xml, sheetSize, shared_strings, on_row);
+  }
   mz_free(sheetBuf);
 
   if (!batch.empty()) {
+    AllocStageScope build_scope(&metrics_, AllocStage::Build);
     XlsxBatch xb;
     xlsxBatchFromRows(
         std::vector<std::string>(headers),
         batch,
         options_,
+        nulls_,
         xb);
+    metrics_.rows_parsed.fetch_add(batch.size());
+    AllocStageScope emit_scope(&metrics_, AllocStage::Emit);
     XlsxBatchResult result;
     result.kind = XlsxResultKind::Batch;
     result.batch = std::move(xb);
     if (!queue_.push(std::move(result))) return;
+    metrics_.batches_emitted.fetch_add(1);
   }
 
   {
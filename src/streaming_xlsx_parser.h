@@ -1,6 +1,8 @@
 #ifndef ULTRATAB_STREAMING_XLSX_PARSER_H
 #define ULTRATAB_STREAMING_XLSX_PARSER_H
 
+#include "metrics_registry.h"
+#include "pipeline_metrics.h"
 #include "xlsx_parser.h"
 #include <atomic>
 #include <condition_variable>
@@ -25,6 +27,7 @@ class XlsxBoundedQueue {
   bool push(XlsxBatchResult result);
   bool pop(XlsxBatchResult& out);
   void cancel();
+  std::size_t size() const;
 
  private:
   std::size_t max_size_;
@@ -46,6 +49,10 @@ class StreamingXlsxParser {
   XlsxBoundedQueue& queue() { return queue_; }
   const XlsxBoundedQueue& queue() const { return queue_; }
 
+  /// Rows/batches emitted, uncompressed sheet XML bytes (bytes_read) and, in ULTRATAB_ALLOC_STATS builds, allocations per stage
+  /// (read = archive and shared strings, tokenize = sheet XML, build = typed batch, emit = queue).
+  const PipelineMetrics& metrics() const { return metrics_; }
+
   void stop();
 
  private:
@@ -53,8 +60,12 @@ class StreamingXlsxParser {
 
   std::string path_;
   XlsxOptions options_;
+  /// options_.null_values, compiled once for every columnar batch.
+  NullMatcher nulls_;
   std::size_t max_queue_batches_;
   XlsxBoundedQueue queue_;
+  PipelineMetrics metrics_;
+  MetricsRegistration registration_;
   std::thread thread_;
   std::atomic<bool> stop_requested_{false};
 };
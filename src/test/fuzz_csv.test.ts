@@ -14,6 +14,9 @@ interface FuzzOptions {
   quoteChar?: string;
   header?: boolean;
   maxCellLen?: number;
+  batchSize?: number;
+  readBufferSize?: number;
+  engine?: "auto" | "simd" | "dfa";
 }
 
 async function withTempCsv(content: string, fn: (tmp: string) => Promise<void>): Promise<void> {
@@ -45,7 +48,9 @@ async function ultratabParse(filePath: string, options: FuzzOptions = {}): Promi
     delimiter: options.delimiter ?? ",",
     quote: options.quoteChar ?? '"',
     headers: options.header ?? false,
-    batchSize: 5000,
+    batchSize: options.batchSize ?? 5000,
+    readBufferSize: options.readBufferSize,
+    engine: options.engine,
   })) {
     batches.push(batch);
   }
@@ -86,6 +91,28 @@ function generateSimpleRandomCsv(rows: number, cols: number, options: FuzzOption
   return lines.join("\n");
 }
 
+function generateQuotedRandomCsv(rows: number, cols: number, newline: string): string {
+  const lines: string[] = [];
+  for (let r = 0; r < rows; r++) {
+    const cells: string[] = [];
+    for (let c = 0; c < cols; c++) {
+      let cell = "";
+      const len = randomInt(0, 40);
+      for (let i = 0; i < len; i++) cell += String.fromCharCode(randomInt(97, 122));
+      const roll = Math.random();
+      if (roll < 0.1) {
+        cells.push(`"${cell.slice(0, 10)}""${cell.slice(10)},\r\n${cell}"`);
+      } else if (roll < 0.2) {
+        cells.push(`"${cell}"`);
+      } else {
+        cells.push(cell);
+      }
+    }
+    lines.push(cells.join(","));
+  }
+  return lines.join(newline);
+}
+
 function dropTrailingEmpty(rows: string[][]): string[][] {
   if (!rows.length) return rows;
   const last = rows[rows.length - 1];
@@ -133,3 +160,32 @@ describe("Fuzz: random CSV vs PapaParse (simple content)", () => {
     });
   });
 });
+
+describe("Fuzz: rows and fields split across read buffers", () => {
+  for (const engine of ["simd", "dfa"] as const) {
+    for (const newline of ["\n", "\r\n"]) {
+      const label = `${newline === "\n" ? "LF" : "CRLF"}, ${engine} engine`;
+      it(`quote-free ${label} matches with tiny read buffers`, async () => {
+        const content = generateSimpleRandomCsv(3000, 7, { maxCellLen: 20 }).split("\n").join(newline) + newline;
+        await withTempCsv(content, async (tmp) => {
+          const papa = dropTrailingEmpty(papaparseParse(content, { header: false }));
+          const ultra = dropTrailingEmpty(
+            await ultratabParse(tmp, { header: false, readBufferSize: 4096, batchSize: 97, engine })
+          );
+          rowsEqual(papa, ultra);
+        });
+      });
+
+      it(`sparsely quoted ${label} matches with tiny read buffers`, async () => {
+        const content = generateQuotedRandomCsv(3000, 7, newline) + newline;
+        await withTempCsv(content, async (tmp) => {
+          const papa = dropTrailingEmpty(papaparseParse(content, { header: false }));
+          const ultra = dropTrailingEmpty(
+            await ultratabParse(tmp, { header: false, readBufferSize: 4096, batchSize: 97, engine })
+          );
+          rowsEqual(papa, ultra);
+        });
+      });
+    }
+  }
+});
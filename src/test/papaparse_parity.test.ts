@@ -124,6 +124,20 @@ describe("PapaParse parity", () => {
     });
   });
 
+  it("JSON-in-CSV with many doubled quotes matches PapaParse", async () => {
+    const lines = ["id,payload,note"];
+    for (let i = 0; i < 200; i++) {
+      const json = JSON.stringify({ id: i, name: `item ${i}`, tags: ["a", "b\"c"], nested: { k: "v".repeat(i % 40) } });
+      lines.push(`${i},"${json.replace(/"/g, '""')}","say ""hi"", ${"x".repeat(i % 70)}"`);
+    }
+    const content = lines.join("\n") + "\n";
+    await withTempCsv(content, async (tmp) => {
+      const papa = papaparseParse(content, { header: false }) as string[][];
+      const ultra = await ultratabParse(tmp, { header: false });
+      rowsEqual(papa, ultra, "doubled quotes");
+    });
+  });
+
   it("empty fields match", async () => {
     const content = "a,b,c\n1,,3\n,5,\n,,\n";
     await withTempCsv(content, async (tmp) => {
@@ -120,6 +120,21 @@ describe("csvColumns typed conversions", () => {
     });
   });
 
+  it("nullValues of mixed lengths, including long tokens, match across batches", async () => {
+    const long63 = "n".repeat(63);
+    const long70 = "n".repeat(70);
+    const cells = ["NA", "-", long63, long70, "n".repeat(64), "missing", "keep", "N"];
+    await withTempCsv("s\n" + cells.join("\n") + "\n", async (p) => {
+      const batches = await collectBatches(
+        csvColumns(p, { batchSize: 2, nullValues: ["NA", "-", "missing", long63, long70] })
+      );
+      assert.ok(batches.length > 1, "several batches share one matcher");
+      const s: string[] = [];
+      for (const b of batches) s.push(...(b.columns.s as string[]));
+      assert.deepStrictEqual(s, ["", "", "", "", "n".repeat(64), "", "keep", "N"]);
+    });
+  });
+
   it("select filters columns", async () => {
     await withTempCsv("a,b,c\n1,2,3\n4,5,6\n", async (p) => {
       const batches = await collectBatches(
@@ -145,6 +160,54 @@ describe("csvColumns typed conversions", () => {
     });
   });
 
+  it("trim skips tab, CR and LF padding longer than 16 bytes", async () => {
+    const pad = (n: number) => " \t\r\n".repeat(Math.ceil(n / 4)).slice(0, n);
+    const csv = `s,x\n"${pad(21)}left and right${pad(33)}","${pad(17)}42${pad(16)}"\n"\r\n\tshort\t\r\n",${" ".repeat(40)}7\n`;
+    await withTempCsv(csv, async (p) => {
+      const batches = await collectBatches(csvColumns(p, { schema: { x: "int32" }, trim: true }));
+      assert.deepStrictEqual(batches[0].columns.s, ["left and right", "short"]);
+      assert.deepStrictEqual(Array.from(batches[0].columns.x as Int32Array), [42, 7]);
+    });
+  });
+
+  it("trim turns all-whitespace cells into empty ones that match nullValues", async () => {
+    const blank = " \t\r\n".repeat(9);
+    const csv = `s,x,y\n"${blank}","${blank}",   NA\t\n  ,\t,1\n`;
+    await withTempCsv(csv, async (p) => {
+      const batches = await collectBatches(
+        csvColumns(p, { schema: { x: "int32", y: "int32" }, trim: true, nullValues: ["", "NA"] })
+      );
+      assert.deepStrictEqual(batches[0].columns.s, ["", ""]);
+      assert.deepStrictEqual(Array.from(batches[0].nullMask!.x), [1, 1]);
+      assert.deepStrictEqual(Array.from(batches[0].nullMask!.y), [1, 0]);
+    });
+  });
+
+  it("trim gives the same cells with the scalar and SSE2 kernels", async () => {
+    const ws = " \t\r\n";
+    const pad = () => {
+      let out = "";
+      for (let n = Math.floor(Math.random() * 50); n > 0; n--) out += ws[Math.floor(Math.random() * 4)];
+      return out;
+    };
+    const cores = ["", "x", "two words", "in\tside", "a".repeat(20)];
+    const expected: string[] = [];
+    let csv = "s\n";
+    for (let i = 0; i < 500; i++) {
+      const core = cores[i % cores.length];
+      expected.push(core);
+      csv += `"${pad()}${core}${pad()}"\n`;
+    }
+    await withTempCsv(csv, async (p) => {
+      for (const engine of ["dfa", "simd"] as const) {
+        const batches = await collectBatches(csvColumns(p, { engine, trim: true, nullValues: [], batchSize: 128 }));
+        const s: string[] = [];
+        for (const b of batches) s.push(...(b.columns.s as string[]));
+        assert.deepStrictEqual(s, expected, `engine ${engine}`);
+      }
+    });
+  });
+
   it("parse failure uses typedFallback null", async () => {
     await withTempCsv("x\n1\nabc\n3\n", async (p) => {
       const batches = await collectBatches(
@@ -164,4 +227,185 @@ describe("csvColumns typed conversions", () => {
       assert.strictEqual(bCol[0], "2,3");
     });
   });
+
+  it("schema infer picks the narrowest type per column", async () => {
+    await withTempCsv("i,b,f,s,n\n1,true,1.5,x,\n2,false,2,y,null\n3,,3,z,\n", async (p) => {
+      const batches = await collectBatches(csvColumns(p, { schema: "infer" }));
+      const cols = batches[0].columns;
+      assert.ok(cols.i instanceof Int32Array);
+      assert.ok(cols.b instanceof Uint8Array);
+      assert.ok(cols.f instanceof Float64Array);
+      assert.deepStrictEqual(cols.s, ["x", "y", "z"]);
+      assert.ok(Array.isArray(cols.n), "all-null column stays string");
+      assert.strictEqual(batches[0].nullMask?.b![2], 1);
+    });
+  });
+
+  it("schema infer widens on a later conflict instead of nulling", async () => {
+    await withTempCsv("a,c\n1,1\n2,2\n3000000000,abc\n4,4\n", async (p) => {
+      const batches = await collectBatches(csvColumns(p, { schema: "infer", inferRows: 2, batchSize: 2 }));
+      assert.ok(batches[0].columns.a instanceof Int32Array);
+      const wide = batches.find((b) => Array.isArray(b.columns.c) && b.columns.c.includes("abc"));
+      assert.ok(wide, "c widened to string in the batch holding abc");
+      assert.ok(Array.from(wide!.columns.a as BigInt64Array).includes(3000000000n));
+      const last = batches[batches.length - 1];
+      assert.ok(last.columns.a instanceof BigInt64Array, "widened type is kept");
+      assert.deepStrictEqual(last.columns.c, ["4"]);
+    });
+  });
+
+  it("schema infer widens a float column on later hex, inf or nan text", async () => {
+    await withTempCsv("f\n1.5\n2.5\n0x10\ninf\n", async (p) => {
+      const batches = await collectBatches(csvColumns(p, { schema: "infer", inferRows: 2, batchSize: 2 }));
+      assert.ok(batches[0].columns.f instanceof Float64Array);
+      const hex = batches.find((b) => Array.isArray(b.columns.f) && b.columns.f.includes("0x10"));
+      assert.ok(hex, "f widened to string instead of storing 0x10 as 16");
+      assert.deepStrictEqual(batches[batches.length - 1].columns.f, ["inf"]);
+    });
+  });
+
+  it("schema infer widens int64 and float64 conflicts to string instead of rounding", async () => {
+    await withTempCsv("x\n9007199254740993\n1.5\n", async (p) => {
+      const batches = await collectBatches(csvColumns(p, { schema: "infer" }));
+      assert.deepStrictEqual(batches[0].columns.x, ["9007199254740993", "1.5"]);
+    });
+    await withTempCsv("i,f\n9007199254740993,1.5\n2.5,9007199254740993\n", async (p) => {
+      const batches = await collectBatches(csvColumns(p, { schema: "infer", inferRows: 1, batchSize: 1 }));
+      assert.deepStrictEqual(Array.from(batches[0].columns.i as BigInt64Array), [9007199254740993n]);
+      assert.ok(batches[0].columns.f instanceof Float64Array);
+      const last = batches[batches.length - 1];
+      assert.deepStrictEqual(last.columns.i, ["2.5"]);
+      assert.deepStrictEqual(last.columns.f, ["9007199254740993"]);
+    });
+  });
+
+  it("parses date32 and ISO-8601 / RFC-3339 timestamps", async () => {
+    const csv = "d,t,u\n1970-01-02,2024-01-02T03:04:05.123+02:00,2024-01-02 03:04:05.000001\nnull,bad,1969-12-31T23:59:59.999999Z\n";
+    await withTempCsv(csv, async (p) => {
+      const batches = await collectBatches(
+        csvColumns(p, { schema: { d: "date32", t: "timestamp", u: "timestamp[us]" } })
+      );
+      const d = batches[0].columns.d as Int32Array;
+      const t = batches[0].columns.t as Float64Array;
+      const u = batches[0].columns.u as BigInt64Array;
+      assert.ok(d instanceof Int32Array);
+      assert.strictEqual(d[0], 1);
+      assert.strictEqual(t[0], Date.parse("2024-01-02T03:04:05.123+02:00"));
+      assert.strictEqual(u[0], BigInt(Date.parse("2024-01-02T03:04:05Z")) * 1000n + 1n);
+      assert.strictEqual(u[1], -1n);
+      assert.strictEqual(batches[0].nullMask?.d![1], 1);
+      assert.strictEqual(batches[0].nullMask?.t![1], 1);
+    });
+  });
+
+  it("parses timestamps with timeFormats patterns", async () => {
+    await withTempCsv("day,at\n02/01/2024,01/02/24 1:30 PM\n", async (p) => {
+      const batches = await collectBatches(
+        csvColumns(p, {
+          schema: { day: "date32", at: "timestamp" },
+          timeFormats: { day: "%d/%m/%Y", at: "%m/%d/%y %I:%M %p" },
+        })
+      );
+      assert.strictEqual((batches[0].columns.day as Int32Array)[0], Date.UTC(2024, 0, 2) / 86400000);
+      assert.strictEqual((batches[0].columns.at as Float64Array)[0], Date.UTC(2024, 0, 2, 13, 30));
+    });
+  });
+
+  it("schema infer reads times through the column's timeFormats pattern", async () => {
+    const csv = "day,at\n02/01/2024,01/02/24 1:30 PM\n03/01/2024,01/03/24 9:05 AM\n2024-01-05,01/04/24 12:00 AM\n";
+    await withTempCsv(csv, async (p) => {
+      const batches = await collectBatches(
+        csvColumns(p, {
+          schema: "infer",
+          inferRows: 2,
+          batchSize: 2,
+          timeFormats: { day: "%d/%m/%Y", at: "%m/%d/%y %I:%M %p" },
+        })
+      );
+      assert.ok(batches[0].columns.day instanceof Int32Array, "day inferred as date32");
+      assert.strictEqual((batches[0].columns.day as Int32Array)[0], Date.UTC(2024, 0, 2) / 86400000);
+      assert.ok(batches[0].columns.at instanceof Float64Array, "at inferred as timestamp");
+      assert.strictEqual((batches[0].columns.at as Float64Array)[0], Date.UTC(2024, 0, 2, 13, 30));
+      const last = batches[batches.length - 1];
+      assert.ok((last.columns.day as string[]).includes("2024-01-05"), "ISO text off the pattern widens to string");
+      assert.ok(last.columns.at instanceof Float64Array);
+    });
+  });
+
+  it("parses decimal(p,s) into exact scaled integers", async () => {
+    await withTempCsv("amt,big\n12345.67,-1.5\n-0.1,12345678901234567890.25\n1.005,x\n", async (p) => {
+      const batches = await collectBatches(
+        csvColumns(p, { schema: { amt: "decimal(10,2)", big: "decimal(38,2)" } })
+      );
+      const amt = batches[0].columns.amt as BigInt64Array;
+      assert.ok(amt instanceof BigInt64Array);
+      assert.deepStrictEqual(Array.from(amt.subarray(0, 2)), [1234567n, -10n]);
+      assert.strictEqual(batches[0].nullMask?.amt![2], 1, "digits past the scale are null");
+      const big = batches[0].columns.big as BigInt64Array;
+      assert.strictEqual(big.length, 6);
+      const at = (i: number): bigint => (big[2 * i + 1] << 64n) | BigInt.asUintN(64, big[2 * i]);
+      assert.strictEqual(at(0), -150n);
+      assert.strictEqual(at(1), 1234567890123456789025n);
+      assert.strictEqual(batches[0].nullMask?.big![2], 1);
+    });
+  });
+
+  it("parses narrow integer and float32 columns with range checks", async () => {
+    await withTempCsv("a,b,c,d,e,f\n-128,32767,255,65535,4294967295,1.5\n128,-32769,-1,65536,-1,1e39\n", async (p) => {
+      const batches = await collectBatches(
+        csvColumns(p, {
+          schema: { a: "int8", b: "int16", c: "uint8", d: "uint16", e: "uint32", f: "float32" },
+        })
+      );
+      const cols = batches[0].columns as Record<string, ArrayLike<number>>;
+      assert.ok(cols.a instanceof Int8Array);
+      assert.ok(cols.b instanceof Int16Array);
+      assert.ok(cols.c instanceof Uint8Array);
+      assert.ok(cols.d instanceof Uint16Array);
+      assert.ok(cols.e instanceof Uint32Array);
+      assert.ok(cols.f instanceof Float32Array);
+      assert.deepStrictEqual([cols.a[0], cols.b[0], cols.c[0], cols.d[0], cols.e[0], cols.f[0]], [-128, 32767, 255, 65535, 4294967295, 1.5]);
+      for (const name of ["a", "b", "c", "d", "e", "f"]) {
+        assert.strictEqual(batches[0].nullMask?.[name][1], 1, `${name} out of range is null`);
+      }
+    });
+  });
+
+  it("numberFormats reads grouped, decimal-comma, currency and percent text", async () => {
+    await withTempCsv('eu;us;pct\n1.234,56 €;"$1,234.5";12,5%\n-7,5;"-$1,000,000";3%\n1,2.3;12,34;x\n', async (p) => {
+      const batches = await collectBatches(
+        csvColumns(p, {
+          delimiter: ";",
+          schema: { eu: "float64", us: "float64", pct: "float32" },
+          numberFormats: {
+            eu: { decimal: ",", grouping: ".", currency: "€" },
+            us: { grouping: ",", currency: "$" },
+            pct: { decimal: ",", percent: true },
+          },
+        })
+      );
+      const cols = batches[0].columns as Record<string, Float64Array | Float32Array>;
+      assert.deepStrictEqual(Array.from(cols.eu.slice(0, 2)), [1234.56, -7.5]);
+      assert.deepStrictEqual(Array.from(cols.us.slice(0, 2)), [1234.5, -1000000]);
+      assert.deepStrictEqual(Array.from(cols.pct.slice(0, 2)), [12.5, 3]);
+      assert.deepStrictEqual(batches[0].nullCount, { eu: 1, us: 1, pct: 1 });
+    });
+  });
+
+  it("bitPacked emits validity bitmaps, packed bools and null counts", async () => {
+    await withTempCsv("x,b,y\n1,true,1\nnull,false,2\n3,true,3\n,true,4\n5,false,5\n", async (p) => {
+      const batches = await collectBatches(
+        csvColumns(p, {
+          schema: { x: "int32", b: "bool", y: "int32" },
+          bitPacked: true,
+          omitEmptyNullMask: true,
+        })
+      );
+      assert.strictEqual(batches.length, 1);
+      assert.deepStrictEqual(Array.from(batches[0].nullMask!.x), [0b10101]);
+      assert.deepStrictEqual(Array.from(batches[0].columns.b as Uint8Array), [0b01101]);
+      assert.strictEqual(batches[0].nullMask!.y, undefined);
+      assert.deepStrictEqual(batches[0].nullCount, { x: 2, b: 0, y: 0 });
+    });
+  });
 });
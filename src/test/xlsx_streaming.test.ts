@@ -7,6 +7,7 @@ const fs = require("fs");
 const { xlsx } = require("../index.js");
 
 const fixturePath = path.join(__dirname, "fixture.xlsx");
+const sparsePath = path.join(__dirname, "fixture_sparse.xlsx");
 
 interface XlsxBatch {
   headers: string[];
@@ -83,4 +84,29 @@ describe("xlsx streaming", () => {
       /failed to create parser|Failed to open|XLSX/
     );
   });
+
+  it("multi-letter refs and sparse cells land in their columns", async () => {
+    const batches = await collectBatches(xlsx(sparsePath, { headers: true }));
+    assert.strictEqual(batches.length, 1);
+    const b = batches[0];
+    assert.strictEqual(b.headers.length, 27, "AA1 is column 27");
+    assert.strictEqual(b.headers[1], "name");
+    assert.strictEqual(b.headers[26], "wide");
+    const rows = b.rows as string[][];
+    assert.strictEqual(rows.length, 2);
+    assert.strictEqual(rows[0][0], "1");
+    assert.strictEqual(rows[0][1], "");
+    assert.strictEqual(rows[0][26], "z");
+    assert.strictEqual(rows[1][0], "");
+    assert.strictEqual(rows[1][1], "only b");
+  }, { timeout: 5000 });
+
+  it("resolves self-closing sheet and relationship tags", async () => {
+    const byName = await collectBatches(xlsx(sparsePath, { sheet: "Second" }));
+    assert.strictEqual(byName.length, 1);
+    assert.deepStrictEqual(byName[0].headers, ["second"]);
+    assert.deepStrictEqual(byName[0].rows, [["2"]]);
+    const byIndex = await collectBatches(xlsx(sparsePath, { sheet: 2 }));
+    assert.deepStrictEqual(byIndex[0].headers, ["second"]);
+  }, { timeout: 5000 });
 });
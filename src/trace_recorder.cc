@@ -0,0 +1,100 @@
+#include "trace_recorder.h"
+#include <cstdio>
+
+namespace ultratab {
+
+namespace {
+
+const std::size_t kMinCapacity = 1024;
+
+const char* stageName(std::uint64_t stage) {
+  switch (static_cast<TraceStage>(stage)) {
+    case TraceStage::Read: return "read";
+    case TraceStage::Tokenize: return "tokenize";
+    case TraceStage::Build: return "build";
+    case TraceStage::Push: return "push";
+    case TraceStage::Pop: return "pop";
+    case TraceStage::Convert: return "convert";
+  }
+  return "unknown";
+}
+
+const char* trackName(int track) {
+  switch (static_cast<TraceTrack>(track)) {
+    case TraceTrack::Worker: return "ultratab worker";
+    case TraceTrack::Pool: return "libuv pool (queue pop)";
+    case TraceTrack::Main: return "JS main (convert)";
+  }
+  return "unknown";
+}
+
+// info layout: batch sequence << 24 | stage << 16 | phase << 8 | track
+std::uint64_t packInfo(TraceStage stage, char phase, TraceTrack track, std::uint64_t seq) {
+  return (seq << 24) | (static_cast<std::uint64_t>(stage) << 16) |
+         (static_cast<std::uint64_t>(static_cast<unsigned char>(phase)) << 8) |
+         static_cast<std::uint64_t>(track);
+}
+
+}  // namespace
+
+TraceRecorder::TraceRecorder(std::size_t capacity) : origin_(CycleClock::now()) {
+  std::size_t cap = kMinCapacity;
+  while (cap < capacity) cap <<= 1;
+  mask_ = cap - 1;
+  slots_.reset(new Slot[cap]);
+}
+
+void TraceRecorder::record(TraceStage stage, char phase, TraceTrack track,
+                           std::uint64_t batch_seq) {
+  std::uint64_t i = next_.fetch_add(1, std::memory_order_relaxed);
+  Slot& s = slots_[i & mask_];
+  // Odd stamp while writing, 2*(i+1) once event i is complete.
+  s.stamp.store(2 * i + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  s.ticks.store(CycleClock::now(), std::memory_order_relaxed);
+  s.info.store(packInfo(stage, phase, track, batch_seq), std::memory_order_relaxed);
+  s.stamp.store(2 * (i + 1), std::memory_order_release);
+}
+
+std::string TraceRecorder::toChromeJson() const {
+  std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  char buf[192];
+  std::snprintf(buf, sizeof(buf),
+                "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+                "\"args\":{\"name\":\"ultratab parser\"}}");
+  out += buf;
+  for (int track = 1; track <= 3; ++track) {
+    std::snprintf(buf, sizeof(buf),
+                  ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                  "\"args\":{\"name\":\"%s\"}}",
+                  track, trackName(track));
+    out += buf;
+  }
+
+  std::uint64_t end = next_.load(std::memory_order_acquire);
+  std::uint64_t capacity = static_cast<std::uint64_t>(mask_) + 1;
+  std::uint64_t begin = end > capacity ? end - capacity : 0;
+  for (std::uint64_t i = begin; i < end; ++i) {
+    const Slot& s = slots_[i & mask_];
+    std::uint64_t expected = 2 * (i + 1);
+    if (s.stamp.load(std::memory_order_acquire) != expected) continue;
+    std::uint64_t ticks = s.ticks.load(std::memory_order_relaxed);
+    std::uint64_t info = s.info.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (s.stamp.load(std::memory_order_relaxed) != expected) continue;
+
+    double ts_us = ticks >= origin_ ? static_cast<double>(CycleClock::toNs(ticks - origin_)) / 1000.0
+                                    : 0.0;
+    std::snprintf(buf, sizeof(buf),
+                  ",{\"name\":\"%s\",\"cat\":\"ultratab\",\"ph\":\"%c\",\"ts\":%.3f,"
+                  "\"pid\":1,\"tid\":%u,\"args\":{\"batch\":%llu}}",
+                  stageName((info >> 16) & 0xff), static_cast<char>((info >> 8) & 0xff), ts_us,
+                  static_cast<unsigned>(info & 0xff),
+                  static_cast<unsigned long long>(info >> 24));
+    out += buf;
+  }
+  out += "]}";
+  return out;
+}
+
+}  // namespace ultratab
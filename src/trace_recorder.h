@@ -0,0 +1,93 @@
+#ifndef ULTRATAB_TRACE_RECORDER_H
+#define ULTRATAB_TRACE_RECORDER_H
+
+#include "latency_histogram.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace ultratab {
+
+/// Pipeline step a trace span covers.
+enum class TraceStage : std::uint8_t { Read, Tokenize, Build, Push, Pop, Convert };
+
+/// Thread a span ran on; becomes the track (tid) in the exported trace.
+enum class TraceTrack : std::uint8_t { Worker = 1, Pool = 2, Main = 3 };
+
+/// Opt-in per-parser recorder of begin/end events. Events go into a fixed-size ring
+/// (oldest overwritten) through one fetch_add and a per-slot seqlock stamp, so the
+/// worker, libuv pool and JS threads record without locks; toChromeJson() skips slots
+/// being overwritten while it reads.
+class TraceRecorder {
+ public:
+  /// \a capacity events, rounded up to a power of two (minimum 1024).
+  explicit TraceRecorder(std::size_t capacity);
+
+  TraceRecorder(const TraceRecorder&) = delete;
+  TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+  void begin(TraceStage stage, TraceTrack track, std::uint64_t batch_seq) {
+    record(stage, 'B', track, batch_seq);
+  }
+  void end(TraceStage stage, TraceTrack track, std::uint64_t batch_seq) {
+    record(stage, 'E', track, batch_seq);
+  }
+
+  /// Recorded events (those still in the ring) as Chrome trace-event JSON, loadable in
+  /// chrome://tracing and ui.perfetto.dev. Timestamps are microseconds since creation.
+  std::string toChromeJson() const;
+
+  /// Events recorded since creation, including overwritten ones.
+  std::uint64_t recorded() const { return next_.load(std::memory_order_relaxed); }
+
+  static constexpr std::size_t kDefaultCapacity = 64 * 1024;
+
+ private:
+  struct Slot {
+    std::atomic<std::uint64_t> stamp{0};
+    std::atomic<std::uint64_t> ticks{0};
+    std::atomic<std::uint64_t> info{0};
+  };
+
+  void record(TraceStage stage, char phase, TraceTrack track, std::uint64_t batch_seq);
+
+  std::size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<std::uint64_t> next_{0};
+  std::uint64_t origin_;
+};
+
+/// Begin event now, end event when destroyed; no-op when \a recorder is null.
+class TraceSpan {
+ public:
+  TraceSpan(TraceRecorder* recorder, TraceStage stage, TraceTrack track,
+            std::uint64_t batch_seq)
+      : recorder_(recorder), stage_(stage), track_(track), batch_seq_(batch_seq) {
+    if (recorder_) recorder_->begin(stage_, track_, batch_seq_);
+  }
+  ~TraceSpan() { close(); }
+
+  /// Records the end event now instead of at destruction.
+  void close() {
+    if (recorder_) recorder_->end(stage_, track_, batch_seq_);
+    recorder_ = nullptr;
+  }
+
+  /// For spans that learn their batch late (e.g. a queue pop); used by the end event.
+  void setBatch(std::uint64_t batch_seq) { batch_seq_ = batch_seq; }
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+ private:
+  TraceRecorder* recorder_;
+  TraceStage stage_;
+  TraceTrack track_;
+  std::uint64_t batch_seq_;
+};
+
+}  // namespace ultratab
+
+#endif  // ULTRATAB_TRACE_RECORDER_H
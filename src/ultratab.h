@@ -0,0 +1,33 @@
+#ifndef ULTRATAB_ULTRATAB_H
+#define ULTRATAB_ULTRATAB_H
+
+/// Public C++ API of libultratab, the parsing engine behind the Node addon.
+///
+/// Each pipeline parses on its own worker thread from construction and hands results
+/// through a bounded queue; pop until a result other than Batch arrives:
+///
+///   ultratab::CsvOptions opts;
+///   opts.has_header = true;
+///   ultratab::StreamingCsvParser parser("data.csv", opts);
+///   ultratab::BatchResult r;
+///   while (parser.queue().pop(r) && r.kind == ultratab::BatchResultKind::Batch) {
+///     for (const ultratab::Row& row : r.batch) { ... }
+///   }
+///   if (r.kind == ultratab::BatchResultKind::Error) { ... r.error_message ... }
+///
+/// StreamingColumnarParser yields typed ColumnarBatch results the same way, and
+/// StreamingXlsxParser reads a worksheet. Destroying a parser stops its thread, so
+/// breaking out early is safe. MetricsRegistry::instance() aggregates every parser.
+
+#include "batch_builder.h"
+#include "columnar_parser.h"
+#include "csv_parser.h"
+#include "datetime_parser.h"
+#include "metrics_registry.h"
+#include "pipeline_metrics.h"
+#include "slice_parser.h"
+#include "streaming_columnar_parser.h"
+#include "streaming_parser.h"
+#include "streaming_xlsx_parser.h"
+
+#endif  // ULTRATAB_ULTRATAB_H
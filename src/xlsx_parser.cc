@@ -119,6 +119,7 @@ void parseWorkbookRels(const char* data, size_t len,
       if (cur.getAttr("Id", id)) { attrStart = cur.p; continue; }
       if (cur.getAttr("Target", target)) { attrStart = cur.p; continue; }
       while (attrStart < cur.end && *attrStart != ' ' && *attrStart != '\t' && *attrStart != '>' && *attrStart != '/') ++attrStart;
+      while (attrStart < cur.end && (*attrStart == ' ' || *attrStart == '\t')) ++attrStart;
       if (attrStart >= cur.end) break;
       cur.p = attrStart;
     }
@@ -127,7 +128,9 @@ void parseWorkbookRels(const char* data, size_t len,
       else target = "xl" + target;
       idToTarget[id] = std::move(target);
     }
-    cur.skipToClose("Relationship");
+    // Relationship elements are empty; step past this tag (or the Relationships root).
+    while (cur.p < cur.end && *cur.p != '>') ++cur.p;
+    if (cur.p < cur.end) ++cur.p;
   }
 }
 
@@ -141,7 +144,8 @@ void parseWorkbookSheets(const char* data, size_t len,
     cur.skipWs();
     if (cur.eof()) break;
     if (*cur.p != '<') { ++cur.p; continue; }
-    if (cur.p + 5 < cur.end && cur.p[1] == 's' && cur.p[2] == 'h' && cur.p[3] == 'e' && cur.p[4] == 'e' && cur.p[5] == 't') {
+    if (cur.p + 6 < cur.end && cur.p[1] == 's' && cur.p[2] == 'h' && cur.p[3] == 'e' && cur.p[4] == 'e' && cur.p[5] == 't' &&
+        (cur.p[6] == ' ' || cur.p[6] == '\t' || cur.p[6] == '\r' || cur.p[6] == '\n')) {
       cur.p += 1 + 5;
       cur.skipWs();
       std::string name, rid;
@@ -161,7 +165,8 @@ void parseWorkbookSheets(const char* data, size_t len,
       auto it = idToTarget.find(rid);
       if (it != idToTarget.end())
         sheets.push_back({name, it->second});
-      cur.skipToClose("sheet");
+      // <sheet .../> is empty; step past the tag.
+      while (cur.p < cur.end && *cur.p != '>') ++cur.p;
       continue;
     }
     ++cur.p;
@@ -226,7 +231,7 @@ void parseSharedStrings(const char* data, size_t len, std::vector<std::string>&
 // A1 -> 0, B2 -> 1, BC23 -> 54 (0-based column)
 int cellRefToCol(const char* ref, const char* end) {
   const char* p = ref;
-  while (p < end && std::isdigit(static_cast<unsigned char>(*p))) ++p;
+  while (p < end && std::isalpha(static_cast<unsigned char>(*p))) ++p;
   if (p == ref) return -1;
   int col = 0;
   for (const char* q = ref; q < p; ++q) {
@@ -360,7 +365,7 @@ void xlsxParseSheetXml(
 
     // </row>
     if (cur.p + 6 <= cur.end && cur.p[1] == '/' && cur.p[2] == 'r' && cur.p[3] == 'o' && cur.p[4] == 'w') {
-      cur.p += 6;
+      cur.p += 5;
       while (cur.p < cur.end && *cur.p != '>') ++cur.p;
       if (cur.p < cur.end) ++cur.p;
       if (!cellList.empty() || maxCol >= 0) {
@@ -390,6 +395,7 @@ void xlsxParseSheetXml(
       int col = cellRefToCol(r.data(), r.data() + r.size());
       if (col < 0) { cur.skipToClose("c"); continue; }
       if (col > maxCol) maxCol = col;
+      if (cur.p < cur.end && *cur.p == '>') ++cur.p;
 
       std::string value;
       // <v>123</v> or <is><t>inline</t></is>
@@ -442,6 +448,7 @@ void xlsxBatchFromRows(
     std::vector<std::string>&& headers,
     Batch& rows,
     const XlsxOptions& opts,
+    const NullMatcher& nulls,
     XlsxBatch& out) {
   out.headers = std::move(headers);
   out.columnar = !opts.schema.empty() || !opts.select.empty();
@@ -451,10 +458,15 @@ void xlsxBatchFromRows(
     co.batch_size = opts.batch_size;
     co.select = opts.select;
     co.schema = opts.schema;
+    co.time_formats = opts.time_formats;
+    co.decimal_types = opts.decimal_types;
+    co.number_formats = opts.number_formats;
     co.null_values = opts.null_values;
     co.trim = opts.trim;
     co.typed_fallback = opts.typed_fallback;
-    rowsToColumnar(rows, out.headers, co, out.columnar_batch);
+    co.bit_packed = opts.bit_packed;
+    co.omit_empty_null_mask = opts.omit_empty_null_mask;
+    rowsToColumnar(rows, out.headers, co, nulls, out.columnar_batch);
     out.columnar_batch.headers = out.headers;
   } else {
     out.rows = std::move(rows);
@@ -19,9 +19,14 @@ struct XlsxOptions {
   std::size_t batch_size = 5000;
   std::vector<std::string> select;
   std::unordered_map<std::string, ColumnType> schema;
+  std::unordered_map<std::string, std::string> time_formats;
+  std::unordered_map<std::string, DecimalType> decimal_types;
+  std::unordered_map<std::string, NumberFormat> number_formats;
   std::vector<std::string> null_values{"", "null", "NULL"};
   bool trim = false;
   TypedFallback typed_fallback = TypedFallback::Null;
+  bool bit_packed = false;
+  bool omit_empty_null_mask = false;
 };
 
 /// Result for one XLSX batch: either row-based (string[][]) or columnar.
@@ -63,11 +68,13 @@ void xlsxParseSheetXml(
     const std::vector<std::string>& shared_strings,
     std::function<bool(std::vector<std::string>&&)> on_row);
 
-/// Convert row-based batch to XlsxBatch (row or columnar per options).
+/// Convert row-based batch to XlsxBatch (row or columnar per options); \a nulls is
+/// opts.null_values compiled once by the caller.
 void xlsxBatchFromRows(
     std::vector<std::string>&& headers,
     Batch& rows,
     const XlsxOptions& opts,
+    const NullMatcher& nulls,
     XlsxBatch& out);
 
 }  // namespace ultratab
@@ -71,6 +71,113 @@ describe("arena memory", () => {
             catch { }
         }
     });
+    it("row parser: multi-MB field parses intact and the arena trims back afterwards", async () => {
+        const big = "x".repeat(3 * 1024 * 1024);
+        const file = path.join(tmpDir, `ultratab_arena_big_${Date.now()}_${Math.random().toString(36).slice(2)}.csv`);
+        const small = Array.from({ length: 20 }, (_, i) => `${i + 2},small`).join("\n");
+        fs.writeFileSync(file, `a,b\n1,"${big}"\n${small}\n`, "utf8");
+        try {
+            const parser = createParser(file, { batchSize: 1 });
+            const rows = [];
+            let batch;
+            while ((batch = await getNextBatch(parser)) !== undefined)
+                rows.push(...batch);
+            assert.strictEqual(rows.length, 22);
+            assert.strictEqual(rows[1][1].length, big.length);
+            assert.deepStrictEqual(rows[21], ["21", "small"]);
+            const m = getParserMetrics(parser);
+            assert.ok(m.arena_bytes_trimmed >= big.length, "blocks grown for the big field should be freed");
+            assert.ok(m.arena_bytes_allocated < 1024 * 1024, `expected < 1MB retained, got ${m.arena_bytes_allocated}`);
+            destroyParser(parser);
+        }
+        finally {
+            try {
+                fs.unlinkSync(file);
+            }
+            catch { }
+        }
+    });
+    it("row parser: small batches start with a small arena block", async () => {
+        const file = createTempCsv(100, 2);
+        try {
+            const parser = createParser(file, { batchSize: 10 });
+            while ((await getNextBatch(parser)) !== undefined) {
+                const m = getParserMetrics(parser);
+                assert.ok(m.arena_bytes_allocated < 1024 * 1024, `expected < 1MB, got ${m.arena_bytes_allocated}`);
+            }
+            destroyParser(parser);
+        }
+        finally {
+            try {
+                fs.unlinkSync(file);
+            }
+            catch { }
+        }
+    });
+    it("arena blocks are reused across parsers through the process-wide pool", async () => {
+        const file = createTempCsv(20000, 3);
+        try {
+            for (let round = 0; round < 2; round++) {
+                const parser = createParser(file, { batchSize: 5000 });
+                while ((await getNextBatch(parser)) !== undefined) { }
+                const m = getParserMetrics(parser);
+                assert.ok(typeof m.arena_pool_bytes === "number", "arena_pool_bytes should be a number");
+                assert.ok(m.arena_pool_hit_rate >= 0 && m.arena_pool_hit_rate <= 1);
+                if (round === 1)
+                    assert.ok(m.arena_pool_hits >= 1, "second parser should reuse pooled blocks");
+                destroyParser(parser);
+            }
+        }
+        finally {
+            try {
+                fs.unlinkSync(file);
+            }
+            catch { }
+        }
+    });
+    it("pooled row parser: no heap allocations per batch after warmup", async (t) => {
+        const lines = [];
+        for (let i = 0; i < 40000; i++) {
+            const id = String(i).padStart(8, "0");
+            lines.push(Array.from({ length: 4 }, (_, j) => `value-${id}-col${j}`).join(","));
+        }
+        const file = path.join(tmpDir, `ultratab_arena_pooled_${Date.now()}_${Math.random().toString(36).slice(2)}.csv`);
+        fs.writeFileSync(file, lines.join("\n") + "\n", "utf8");
+        try {
+            const parser = createParser(file, { batchSize: 500, pooled: true });
+            const stages = ["read", "tokenize", "build", "emit"];
+            const totals = [];
+            let allocStats = false;
+            let rowsSeen = 0;
+            let batch;
+            while ((batch = await getNextBatch(parser)) !== undefined) {
+                // Recycled batches must not leak rows or fields from earlier ones
+                assert.strictEqual(batch.length, 500);
+                assert.strictEqual(batch[0].join(","), lines[rowsSeen]);
+                assert.strictEqual(batch[499].join(","), lines[rowsSeen + 499]);
+                rowsSeen += batch.length;
+                const m = getParserMetrics(parser);
+                allocStats = m.alloc_stats === 1;
+                totals.push(stages.reduce((sum, s) => sum + m[`alloc_${s}_count`], 0));
+            }
+            destroyParser(parser);
+            assert.strictEqual(rowsSeen, 40000);
+            if (!allocStats) {
+                // The alloc-stats CI job sets this so a plain build cannot pass by skipping
+                assert.ok(!process.env.ULTRATAB_REQUIRE_ALLOC_STATS, "addon built without ULTRATAB_ALLOC_STATS");
+                t.skip("addon built without ULTRATAB_ALLOC_STATS");
+                return;
+            }
+            const warmup = 20;
+            assert.strictEqual(totals[totals.length - 1] - totals[warmup], 0, `expected no allocations after ${warmup} batches, totals: ${totals.join(",")}`);
+        }
+        finally {
+            try {
+                fs.unlinkSync(file);
+            }
+            catch { }
+        }
+    });
     it("columnar parser: arena metrics and bounded memory over many batches", async () => {
         const file = createTempCsv(150000, 5);
         try {
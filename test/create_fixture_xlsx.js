@@ -1,10 +1,11 @@
 "use strict";
 Object.defineProperty(exports, "__esModule", { value: true });
 /**
- * Creates test/fixture.xlsx using ExcelJS.
+ * Creates test/fixture.xlsx using ExcelJS, and test/fixture_sparse.xlsx from raw XML.
  * Run: node test/create_fixture_xlsx.js
  * Then run: node test/xlsx_streaming.test.js
  */
+const fs = require("fs");
 const path = require("path");
 const ExcelJS = require("exceljs");
 const outPath = path.join(__dirname, "fixture.xlsx");
@@ -13,12 +14,96 @@ const data = [
     ["Hello", 1],
     ["World", 2],
 ];
+// Hand-written parts for test/fixture_sparse.xlsx: self-closing <sheet/> and
+// <Relationship/> tags with the rels out of sheet order, a multi-letter column (AA)
+// and sparse rows.
+const sparsePath = path.join(__dirname, "fixture_sparse.xlsx");
+const xmlDecl = '<?xml version="1.0" encoding="UTF-8" standalone="yes"?>\n';
+const relNs = "http://schemas.openxmlformats.org/officeDocument/2006/relationships";
+const mainNs = "http://schemas.openxmlformats.org/spreadsheetml/2006/main";
+const inline = (ref, text) => `<c r="${ref}" t="inlineStr"><is><t>${text}</t></is></c>`;
+const sparseParts = [
+    ["[Content_Types].xml", xmlDecl +
+        '<Types xmlns="http://schemas.openxmlformats.org/package/2006/content-types">' +
+        '<Default Extension="rels" ContentType="application/vnd.openxmlformats-package.relationships+xml"/>' +
+        '<Default Extension="xml" ContentType="application/xml"/></Types>'],
+    ["_rels/.rels", xmlDecl +
+        '<Relationships xmlns="http://schemas.openxmlformats.org/package/2006/relationships">' +
+        `<Relationship Id="rId1" Type="${relNs}/officeDocument" Target="xl/workbook.xml"/></Relationships>`],
+    ["xl/_rels/workbook.xml.rels", xmlDecl +
+        '<Relationships xmlns="http://schemas.openxmlformats.org/package/2006/relationships">' +
+        `<Relationship Id="rId7" Type="${relNs}/worksheet" Target="worksheets/sheet2.xml"/>` +
+        `<Relationship Id="rId3" Type="${relNs}/worksheet" Target="worksheets/sheet1.xml"/></Relationships>`],
+    ["xl/workbook.xml", xmlDecl +
+        `<workbook xmlns="${mainNs}" xmlns:r="${relNs}"><sheets>` +
+        '<sheet name="First" sheetId="1" r:id="rId3"/><sheet name="Second" sheetId="2" r:id="rId7"/>' +
+        "</sheets></workbook>"],
+    ["xl/worksheets/sheet1.xml", xmlDecl +
+        `<worksheet xmlns="${mainNs}"><sheetData>` +
+        `<row r="1">${inline("A1", "id")}${inline("B1", "name")}${inline("AA1", "wide")}</row>` +
+        `<row r="2"><c r="A2"><v>1</v></c>${inline("AA2", "z")}</row>` +
+        `<row r="3">${inline("B3", "only b")}</row>` +
+        "</sheetData></worksheet>"],
+    ["xl/worksheets/sheet2.xml", xmlDecl +
+        `<worksheet xmlns="${mainNs}"><sheetData>` +
+        `<row r="1">${inline("A1", "second")}</row><row r="2"><c r="A2"><v>2</v></c></row>` +
+        "</sheetData></worksheet>"],
+];
+function crc32(buf) {
+    let crc = 0xffffffff;
+    for (const byte of buf) {
+        crc ^= byte;
+        for (let k = 0; k < 8; k++)
+            crc = (crc >>> 1) ^ (0xedb88320 & -(crc & 1));
+    }
+    return (crc ^ 0xffffffff) >>> 0;
+}
+/** Minimal zip writer: stored (uncompressed) entries, enough for the XLSX reader. */
+function writeStoredZip(file, parts) {
+    const local = [];
+    const central = [];
+    let offset = 0;
+    for (const [name, text] of parts) {
+        const nameBuf = Buffer.from(name, "utf8");
+        const data = Buffer.from(text, "utf8");
+        const crc = crc32(data);
+        const header = Buffer.alloc(30);
+        header.writeUInt32LE(0x04034b50, 0);
+        header.writeUInt16LE(20, 4);
+        header.writeUInt32LE(crc, 14);
+        header.writeUInt32LE(data.length, 18);
+        header.writeUInt32LE(data.length, 22);
+        header.writeUInt16LE(nameBuf.length, 26);
+        local.push(header, nameBuf, data);
+        const entry = Buffer.alloc(46);
+        entry.writeUInt32LE(0x02014b50, 0);
+        entry.writeUInt16LE(20, 4);
+        entry.writeUInt16LE(20, 6);
+        entry.writeUInt32LE(crc, 16);
+        entry.writeUInt32LE(data.length, 20);
+        entry.writeUInt32LE(data.length, 24);
+        entry.writeUInt16LE(nameBuf.length, 28);
+        entry.writeUInt32LE(offset, 42);
+        central.push(entry, nameBuf);
+        offset += header.length + nameBuf.length + data.length;
+    }
+    const centralSize = central.reduce((n, b) => n + b.length, 0);
+    const end = Buffer.alloc(22);
+    end.writeUInt32LE(0x06054b50, 0);
+    end.writeUInt16LE(parts.length, 8);
+    end.writeUInt16LE(parts.length, 10);
+    end.writeUInt32LE(centralSize, 12);
+    end.writeUInt32LE(offset, 16);
+    fs.writeFileSync(file, Buffer.concat([...local, ...central, end]));
+}
 async function main() {
     const wb = new ExcelJS.Workbook();
     const ws = wb.addWorksheet("Sheet1");
     ws.addRows(data);
     await wb.xlsx.writeFile(outPath);
     console.log("Wrote", outPath);
+    writeStoredZip(sparsePath, sparseParts);
+    console.log("Wrote", sparsePath);
 }
 main()
     .then(() => process.exit(0))
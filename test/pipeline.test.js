@@ -65,4 +65,209 @@ describe("pipeline", () => {
         while ((await getNextBatch(parser)) !== undefined) { }
         destroyParser(parser);
     });
+    it("latency histograms report p50/p99/max per stage without profiling", async () => {
+        const { createParser, getNextBatch, destroyParser, getParserMetrics: getMetrics, } = require("../index.js");
+        const p = ensureFixture();
+        const parser = createParser(p, { batchSize: 1000 });
+        if (!parser)
+            return;
+        let batches = 0;
+        while ((await getNextBatch(parser)) !== undefined)
+            batches++;
+        const metrics = getMetrics(parser);
+        for (const stage of ["tokenize", "build", "queue_wait", "convert"]) {
+            assert.strictEqual(metrics[`latency_${stage}_count`], batches, `${stage} count`);
+            const p50 = metrics[`latency_${stage}_p50_ns`];
+            const p99 = metrics[`latency_${stage}_p99_ns`];
+            const max = metrics[`latency_${stage}_max_ns`];
+            assert.ok(p50 <= p99 && p99 <= max, `${stage}: p50 ${p50} <= p99 ${p99} <= max ${max}`);
+        }
+        assert.ok(metrics.latency_read_count >= 1);
+        assert.ok(metrics.latency_tokenize_max_ns > 0);
+        destroyParser(parser);
+    });
+    it("destroy while getNextBatch is pending settles the promise without touching the parser or its tracer", async () => {
+        const { createParser, getNextBatch, destroyParser, createColumnarParser, getNextColumnarBatch, destroyColumnarParser, } = require("../index.js");
+        const p = ensureFixture();
+        for (let round = 0; round < 20; round++) {
+            const parser = createParser(p, { batchSize: 1000, trace: round % 2 === 1 });
+            if (!parser)
+                return;
+            const pending = [getNextBatch(parser), getNextBatch(parser), getNextBatch(parser)];
+            destroyParser(parser);
+            for (const batch of await Promise.all(pending)) {
+                assert.ok(batch === undefined || Array.isArray(batch));
+            }
+            const columnar = createColumnarParser(p, { batchSize: 1000, trace: round % 2 === 1 });
+            const pendingColumnar = [getNextColumnarBatch(columnar), getNextColumnarBatch(columnar)];
+            destroyColumnarParser(columnar);
+            for (const batch of await Promise.all(pendingColumnar)) {
+                assert.ok(batch === undefined || typeof batch.rows === "number");
+            }
+        }
+    });
+    it("trace option exports a Chrome trace of every batch's stages", async () => {
+        const { createParser, getNextBatch, destroyParser, getParserTrace } = require("../index.js");
+        const p = ensureFixture();
+        const untraced = createParser(p, { batchSize: 1000 });
+        if (!untraced)
+            return;
+        assert.strictEqual(getParserTrace(untraced), null);
+        destroyParser(untraced);
+        const parser = createParser(p, { batchSize: 1000, trace: true });
+        let batches = 0;
+        while ((await getNextBatch(parser)) !== undefined)
+            batches++;
+        const trace = JSON.parse(getParserTrace(parser));
+        destroyParser(parser);
+        const events = trace.traceEvents.filter((e) => e.ph === "B" || e.ph === "E");
+        for (const stage of ["read", "tokenize", "build", "push", "pop", "convert"]) {
+            const begins = events.filter((e) => e.name === stage && e.ph === "B");
+            const ends = events.filter((e) => e.name === stage && e.ph === "E");
+            assert.ok(begins.length > 0, `${stage} recorded`);
+            assert.strictEqual(begins.length, ends.length, `${stage} balanced`);
+        }
+        const converted = events.filter((e) => e.name === "convert" && e.ph === "E");
+        assert.deepStrictEqual(converted.map((e) => e.args.batch), Array.from({ length: batches }, (_, i) => i));
+    });
+    it("perfCounters reports per-stage hardware counters or degrades to hw_counters 0", async () => {
+        const { createParser, getNextBatch, destroyParser, getParserMetrics: getMetrics } = require("../index.js");
+        const p = ensureFixture();
+        const parser = createParser(p, { batchSize: 1000, perfCounters: true });
+        if (!parser)
+            return;
+        let rows = 0;
+        let batch;
+        while ((batch = await getNextBatch(parser)) !== undefined)
+            rows += batch.length;
+        const metrics = getMetrics(parser);
+        destroyParser(parser);
+        assert.strictEqual(rows, 50001);
+        assert.ok(metrics.hw_counters === 0 || metrics.hw_counters === 1);
+        if (metrics.hw_counters === 1) {
+            assert.ok(metrics.hw_tokenize_cycles > 0, "tokenize cycles counted");
+            assert.ok(metrics.hw_build_cycles > 0, "build cycles counted");
+        }
+        else {
+            assert.strictEqual(metrics.hw_tokenize_cycles, undefined);
+        }
+    });
+    it("metrics() keeps process-wide totals after parsers are destroyed", async () => {
+        const { createParser, getNextBatch, destroyParser, metrics } = require("../index.js");
+        const p = ensureFixture();
+        const before = metrics();
+        const parser = createParser(p, { batchSize: 1000 });
+        if (!parser)
+            return;
+        assert.strictEqual(metrics().parsers.csv.active, before.parsers.csv.active + 1);
+        while ((await getNextBatch(parser)) !== undefined) { }
+        destroyParser(parser);
+        const after = metrics();
+        const csvBefore = before.parsers.csv;
+        const csvAfter = after.parsers.csv;
+        assert.strictEqual(csvAfter.created, csvBefore.created + 1);
+        assert.strictEqual(csvAfter.active, csvBefore.active);
+        assert.strictEqual(csvAfter.rows_parsed - csvBefore.rows_parsed, 50001);
+        assert.strictEqual(csvAfter.bytes_read - csvBefore.bytes_read, fs.statSync(p).size);
+        assert.ok(after.total.rows_parsed >= csvAfter.rows_parsed);
+        const text = metrics({ format: "openmetrics" });
+        assert.ok(text.includes(`ultratab_rows_parsed_total{kind="csv"} ${csvAfter.rows_parsed}\n`));
+        assert.ok(text.includes("# TYPE ultratab_parsers_active gauge\n"));
+        assert.ok(text.endsWith("# EOF\n"));
+    });
+
+    it("batchInfo and rowOffsets record where each batch came from", async () => {
+        const p = ensureFixture();
+        const text = fs.readFileSync(p, "utf8");
+        let nextRow = 0;
+        let index = 0;
+        for await (const batch of csv(p, { headers: true, batchSize: 7000, rowOffsets: true })) {
+            const meta = batch.meta;
+            assert.strictEqual(meta.index, index++);
+            assert.strictEqual(meta.firstRow, nextRow);
+            assert.ok(meta.rowOffsets instanceof Float64Array);
+            assert.strictEqual(meta.rowOffsets.length, batch.length);
+            assert.strictEqual(meta.byteStart, meta.rowOffsets[0]);
+            assert.strictEqual(text[meta.byteEnd], "\n");
+            assert.ok(meta.tokenizeNs >= 0 && meta.buildNs >= 0);
+            for (let i = 0; i < batch.length; i += 997) {
+                const start = meta.rowOffsets[i];
+                assert.strictEqual(text.slice(start, text.indexOf("\n", start)), batch[i].join(","));
+            }
+            nextRow += batch.length;
+        }
+        assert.strictEqual(nextRow, 50000);
+        const columnar = await collectBatches(csvColumns(p, { batchSize: 7000, batchInfo: true }));
+        assert.strictEqual(columnar[0].meta.byteStart, "a,b\n".length);
+        assert.strictEqual(columnar[1].meta.firstRow, columnar[0].rows);
+        assert.strictEqual(columnar[0].meta.rowOffsets, undefined);
+    });
+    it("rowOffsets stay exact across CRLF endings and quoted multi-line fields", async () => {
+        // Row 0 puts a CR on the last byte of the first 4096-byte read, so the LF after it
+        // is only seen by the next chunk; every fifth row has a quoted field with CRLF and LF.
+        const header = "id,text\r\n";
+        const quoted = "line one\r\nline, two\n\"three\"";
+        const rows = [];
+        const cells = [];
+        for (let i = 0; i < 400; i++) {
+            let cell;
+            let raw;
+            if (i === 0) {
+                cell = "v".repeat(4096 - 1 - header.length - 2);
+                raw = `0,${cell}\r\n`;
+            }
+            else if (i % 5 === 0) {
+                cell = quoted;
+                raw = `${i},"${quoted.replace(/"/g, '""')}"\r\n`;
+            }
+            else {
+                cell = "x".repeat(i % 13);
+                raw = `${i},${cell}\r\n`;
+            }
+            rows.push(raw);
+            cells.push(cell);
+        }
+        const starts = [];
+        let text = header;
+        for (const raw of rows) {
+            starts.push(text.length);
+            text += raw;
+        }
+        assert.strictEqual(text[4095], "\r");
+        const file = path.join(testDir, "test", "pipeline_offsets_crlf.csv");
+        fs.writeFileSync(file, text, "utf8");
+        try {
+            const opts = { headers: true, batchSize: 7, readBufferSize: 4096, rowOffsets: true };
+            let nextRow = 0;
+            for await (const batch of csv(file, opts)) {
+                const meta = batch.meta;
+                assert.strictEqual(meta.firstRow, nextRow);
+                assert.strictEqual(meta.byteStart, starts[nextRow]);
+                const last = nextRow + batch.length - 1;
+                assert.strictEqual(meta.byteEnd, starts[last] + rows[last].length - 2);
+                for (let i = 0; i < batch.length; i++) {
+                    assert.strictEqual(meta.rowOffsets[i], starts[nextRow + i], `row ${nextRow + i} offset`);
+                    assert.strictEqual(batch[i][1], cells[nextRow + i]);
+                }
+                nextRow += batch.length;
+            }
+            assert.strictEqual(nextRow, rows.length);
+            nextRow = 0;
+            for await (const batch of csvColumns(file, opts)) {
+                const meta = batch.meta;
+                assert.strictEqual(meta.firstRow, nextRow);
+                for (let i = 0; i < batch.rows; i++) {
+                    assert.strictEqual(meta.rowOffsets[i], starts[nextRow + i], `columnar row ${nextRow + i} offset`);
+                }
+                nextRow += batch.rows;
+            }
+            assert.strictEqual(nextRow, rows.length);
+        }
+        finally {
+            try {
+                fs.unlinkSync(file);
+            }
+            catch { }
+        }
+    });
 });
@@ -16,13 +16,129 @@ export interface CsvOptions {
   useMmap?: boolean;
   /** Read buffer size in bytes when not using mmap (default: 262144). */
   readBufferSize?: number;
+  /**
+   * Tokenizer engine (default: "auto"). "simd": SIMD scanners with a quote-free fast path;
+   * "dfa": table-driven branchless state machine, no SIMD needed. "auto" picks "simd" when
+   * the build and CPU support it, else "dfa".
+   */
+  engine?: "auto" | "simd" | "dfa";
+  /**
+   * Recycle row batches (default: false). Each batch's arrays and strings are handed back
+   * to the background thread once converted and refilled in place, so a file of uniform
+   * rows parses without heap allocations per batch after warmup. Keeps up to
+   * maxQueueBatches + 2 batches of memory alive.
+   */
+  pooled?: boolean;
+  /**
+   * Record a timeline of pipeline events (default: false): true keeps the last 65536 events,
+   * a number sets the ring size. Read it with getParserTrace().
+   */
+  trace?: boolean | number;
+  /**
+   * Sample CPU cycles, instructions, branch misses and LLC misses around the read, tokenize
+   * and build stages on the worker thread (Linux perf_event_open; default: false). Reported
+   * as hw_<stage>_<event> parser metrics; hw_counters is 0 when the kernel refuses them.
+   */
+  perfCounters?: boolean;
+  /** Attach a BatchInfo `meta` property to every batch (default: false). */
+  batchInfo?: boolean;
+  /** Like batchInfo, plus each row's byte offset in meta.rowOffsets (default: false). */
+  rowOffsets?: boolean;
+}
+
+/**
+ * Where a batch came from, attached as `meta` when the parser is created with batchInfo
+ * or rowOffsets. Byte offsets are into the source file; rows count data rows from 0,
+ * excluding the header.
+ */
+export interface BatchInfo {
+  /** Batch number, from 0 (matches the batch arg in traces). */
+  index: number;
+  /** Row number of the batch's first row. */
+  firstRow: number;
+  /** Offset of the first row's first byte. */
+  byteStart: number;
+  /** Offset of the last row's line terminator (file size if it has none). */
+  byteEnd: number;
+  /** Time spent tokenizing and building this batch on the worker thread. */
+  tokenizeNs: number;
+  buildNs: number;
+  /** With rowOffsets: the start offset of each row; re-read a row from there. */
+  rowOffsets?: Float64Array;
 }
 
 /**
  * Async iterable of row batches. Each batch is an array of rows;
  * each row is an array of field strings.
  */
-export type CsvRowBatch = string[][];
+export type CsvRowBatch = string[][] & { meta?: BatchInfo };
+
+/**
+ * Column types for schema:
+ * - "int32" -> Int32Array, "int64" -> BigInt64Array, "float64" -> Float64Array,
+ *   "bool" -> Uint8Array (0/1), "string" -> string[].
+ * - "int8" -> Int8Array, "int16" -> Int16Array, "uint8" -> Uint8Array, "uint16" -> Uint16Array,
+ *   "uint32" -> Uint32Array, "float32" -> Float32Array. A value outside the type's range is
+ *   null rather than wrapped or rounded to infinity.
+ * - "date32" -> Int32Array of days since 1970-01-01.
+ * - "timestamp" (alias "timestamp[ms]") -> Float64Array of UTC milliseconds since the epoch,
+ *   ready for `new Date(ms)`; "timestamp[us]" -> BigInt64Array of microseconds.
+ * - "decimal(p,s)" -> BigInt64Array of the value times 10^s, exact (1 <= p <= 38, s <= p;
+ *   "decimal(p)" means s = 0). Up to p = 18 there is one entry per row. Above that each row
+ *   is 128-bit, two entries, low word first (Arrow's Decimal128 layout):
+ *   `(col[2 * i + 1] << 64n) | BigInt.asUintN(64, col[2 * i])`. A value with more than p
+ *   digits or nonzero digits past s is null; exponents are not accepted.
+ *
+ * Without a timeFormats entry, date32 reads ISO-8601 dates (YYYY-MM-DD) and timestamps read
+ * ISO-8601 / RFC-3339: a date, optionally followed by T or space, HH:MM[:SS[.fraction]] and a
+ * Z or +HH:MM offset. Times without an offset are taken as UTC.
+ */
+export type ColumnTypeName =
+  | "string"
+  | "int32"
+  | "int64"
+  | "float64"
+  | "bool"
+  | "int8"
+  | "int16"
+  | "uint8"
+  | "uint16"
+  | "uint32"
+  | "float32"
+  | "date32"
+  | "timestamp"
+  | "timestamp[ms]"
+  | "timestamp[us]"
+  | `decimal(${number},${number})`
+  | `decimal(${number})`;
+
+/**
+ * Column name -> strptime-like pattern for date32/timestamp columns. Directives: %Y, %y,
+ * %m, %d, %H, %I, %M, %S, %f (fraction), %b (month name), %p (AM/PM), %z (Z or +HH:MM) and
+ * %%; other characters must match exactly. A date32 column keeps the day of the parsed time.
+ * A pattern with an unknown directive is ignored and the column reads ISO-8601.
+ */
+export type TimeFormats = Record<string, string>;
+
+/**
+ * Layout of number text in one column, for the integer, float and decimal types. For
+ * example `{ decimal: ",", grouping: "." }` reads "1.234,56" and `{ grouping: ",",
+ * currency: "$" }` reads "-$1,234.56". Grouping separators must split the integer part into
+ * groups of three. A format whose separators contain digits or clash is ignored.
+ */
+export interface NumberFormat {
+  /** Decimal separator, one character (default "."). */
+  decimal?: string;
+  /** Thousands separator, such as ",", ".", "'", " " or "\u00a0" (default: none). */
+  grouping?: string;
+  /** Symbol stripped before or after the number, with or without a space ("€", "USD"). */
+  currency?: string;
+  /** Strip a trailing "%"; the value is kept as written, so "12.5%" is 12.5. */
+  percent?: boolean;
+}
+
+/** Column name -> NumberFormat. */
+export type NumberFormats = Record<string, NumberFormat>;
 
 /**
  * Options for the columnar CSV parser.
@@ -36,16 +152,56 @@ export interface CsvColumnsOptions {
   headers?: boolean;
   /** Rows per batch (default: 10000). */
   batchSize?: number;
+  /** Max batches in producer-consumer queue (default: 2). */
+  maxQueueBatches?: number;
+  /** Use memory-mapped I/O instead of buffered read (default: false). */
+  useMmap?: boolean;
+  /** Read buffer size in bytes when not using mmap (default: 262144). */
+  readBufferSize?: number;
   /** Optional list of columns to keep (by header name). */
   select?: string[];
-  /** Per-column schema: "string" | "int32" | "int64" | "float64" | "bool". */
-  schema?: Record<string, "string" | "int32" | "int64" | "float64" | "bool">;
+  /**
+   * Per-column schema (see ColumnTypeName); or "infer" to pick the narrowest type per
+   * column from the first inferRows rows. With "infer", a later value that does not fit
+   * widens its column (int32 -> int64 or float64, date32 -> timestamp -> timestamp[us],
+   * else string; int64 meeting a float, or float64 meeting an integer past 2^53, goes
+   * to string so no integer is rounded) from that batch on instead of becoming null, so
+   * a column's type can change between batches.
+   */
+  schema?: Record<string, ColumnTypeName> | "infer";
+  /** Rows sampled by schema: "infer", taken from the first batch (default: 1000). */
+  inferRows?: number;
+  /** Per-column strptime-like pattern for date32/timestamp columns; see TimeFormats. */
+  timeFormats?: TimeFormats;
+  /** Per-column decimal/grouping separators and currency/percent stripping; see NumberFormat. */
+  numberFormats?: NumberFormats;
   /** Strings treated as null (default: ["", "null", "NULL"]). */
   nullValues?: string[];
   /** Trim whitespace. */
   trim?: boolean;
   /** If parse fails for typed field: "string" | "null" (default: "null"). */
   typedFallback?: "string" | "null";
+  /**
+   * Arrow layout: each nullMask entry is a validity bitmap of ceil(rows / 8) bytes, bit
+   * i % 8 of byte i / 8 set when row i is valid (LSB first), and bool columns are packed
+   * the same way. Default false: one byte per row, 1 = null.
+   */
+  bitPacked?: boolean;
+  /** Leave columns with no nulls in the batch out of nullMask; see nullCount. */
+  omitEmptyNullMask?: boolean;
+  /**
+   * Tokenizer engine: "auto" | "simd" | "dfa" (default: "auto"). See CsvOptions.engine;
+   * "dfa" also runs trim without SIMD.
+   */
+  engine?: "auto" | "simd" | "dfa";
+  /** Record a pipeline timeline; see CsvOptions.trace and getColumnarParserTrace(). */
+  trace?: boolean | number;
+  /** Per-stage hardware counters; see CsvOptions.perfCounters. */
+  perfCounters?: boolean;
+  /** Attach a BatchInfo `meta` field to every batch; see CsvOptions.batchInfo. */
+  batchInfo?: boolean;
+  /** Like batchInfo, plus per-row byte offsets; see CsvOptions.rowOffsets. */
+  rowOffsets?: boolean;
 }
 
 /**
@@ -60,10 +216,19 @@ export interface ColumnarBatch {
     | BigInt64Array
     | Float64Array
     | Uint8Array
+    | Int8Array
+    | Int16Array
+    | Uint16Array
+    | Uint32Array
+    | Float32Array
   >;
-  /** 1 = null at that row index (for typed columns). */
+  /** 1 = null at that row index (for typed columns); a validity bitmap with bitPacked. */
   nullMask?: Record<string, Uint8Array>;
+  /** Null rows per typed column. */
+  nullCount?: Record<string, number>;
   rows: number;
+  /** Provenance, with batchInfo or rowOffsets. */
+  meta?: BatchInfo;
 }
 
 /**
@@ -134,14 +299,22 @@ export interface XlsxOptions {
   batchSize?: number;
   /** Optional columns to keep (by header name). */
   select?: string[];
-  /** Per-column schema: "string" | "int32" | "int64" | "float64" | "bool". */
-  schema?: Record<string, "string" | "int32" | "int64" | "float64" | "bool">;
+  /** Per-column schema; see ColumnTypeName. */
+  schema?: Record<string, ColumnTypeName>;
+  /** Per-column pattern for date32/timestamp columns; see TimeFormats. */
+  timeFormats?: TimeFormats;
+  /** Per-column number layout; see NumberFormat. */
+  numberFormats?: NumberFormats;
   /** Strings treated as null. */
   nullValues?: string[];
   /** Trim whitespace. */
   trim?: boolean;
   /** If parse fails for typed field: "string" | "null". */
   typedFallback?: "string" | "null";
+  /** Validity bitmaps and packed bools; see CsvColumnsOptions.bitPacked. */
+  bitPacked?: boolean;
+  /** See CsvColumnsOptions.omitEmptyNullMask. */
+  omitEmptyNullMask?: boolean;
 }
 
 /**
@@ -158,9 +331,15 @@ export type XlsxBatchResult = {
         | BigInt64Array
         | Float64Array
         | Uint8Array
+        | Int8Array
+        | Int16Array
+        | Uint16Array
+        | Uint32Array
+        | Float32Array
       >;
   rowsCount: number;
   nullMask?: Record<string, Uint8Array>;
+  nullCount?: Record<string, number>;
 };
 
 /**
@@ -176,6 +355,45 @@ export function xlsx(
   options?: XlsxOptions
 ): AsyncIterable<XlsxBatchResult>;
 
+/**
+ * Totals for one parser kind. Counters (created, bytes_read, rows_parsed, batches_emitted,
+ * parse_time_ns, queue_wait_ns) include destroyed parsers; active and queue_depth are live.
+ * For XLSX, bytes_read counts uncompressed sheet XML.
+ */
+export interface ParserKindMetrics {
+  created: number;
+  active: number;
+  bytes_read: number;
+  rows_parsed: number;
+  batches_emitted: number;
+  parse_time_ns: number;
+  queue_wait_ns: number;
+  queue_depth: number;
+}
+
+/** Process-wide metrics across every parser created in this process. */
+export interface MetricsSnapshot {
+  parsers: { csv: ParserKindMetrics; columnar: ParserKindMetrics; xlsx: ParserKindMetrics };
+  /** Sum over all parser kinds. */
+  total: ParserKindMetrics;
+  /** Arena blocks held by parsers and idle in the shared block pool. */
+  arena: {
+    bytes_in_use: number;
+    pool_bytes: number;
+    pool_blocks: number;
+    pool_hits: number;
+    pool_misses: number;
+  };
+}
+
+/**
+ * Process-wide metrics registry: totals over all CSV, columnar and XLSX parsers, including
+ * ones already destroyed. With { format: "openmetrics" }, returns OpenMetrics text
+ * (Prometheus compatible) to serve from an exporter endpoint.
+ */
+export function metrics(options?: { format?: "object" }): MetricsSnapshot;
+export function metrics(options: { format: "openmetrics" }): string;
+
 /**
  * Low-level CSV parser API. Returns a parser handle for manual batch iteration.
  * Remember to call destroyParser when done.
@@ -183,14 +401,30 @@ export function xlsx(
 export function createParser(path: string, options?: CsvOptions): unknown;
 
 /** Get the next row batch from a parser. Returns undefined when done. */
-export function getNextBatch(parser: unknown): Promise<string[][] | undefined>;
+export function getNextBatch(parser: unknown): Promise<CsvRowBatch | undefined>;
 
 /** Release parser resources. Call after iteration completes or on early exit. */
 export function destroyParser(parser: unknown): void;
 
-/** Internal pipeline metrics (bytes_read, rows_parsed, batches_emitted, etc.). */
+/**
+ * Internal pipeline metrics (bytes_read, rows_parsed, batches_emitted, etc.).
+ * alloc_<stage>_count / alloc_<stage>_bytes (stage: read, tokenize, build, emit) count heap
+ * allocations when the addon is built with ULTRATAB_ALLOC_STATS (alloc_stats is then 1).
+ * latency_<stage>_count / _p50_ns / _p99_ns / _max_ns (stage: read, tokenize, build, queue_wait,
+ * convert) come from always-on per-batch histograms (read is per chunk).
+ * hw_counters and hw_<stage>_<event> (stage: read, tokenize, build; event: cycles,
+ * instructions, branch_misses, llc_misses) are set for parsers created with perfCounters.
+ */
 export function getParserMetrics(parser: unknown): Record<string, number> | null;
 
+/**
+ * Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev) of a parser created with
+ * trace enabled: read / tokenize / build / push spans on the worker thread, pop on the
+ * libuv pool and convert on the JS thread, each tagged with its batch number. Null when
+ * tracing is off.
+ */
+export function getParserTrace(parser: unknown): string | null;
+
 /**
  * Low-level columnar CSV parser API. Returns a parser handle.
  * Remember to call destroyColumnarParser when done.
@@ -206,5 +440,23 @@ export function getNextColumnarBatch(parser: unknown): Promise<ColumnarBatch | u
 /** Release columnar parser resources. */
 export function destroyColumnarParser(parser: unknown): void;
 
-/** Internal metrics for columnar parser. */
+/** Internal metrics for columnar parser (same keys as getParserMetrics). */
 export function getColumnarParserMetrics(parser: unknown): Record<string, number> | null;
+
+/** Chrome trace-event JSON for a columnar parser (see getParserTrace). */
+export function getColumnarParserTrace(parser: unknown): string | null;
+
+/**
+ * Low-level XLSX parser API. Returns a parser handle.
+ * Remember to call destroyXlsxParser when done.
+ */
+export function createXlsxParser(path: string, options?: XlsxOptions): unknown;
+
+/** Get the next XLSX batch. Returns undefined when done. */
+export function getNextXlsxBatch(parser: unknown): Promise<XlsxBatchResult | undefined>;
+
+/** Release XLSX parser resources. */
+export function destroyXlsxParser(parser: unknown): void;
+
+/** Internal metrics for the XLSX parser (rows_parsed, batches_emitted, alloc_* counters). */
+export function getXlsxParserMetrics(parser: unknown): Record<string, number> | null;